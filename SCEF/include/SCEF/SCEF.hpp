@@ -37,6 +37,10 @@
 #include <string_view>
 #include <filesystem>
 #include <vector>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <initializer_list>
 
 //---- Other ----
 #include "scef_stream.hpp"
@@ -47,8 +51,9 @@
 namespace scef
 {
 
-constexpr uint16_t __SCEF_API_VERSION	= 1;	//!< Latest supported version of the API
-constexpr uint16_t __SCEF_NO_VERSION	= 0;	//!< Defaults to __SCEF_API_VERSION on save, == Error on load
+constexpr uint16_t __SCEF_API_VERSION		= 1;	//!< Latest supported version of the API
+constexpr uint16_t __SCEF_NO_VERSION		= 0;	//!< Defaults to __SCEF_API_VERSION on save, == Error on load
+constexpr uint16_t __SCEF_BINARY_VERSION	= 1;	//!< Version of the binary image written by \ref frozen_document::save, only the same version can be loaded
 
 constexpr uint64_t noline = 0;		//!< Used to indicate an error context that is not tied to a line in the document
 
@@ -71,13 +76,12 @@ enum class Encoding: uint8_t
 ///		1. On load, if saving flags are specified, they are ignored (and vice-versa)
 ///		2. DisableSpacers and AutoSpacing are mutually exclusive, if both are specified AutoSpacing takes precedence
 ///		3. If encoding is ANSI, no check is made to confirm that data is in 7bit ASCII range, even if Flag_LaxedEncoding is not set
-enum class Flag: uint8_t
+enum class Flag: uint16_t
 {
 	Default			= 0x00,	//!< All flags disabled
 	DisableSpacers	= 0x01,	//!< Removes all spacing information
 	DisableComments	= 0x02,	//!< Removes all comments
 	LaxedEncoding	= 0x04,	//!< Laxes the encoding/decoding rules, ex. on UTF-8 characters outside UNICODE range do not cause an error
-	//AcceptLowChars	= 0x08,	//accepts chars bellow 0x09
 
 	//only works for saving
 	AutoSpacing		= 0x10,	//!< Ignores all spacing information, and automatically adds new lines and indentation based on context
@@ -85,7 +89,11 @@ enum class Flag: uint8_t
 	//DisableEncodeEscaping	= 0x40,
 
 	//only works for loading
+	DeferGroups		= 0x08,	//!< Group bodies are only scanned for where they end, and are read on \ref document::expand. The stream must be seekable
 	ForceHeader		= 0x80, //!< Only accepts file if scef header exists
+	IndexedSpans	= 0x0100, //!< Runs of text (names, values, comments, spacing) end at the next character a bitmap of each decoded block marks, instead of testing each one. Same result as without it
+	Utf8Text		= 0x0200, //!< Items keep their names, values and comments as UTF-8, to be read with the _u8 accessors, see \ref _p::NamedItem::utf8. Not used by \ref reader
+	InternNames		= 0x0400, //!< Items with the same name share it through the document's symbols, see \ref document::find_symbol. No effect with Utf8Text, not used by \ref reader
 };
 
 CORE_MAKE_ENUM_FLAG(Flag);
@@ -106,6 +114,7 @@ enum class Error: uint8_t
 	UnknownObject		= 0x0A,	//!< The item type is a custom type. Type is unsuported. Users should not define their own data types.
 	PrematureEnd		= 0x0B,	//!< Parser unexpectedly reached end of stream where such was not expected, file maybe truncated
 	MergedText			= 0x0C,
+	TooLarge			= 0x0D,	//!< The document has more items or text than what it is loaded into can hold, see \ref frozen_document
 
 	UnknownInternal				= 0x80,	//!< An unclassified internal error ocured
 	Warning_First				= 0x81,	// Functional indicates first warning
@@ -221,6 +230,74 @@ using _warning_callback = warningBehaviour (*)(const Error_Context&, void*);
 
 class document;
 
+///	\brief
+///		Receives the items of a document as they are read, without a tree being built.
+///		Used with the \ref document::load overloads that take a handler.
+///
+///	\note
+///		1. Items are only valid for the duration of the call, copy what is needed
+///		2. Groups are reported with \ref on_group_begin once their header is read, and are always closed with \ref on_group_end,
+///			the group's own children are not available (they are reported in between instead)
+///		3. Flag::DisableSpacers and Flag::DisableComments suppress the respective events
+class event_handler
+{
+public:
+	virtual void on_group_begin	(const group&		) {}
+	virtual void on_group_end	(const group&		) {}
+	virtual void on_key_value	(const keyedValue&	) {}
+	virtual void on_singlet		(const singlet&		) {}
+	virtual void on_comment		(const comment&		) {}
+	virtual void on_spacer		(const spacer&		) {}
+
+protected:
+	~event_handler() = default;
+};
+
+///	\brief
+///		Selects which items \ref document::load keeps, by their path from the root.
+///		Groups that are not selected are only scanned for where they end.
+///
+///	\note
+///		1. A path is a list of names separated by '/', where "*" stands for any name. Ex. U"Network/IP" or U"translations/*"
+///		2. A selected item is kept whole. Groups on the way to a selected item are kept, with only the selected items in them
+///		3. Spacers and comments are only kept inside of selected groups
+///		4. Names with a '/' can not be selected
+class path_filter
+{
+public:
+	enum class match: uint8_t
+	{
+		none,		//!< Not selected
+		partial,	//!< A group on the way to a selected item
+		whole,		//!< Selected
+	};
+
+public:
+	path_filter() = default;
+	path_filter(std::initializer_list<std::u32string_view> p_paths);
+
+	void add(std::u32string_view p_path);
+	void clear();
+
+	///	\internal
+	///	\brief Matches an item named p_name, inside of a group that matched p_nodes. Node 0 is the root.
+	///	\param[out] p_next - Nodes that the children of a partially matched group are matched with
+	[[nodiscard]] match find(std::span<const uint32_t> p_nodes, std::u32string_view p_name, std::vector<uint32_t>& p_next) const;
+
+private:
+	struct node
+	{
+		std::u32string			m_name;
+		std::vector<uint32_t>	m_children;
+		bool					m_any	= false;	//!< Matches any name
+		bool					m_whole	= false;	//!< A path ends here
+	};
+
+	std::vector<node> m_nodes{1};
+};
+
+namespace _p { class deferred_source; }
+
 ///	\brief
 ///		Functional item representing the data content (or root node) of the document
 class root final: public ItemList
@@ -243,6 +320,11 @@ public:
 	document() = default;
 	~document() = default;
 
+	///	\brief Items, their text and their spacing are allocated from an arena, which is given back all at once once nothing uses it.
+	///		\ref clear starts a new arena, the old one goes once the items that were kept from it are gone
+	///	\param p_upstream - Where the arena takes memory from, in large blocks. Must be thread safe if used with \ref load_parallel, and outlive the items
+	explicit document(std::pmr::memory_resource* p_upstream);
+
 	[[nodiscard]] inline		doc_prop& prop()		{ return m_document_properties; }
 	[[nodiscard]] inline const	doc_prop& prop() const	{ return m_document_properties; }
 
@@ -252,6 +334,16 @@ public:
 	[[nodiscard]] inline		::scef::root& root()		{ return m_rootObject; }
 	[[nodiscard]] inline const	::scef::root& root() const	{ return m_rootObject; }
 
+	///	\brief The arena items loaded into the document are made from, use it to make items that are added to the document.
+	///	\return nullptr if the document has no arena, items are then made on the heap
+	[[nodiscard]] std::shared_ptr<std::pmr::memory_resource> resource() const;
+
+	///	\brief
+	///		The symbol of p_name if the document interned it, loading with Flag::InternNames, and null otherwise.
+	///		A null symbol means no item loaded with that flag has that name, and lookups by symbol are integer compares.
+	///		Items and symbols keep the names they have, names nothing has any more are dropped on \ref clear and on load
+	[[nodiscard]] symbol find_symbol(std::u32string_view p_name) const;
+
 	void clear();
 
 	Error load(const std::filesystem::path& p_file, Flag p_flags, _warning_callback p_warning_callback = nullptr, void* p_user_context = nullptr);
@@ -260,13 +352,118 @@ public:
 	Error load(base_istreamer& p_stream, Flag p_flags, _warning_callback p_warning_callback = nullptr, void* p_user_context = nullptr);
 	Error save(base_ostreamer& p_stream, Flag p_flags, uint16_t p_version = __SCEF_NO_VERSION, Encoding p_encoding = Encoding::Unspecified);
 
+	///	\brief Reads the document reporting its items to p_handler instead of building \ref root, which is left empty.
+	Error load(const std::filesystem::path& p_file, event_handler& p_handler, Flag p_flags, _warning_callback p_warning_callback = nullptr, void* p_user_context = nullptr);
+	Error load(base_istreamer& p_stream, event_handler& p_handler, Flag p_flags, _warning_callback p_warning_callback = nullptr, void* p_user_context = nullptr);
+
+	///	\brief Builds \ref root with only the items selected by p_filter.
+	///	\note Groups that are not selected are skipped without raising warnings, other than for where they end
+	Error load(const std::filesystem::path& p_file, const path_filter& p_filter, Flag p_flags, _warning_callback p_warning_callback = nullptr, void* p_user_context = nullptr);
+	Error load(base_istreamer& p_stream, const path_filter& p_filter, Flag p_flags, _warning_callback p_warning_callback = nullptr, void* p_user_context = nullptr);
+
+	///	\brief Reads the body of a group that Flag::DeferGroups left unread, groups in it are deferred in turn.
+	///	\return Error::None if p_group was not deferred, or Error::Unable2Read if it was not loaded by the current load of this document
+	///	\note When loaded from a stream, the stream must remain open for as long as groups are expanded. Files are kept open by the document
+	Error expand(group& p_group);
+
+	///	\brief Loads the bodies of top level groups in parallel, with up to p_threads threads (0 for one per core), and no more threads than cores.
+	///		Top level items are read first, then each group body is read on its own thread and kept in document order.
+	///	\note
+	///		1. Only streams that provide a contiguous_view, and files, are read in parallel. Otherwise this is the same as \ref load
+	///		2. Warnings are delivered one at a time but not in document order, and can come from groups after the one a sequential load would have stopped at
+	///		3. The outcome, including error positions, is the same as \ref load
+	///		4. On a single core, or with p_threads == 1, this is the same as \ref load
+	Error load_parallel(const std::filesystem::path& p_file, Flag p_flags, uint32_t p_threads = 0, _warning_callback p_warning_callback = nullptr, void* p_user_context = nullptr);
+	Error load_parallel(base_istreamer& p_stream, Flag p_flags, uint32_t p_threads = 0, _warning_callback p_warning_callback = nullptr, void* p_user_context = nullptr);
+
 	static constexpr bool  read_supports_version(uint16_t p_version) { return p_version <= __SCEF_API_VERSION; }
 	static constexpr bool write_supports_version(uint16_t p_version) { return p_version <= __SCEF_API_VERSION; }
 
 private:
+	Error _load(base_istreamer& p_stream, std::shared_ptr<_p::deferred_source> p_source, event_handler* p_handler, const path_filter* p_filter, Flag p_flags, _warning_callback p_warning_callback, void* p_user_context);
+	Error _load(const std::filesystem::path& p_file, event_handler* p_handler, const path_filter* p_filter, Flag p_flags, _warning_callback p_warning_callback, void* p_user_context);
+
+	///	\brief Adds an arena for a thread of \ref load_parallel to allocate from
+	std::shared_ptr<std::pmr::memory_resource> add_arena();
+
+	///	\brief Where a load with p_flags interns names, nullptr if it does not
+	_p::symbol_table* symbols(Flag p_flags);
+
+	std::pmr::memory_resource* m_upstream = nullptr;	//!< Where the arenas take memory from, if items are allocated from arenas
+	std::vector<std::shared_ptr<std::pmr::memory_resource>> m_arenas;	//!< The first one is the document's own. Items made from them share ownership
+	std::shared_ptr<_p::symbol_table> m_symbols;	//!< Interned names, kept across loads. Items that have them share ownership of the table
+
 	doc_prop		m_document_properties;	//!< Document information, automatically filled when loading
 	Error_Context	m_last_error;			//!< last error
 	scef::root		m_rootObject;			//!< Root node of document. Contains all items in teh document
+	std::shared_ptr<_p::deferred_source> m_deferred;	//!< What deferred groups are read from
+};
+
+class stream_decoder;
+namespace format::v1 { class cursor; }
+
+///	\brief
+///		Reads a document one item at a time, without a tree being built.
+///		The caller advances with \ref next, and can skip a group entirely with \ref skip_group or stop at any point.
+///
+///	\note
+///		1. The current item is only valid until the reader is advanced
+///		2. Groups are reported with token::group_begin once their header is read, and are always closed with token::group_end
+///		3. A skipped group is only scanned for where it ends, its content raises no warnings and is not checked
+///		4. Flag::DisableSpacers and Flag::DisableComments suppress the respective items
+class reader
+{
+public:
+	enum class token: uint8_t
+	{
+		none		= 0x00,	//!< Nothing was read yet
+		group_begin	= 0x01,	//!< \ref current is a \ref group, its children follow
+		group_end	= 0x02,	//!< \ref current is the \ref group that just ended
+		key_value	= 0x03,	//!< \ref current is a \ref keyedValue
+		singlet		= 0x04,	//!< \ref current is a \ref singlet
+		comment		= 0x05,	//!< \ref current is a \ref comment
+		spacer		= 0x06,	//!< \ref current is a \ref spacer
+		end			= 0x07,	//!< Nothing else to read, \ref last_error tells if the document was read successfully
+	};
+
+public:
+	reader();
+	~reader();
+
+	reader(const reader&)				= delete;
+	reader& operator = (const reader&)	= delete;
+
+	///	\brief Prepares to read the document, detecting its encoding and version. Nothing is read past the header.
+	Error open(const std::filesystem::path& p_file, Flag p_flags, _warning_callback p_warning_callback = nullptr, void* p_user_context = nullptr);
+	///	\note p_stream must outlive the reader, or until \ref close
+	Error open(base_istreamer& p_stream, Flag p_flags, _warning_callback p_warning_callback = nullptr, void* p_user_context = nullptr);
+	void close();
+
+	///	\brief Advances to the next item
+	///	\return false once there is nothing else to read
+	bool next();
+
+	///	\brief When at token::group_begin, advances to the matching token::group_end without reading the group's children
+	///	\return false if not at the start of a group, or if the document ended before the group did
+	bool skip_group();
+
+	[[nodiscard]] token					kind	() const;
+	[[nodiscard]] const item*			current	() const;
+	[[nodiscard]] std::u32string_view	name	() const;	//!< Name of a group, singlet or key
+	[[nodiscard]] std::u32string_view	value	() const;	//!< Value of a key, or text of a comment
+	[[nodiscard]] uintptr_t				depth	() const;	//!< Number of groups the current item is in
+
+	[[nodiscard]] inline const document::doc_prop&	prop		() const { return m_document_properties; }
+	[[nodiscard]] inline const Error_Context&		last_error	() const { return m_last_error; }
+
+private:
+	Error start(base_istreamer& p_stream, Flag p_flags, _warning_callback p_warning_callback, void* p_user_context);
+
+	document::doc_prop					m_document_properties;
+	Error_Context						m_last_error;
+	core::file_read						m_file;		//!< When opened from a file that is not mapped
+	std::unique_ptr<base_istreamer>		m_fileStream;
+	std::unique_ptr<format::v1::cursor>	m_cursor;
 };
 
 }	//namespace scef
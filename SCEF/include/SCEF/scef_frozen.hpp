@@ -0,0 +1,181 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span>
+#include <memory>
+#include <ranges>
+#include <filesystem>
+
+#include <CoreLib/string/core_string_numeric.hpp>
+
+#include "SCEF.hpp"
+
+namespace scef
+{
+
+///	\brief
+///		Read only copy of a document laid out for reading, with one array per property of the items
+///		and all of their text in a single buffer. Items are referred to by \ref node, their position in the arrays.
+///
+///	\note
+///		1. Only groups, singlets and keys are kept, spacers and comments are dropped
+///		2. The children of a node are consecutive nodes that come after it, see \ref children
+///		3. Node 0 is the root, the only node of type ItemType::root
+///		4. Lookups by name take constant time on average, and find the first item of that name and type like \ref ItemList::find_key_by_name
+///		5. Up to 2^30 nodes and 2^32 - 1 characters of text, more fails with Error::TooLarge
+///		6. The arrays are kept in a single image, which \ref save writes as is and \ref load_binary uses as is
+class frozen_document
+{
+public:
+	using node = uint32_t;
+	using node_range = std::ranges::iota_view<node, node>;
+
+	static constexpr node root_node	= 0;
+	static constexpr node npos		= UINT32_MAX;
+
+	static constexpr uintptr_t max_nodes	= uintptr_t{1} << 30;	//!< So that the lookup table, twice as large, still has a 32 bit size
+	static constexpr uintptr_t max_text		= UINT32_MAX;
+
+public:
+	///	\brief Only has the root
+	frozen_document();
+	///	\brief Copies p_items, ex. \ref document::root, as the children of the root
+	///	\note If p_items do not fit, only the root is kept and \ref last_error is Error::TooLarge
+	explicit frozen_document(const ItemList& p_items);
+	frozen_document(const frozen_document& p_other);
+	///	\post p_other has no nodes
+	frozen_document(frozen_document&& p_other) noexcept;
+	~frozen_document();
+
+	frozen_document& operator = (const frozen_document& p_other);
+	frozen_document& operator = (frozen_document&& p_other) noexcept;
+
+	///	\brief Builds the arrays as the document is read, no \ref document is built
+	Error load(const std::filesystem::path& p_file, Flag p_flags, _warning_callback p_warning_callback = nullptr, void* p_user_context = nullptr);
+	Error load(base_istreamer& p_stream, Flag p_flags, _warning_callback p_warning_callback = nullptr, void* p_user_context = nullptr);
+
+	///	\brief
+	///		Loads an image written by \ref save. The file is mapped and used in place, nothing is parsed or copied.
+	///		The image is checked to be consistent before it is used
+	///	\return Error::UnsuportedVersion if it was not written with \ref __SCEF_BINARY_VERSION,
+	///		Error::BadEncoding if it was written by a machine of a different byte order,
+	///		Error::BadFormat if it is not an image or is damaged
+	///	\note The file must not be modified while loaded
+	Error load_binary(const std::filesystem::path& p_file);
+	///	\brief Same as above, with the remaining of p_stream copied into memory
+	Error load_binary(base_istreamer& p_stream);
+
+	///	\brief Writes the image, versioned with \ref __SCEF_BINARY_VERSION. Ex. a build step that compiles .scef files to .scefb
+	Error save(const std::filesystem::path& p_file) const;
+	Error save(base_ostreamer& p_stream) const;
+
+	[[nodiscard]] inline const Error_Context& last_error() const { return m_last_error; }
+
+	///	\brief Number of nodes, the root included
+	[[nodiscard]] inline uintptr_t size() const { return m_size; }
+
+	///	\pre p_node < \ref size() for all of the following
+	[[nodiscard]] inline ItemType				type	(node p_node) const { return m_types[p_node]; }
+	[[nodiscard]] inline std::u32string_view	name	(node p_node) const { return view(m_names[p_node]); }
+	///	\brief The value of a key, empty for other items
+	[[nodiscard]] inline std::u32string_view	value	(node p_node) const { return view(m_values[p_node]); }
+	[[nodiscard]] inline node_range				children(node p_node) const { return node_range{m_children[p_node].first, m_children[p_node].first + m_children[p_node].count}; }
+
+	template<core::char_conv_dec_supported_c T>
+	[[nodiscard]] inline ::core::from_chars_result<T> value_as_num(node p_node) const { return core::from_chars<T>(value(p_node)); }
+
+	///	\brief The first child of p_parent with p_type and p_name, or \ref npos
+	[[nodiscard]] node find(node p_parent, ItemType p_type, std::u32string_view p_name) const;
+
+	[[nodiscard]] inline node find_group		(node p_parent, std::u32string_view p_name) const { return find(p_parent, ItemType::group,		p_name); }
+	[[nodiscard]] inline node find_singlet	(node p_parent, std::u32string_view p_name) const { return find(p_parent, ItemType::singlet,	p_name); }
+	[[nodiscard]] inline node find_key		(node p_parent, std::u32string_view p_name) const { return find(p_parent, ItemType::key_value,	p_name); }
+
+private:
+	class builder;
+
+	struct text
+	{
+		uint32_t offset	= 0;
+		uint32_t size	= 0;
+	};
+
+	struct range
+	{
+		node first	= 0;
+		node count	= 0;
+	};
+
+	struct slot
+	{
+		uint32_t	hash;
+		node		pos;	//node + 1, 0 for an empty slot
+	};
+
+	//Start of the image, followed by the names, values, children, slots, text and types arrays
+	struct header
+	{
+		uint32_t magic;
+		uint16_t version;
+		uint16_t reserved;
+		uint32_t nodes;
+		uint32_t slots;
+		uint32_t blob;
+		uint32_t padding;
+	};
+
+	[[nodiscard]] inline std::u32string_view view(text p_text) const { return std::u32string_view{m_blob + p_text.offset, p_text.size}; }
+
+	[[nodiscard]] static uint64_t image_size(const header& p_header);
+	[[nodiscard]] static Error check(std::span<const char8_t> p_image);
+	[[nodiscard]] bool valid() const;
+	[[nodiscard]] std::span<const char8_t> image() const;
+	void attach(const char8_t* p_image);
+	void detach();
+	Error fail(Error p_error);
+
+	const ItemType*	m_types		= nullptr;
+	const text*		m_names		= nullptr;
+	const text*		m_values	= nullptr;
+	const range*	m_children	= nullptr;
+	const slot*		m_slots		= nullptr;	//(parent, name) to node, see find
+	const char32_t*	m_blob		= nullptr;
+	uint32_t		m_size		= 0;
+	uint32_t		m_mask		= 0;
+
+	std::vector<uint64_t>			m_image;	//when built or read, or empty
+	std::unique_ptr<mmap_istream>	m_mapped;	//when mapped, or null
+	Error_Context					m_last_error;
+};
+
+} //namespace scef
@@ -27,12 +27,16 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include <cstddef>
 #include <string_view>
 #include <string>
 #include <vector>
 #include <memory>
+#include <memory_resource>
 #include <type_traits>
+#include <utility>
 
 #include <CoreLib/string/core_string_encoding.hpp>
 #include <CoreLib/string/core_string_numeric.hpp>
@@ -100,6 +104,145 @@ concept is_valid_scef_proxy_c = valid_scef_proxy<std::remove_const_t<T>>::value;
 template<_p::is_valid_scef_proxy_c T>
 using itemProxy = std::shared_ptr<T>;
 
+///	\brief
+///		Non-owning reference to an item, as given by lookups and typed iteration.
+///		Unlike \ref itemProxy, taking or dropping one does not touch the item's reference count
+///	\tparam T - Item type
+///	\note
+///		1. Only valid for as long as something owns the item, such as the list it was found in
+///		2. Does not convert to \ref itemProxy, use \ref lock to share ownership of the item
+template<_p::is_valid_scef_proxy_c T>
+class itemRef
+{
+public:
+	itemRef() = default;
+	itemRef(std::nullptr_t) {}
+	explicit itemRef(T* p_item): m_item{p_item} {}
+	template<typename U> requires std::is_convertible_v<U*, T*>
+	itemRef(const itemRef<U>& p_other): m_item{p_other.get()} {}
+	template<typename U> requires std::is_convertible_v<U*, T*>
+	itemRef(const itemProxy<U>& p_owner): m_item{p_owner.get()} {}
+
+	[[nodiscard]] inline T* get			() const { return m_item; }
+	[[nodiscard]] inline T* operator ->	() const { return m_item; }
+	[[nodiscard]] inline T& operator *	() const { return *m_item; }
+	[[nodiscard]] inline explicit operator bool () const { return m_item != nullptr; }
+
+	///	\brief The \ref itemProxy that owns the item, as the list it is in has it. Null if the reference is
+	[[nodiscard]] inline itemProxy<T> lock() const
+	{
+		if(!m_item) return nullptr;
+		return std::static_pointer_cast<T>(m_item->weak_from_this().lock());
+	}
+
+	template<typename U>
+	[[nodiscard]] inline bool operator == (const itemRef<U>& p_other) const { return m_item == p_other.get(); }
+	template<typename U>
+	[[nodiscard]] inline bool operator == (const itemProxy<U>& p_other) const { return m_item == p_other.get(); }
+	[[nodiscard]] inline bool operator == (std::nullptr_t) const { return m_item == nullptr; }
+
+private:
+	T* m_item = nullptr;
+};
+
+namespace _p
+{
+///	\internal
+///	\brief Allocates the ownership block of an item made from an arena, and keeps the arena alive for as long as the block is
+template<typename T>
+struct arena_allocator
+{
+	using value_type = T;
+
+	arena_allocator(std::shared_ptr<std::pmr::memory_resource> p_arena): m_arena(std::move(p_arena)) {}
+	template<typename U>
+	arena_allocator(const arena_allocator<U>& p_other): m_arena(p_other.m_arena) {}
+
+	[[nodiscard]] inline T* allocate(std::size_t p_count) { return static_cast<T*>(m_arena->allocate(p_count * sizeof(T), alignof(T))); }
+	inline void deallocate(T* p_block, std::size_t p_count) { m_arena->deallocate(p_block, p_count * sizeof(T), alignof(T)); }
+
+	template<typename U>
+	[[nodiscard]] inline bool operator == (const arena_allocator<U>& p_other) const { return m_arena == p_other.m_arena; }
+
+	std::shared_ptr<std::pmr::memory_resource> m_arena;
+};
+
+///	\internal
+///	\brief Gives an item made from an arena back to it. The arena is kept alive by the \ref arena_allocator of the same ownership block
+template<typename T>
+struct resource_delete
+{
+	std::pmr::memory_resource* m_resource;
+
+	inline void operator () (T* p_item) const
+	{
+		p_item->~T();
+		m_resource->deallocate(p_item, sizeof(T), alignof(T));
+	}
+};
+
+///	\internal
+///	\brief Owns p_item, which was constructed in memory from p_arena. The ownership block comes from p_arena as well, and shares ownership of it
+template<typename T>
+inline itemProxy<T> adopt_item(T* p_item, const std::shared_ptr<std::pmr::memory_resource>& p_arena)
+{
+	return itemProxy<T>{p_item, resource_delete<T>{p_arena.get()}, arena_allocator<T>{p_arena}};
+}
+} //namespace _p
+
+
+namespace _p
+{
+class symbol_table;
+class NamedItem;
+
+///	\internal
+///	\brief A name as kept by a symbol_table, shared by the items that have it
+struct symbol_entry
+{
+	symbol_entry(const symbol_table* p_table, uint32_t p_hash, std::u32string_view p_name)
+		: table(p_table), hash(p_hash), name(p_name) {}
+
+	///	\brief Takes a reference to the entry. The first one also keeps the table alive
+	void acquire() const;
+	///	\brief Gives back a reference, the entry is dropped from the table once none are left
+	void release() const;
+
+	const symbol_table*				table;
+	uint32_t						hash;	//same as an index of names would make of it
+	std::u32string					name;
+	mutable std::atomic<uintptr_t>	refs = 0;	//symbols and items that have the name
+};
+} //namespace _p
+
+///	\brief
+///		Name interned by a document loaded with Flag::InternNames, see \ref document::find_symbol.
+///		Symbols of the same document are equal if and only if their names are, and compare as pointers.
+///		A symbol keeps its name alive, even past the document it came from
+class symbol
+{
+	friend class _p::NamedItem;
+public:
+	symbol() = default;
+	explicit symbol(const _p::symbol_entry* p_entry): m_entry{p_entry} { if(m_entry) m_entry->acquire(); }
+	symbol(const symbol& p_other): m_entry{p_other.m_entry} { if(m_entry) m_entry->acquire(); }
+	symbol(symbol&& p_other) noexcept: m_entry{std::exchange(p_other.m_entry, nullptr)} {}
+	~symbol() { if(m_entry) m_entry->release(); }
+
+	symbol& operator = (const symbol& p_other) { symbol{p_other}.swap(*this); return *this; }
+	symbol& operator = (symbol&& p_other) noexcept { symbol{std::move(p_other)}.swap(*this); return *this; }
+
+	[[nodiscard]] inline std::u32string_view		view	() const { return m_entry ? std::u32string_view{m_entry->name} : std::u32string_view{}; }
+	[[nodiscard]] inline const _p::symbol_entry*	entry	() const { return m_entry; }
+	[[nodiscard]] inline explicit operator bool () const { return m_entry != nullptr; }
+	[[nodiscard]] inline bool operator == (const symbol& p_other) const { return m_entry == p_other.m_entry; }
+
+	inline void swap(symbol& p_other) noexcept { std::swap(m_entry, p_other.m_entry); }
+
+private:
+	const _p::symbol_entry* m_entry = nullptr;
+};
+
 
 //======== ======== ======== List Handling ======== ======== ========
 
@@ -116,6 +259,8 @@ using _list_const_iterator	= _p_item_list::const_iterator;
 
 class _t_list_iterator;
 class _t_list_const_iterator;
+class name_index;
+class type_index;
 
 ///	\internal
 ///	\brief
@@ -127,11 +272,14 @@ class _t_list_iterator
 	friend class ::scef::TypeListProxy;
 	friend class ::scef::constTypeListProxy;
 private:
-	_list_iterator	_node;
-	_list_iterator	_end;
-	ItemType		_mask;
+	_list_iterator		_node;
+	_list_iterator		_end;
+	ItemType			_mask;
+	const ptrdiff_t*	_next = nullptr;	//where the following item is from _end, 0 for the end, when iterating by the list's type index
 
 	_t_list_iterator(const _list_iterator& p_node, const _list_iterator& p_end, ItemType p_mask);
+	_t_list_iterator(const _list_iterator& p_end, ItemType p_mask, const ptrdiff_t* p_next);
+	void skip();
 public:
 	_t_list_iterator() = default;
 	_t_list_iterator(const _t_list_iterator& p_other) = default;
@@ -150,7 +298,8 @@ public:
 	_t_list_iterator&	operator ++ ();		//++i
 	_t_list_iterator	operator ++ (int);	//i++
 
-	[[nodiscard]] itemProxy<item> operator *() const;
+	[[nodiscard]] itemRef<item>	operator *	() const;
+	[[nodiscard]] item*			operator ->	() const;
 
 	[[nodiscard]] bool		is_end		() const;
 	[[nodiscard]] ItemType	mask		() const;
@@ -175,8 +324,11 @@ private:
 	_list_const_iterator	_node;
 	_list_const_iterator	_end;
 	ItemType				_mask{};
+	const ptrdiff_t*		_next = nullptr;	//where the following item is from _end, 0 for the end, when iterating by the list's type index
 
 	_t_list_const_iterator(const _list_const_iterator& p_node, const _list_const_iterator& p_end, ItemType p_mask);
+	_t_list_const_iterator(const _list_const_iterator& p_end, ItemType p_mask, const ptrdiff_t* p_next);
+	void skip();
 public:
 	_t_list_const_iterator() = default;
 	_t_list_const_iterator(const _t_list_const_iterator& p_other) = default;
@@ -197,7 +349,8 @@ public:
 	_t_list_const_iterator&	operator ++ ();		//++i
 	_t_list_const_iterator	operator ++ (int);	//i++
 
-	[[nodiscard]] itemProxy<const item> operator *() const;
+	[[nodiscard]] itemRef<const item>	operator *	() const;
+	[[nodiscard]] const item*			operator ->	() const;
 
 	[[nodiscard]] bool is_end() const;
 
@@ -263,10 +416,38 @@ private:
 ///		Generic list capable of containing SCEF items
 class ItemList: public _p::_p_item_list
 {
+	friend class TypeListProxy;
+	friend class constTypeListProxy;
 public:
 	using type_iterator			= scef::type_iterator;
 	using const_type_iterator	= scef::const_type_iterator;
 
+	ItemList();
+	ItemList(const ItemList& p_other);
+	ItemList(ItemList&& p_other) noexcept;
+	~ItemList();
+	ItemList& operator = (const ItemList& p_other);
+	ItemList& operator = (ItemList&& p_other) noexcept;
+
+	///	\brief
+	///		Same as the std::vector members they hide, they also count the change so that the list's indexes are known to be out of date.
+	///		Changes made through the std::vector base, or by assigning to the items through iterators or references, are not counted
+	void		clear		();
+	void		push_back	(const itemProxy<item>& p_item);
+	void		push_back	(itemProxy<item>&& p_item);
+	void		pop_back	();
+	iterator	erase		(const_iterator p_pos);
+	iterator	erase		(const_iterator p_first, const_iterator p_last);
+	iterator	insert		(const_iterator p_pos, std::initializer_list<itemProxy<item>> p_items);
+	void		assign		(std::initializer_list<itemProxy<item>> p_items);
+	void		resize		(size_type p_count);
+	void		resize		(size_type p_count, const itemProxy<item>& p_item);
+	void		swap		(ItemList& p_other);
+	template<typename... Args> itemProxy<item>&	emplace_back(Args&&... p_args);
+	template<typename... Args> iterator			emplace		(const_iterator p_pos, Args&&... p_args);
+	template<typename... Args> iterator			insert		(const_iterator p_pos, Args&&... p_args);
+	template<typename... Args> void				assign		(Args&&... p_args);
+
 	[[nodiscard]] TypeListProxy proxyList(ItemType p_type);
 	[[nodiscard]] const constTypeListProxy proxyList(ItemType p_type) const;
 
@@ -274,12 +455,57 @@ public:
 	[[nodiscard]] const_type_iterator	convert2const_type_iterator	(iterator p_other,			ItemType p_type) const;
 	[[nodiscard]] const_type_iterator	convert2const_type_iterator	(const_iterator p_other,	ItemType p_type) const;
 
-	[[nodiscard]] itemProxy<group>				find_group_by_name	(std::u32string_view p_name);
-	[[nodiscard]] itemProxy<singlet>			find_singlet_by_name(std::u32string_view p_name);
-	[[nodiscard]] itemProxy<keyedValue>			find_key_by_name	(std::u32string_view p_name);
-	[[nodiscard]] itemProxy<const group>		find_group_by_name	(std::u32string_view p_name) const;
-	[[nodiscard]] itemProxy<const singlet>		find_singlet_by_name(std::u32string_view p_name) const;
-	[[nodiscard]] itemProxy<const keyedValue>	find_key_by_name	(std::u32string_view p_name) const;
+	[[nodiscard]] itemRef<group>				find_group_by_name	(std::u32string_view p_name);
+	[[nodiscard]] itemRef<singlet>				find_singlet_by_name(std::u32string_view p_name);
+	[[nodiscard]] itemRef<keyedValue>			find_key_by_name	(std::u32string_view p_name);
+	[[nodiscard]] itemRef<const group>			find_group_by_name	(std::u32string_view p_name) const;
+	[[nodiscard]] itemRef<const singlet>		find_singlet_by_name(std::u32string_view p_name) const;
+	[[nodiscard]] itemRef<const keyedValue>		find_key_by_name	(std::u32string_view p_name) const;
+
+	[[nodiscard]] itemRef<group>				find_group_by_name	(std::u8string_view p_name);
+	[[nodiscard]] itemRef<singlet>				find_singlet_by_name(std::u8string_view p_name);
+	[[nodiscard]] itemRef<keyedValue>			find_key_by_name	(std::u8string_view p_name);
+	[[nodiscard]] itemRef<const group>			find_group_by_name	(std::u8string_view p_name) const;
+	[[nodiscard]] itemRef<const singlet>		find_singlet_by_name(std::u8string_view p_name) const;
+	[[nodiscard]] itemRef<const keyedValue>		find_key_by_name	(std::u8string_view p_name) const;
+
+	///	\brief Items interned in the same document as p_name are matched by comparing symbols, others by their name. Nothing matches a null symbol
+	[[nodiscard]] itemRef<group>				find_group_by_name	(symbol p_name);
+	[[nodiscard]] itemRef<singlet>				find_singlet_by_name(symbol p_name);
+	[[nodiscard]] itemRef<keyedValue>			find_key_by_name	(symbol p_name);
+	[[nodiscard]] itemRef<const group>			find_group_by_name	(symbol p_name) const;
+	[[nodiscard]] itemRef<const singlet>		find_singlet_by_name(symbol p_name) const;
+	[[nodiscard]] itemRef<const keyedValue>		find_key_by_name	(symbol p_name) const;
+
+	///	\brief
+	///		Indexes the names of the groups, singlets and keys in the list, after which find_*_by_name take constant time on average, whether the name is found or not.
+	///		Lookups only ever read the index, and may run concurrently with each other. The index is only made or updated by calling this
+	///	\note
+	///		1. Until this is called again, lookups look at each item if the list changed through its members, or if an item indexed by any list was renamed since
+	///		2. Items put in place of others through iterators or references are not noticed, call this again after doing so
+	///		3. Must not run at the same time as any other use of the list or of its items
+	void index_names();
+	void drop_name_index();
+
+	///	\brief
+	///		Indexes where the items that match p_type are, after which iterating \ref proxyList(p_type) only visits those items.
+	///		p_type is matched as a mask, as with proxyList. Typed iteration only ever reads the index. The index is only made or updated by calling this
+	///	\note
+	///		1. Until this is called again, typed iteration looks at each item if the list changed through its members since
+	///		2. Items put in place of others through iterators or references are not noticed, call this again after doing so.
+	///			Iterators skip the ones that no longer match, but do not see the ones that now do
+	///		3. Must not run at the same time as any other use of the list, and invalidates the list's typed iterators
+	void index_types(ItemType p_type);
+	void drop_type_index();
+
+private:
+	[[nodiscard]] type_iterator			typed_begin(ItemType p_type);
+	[[nodiscard]] const_type_iterator	typed_begin(ItemType p_type) const;
+	[[nodiscard]] const ptrdiff_t*		indexed_types(ItemType p_type) const;
+
+	std::unique_ptr<_p::name_index> m_names;
+	std::unique_ptr<_p::type_index> m_types;
+	uint64_t m_changes = 0;	//changes made through the members that hide std::vector's, see index_names
 };
 
 
@@ -304,22 +530,92 @@ inline constexpr bool is_space_noLF(char32_t p_val)
 	return p_val != '\n' && is_space(p_val);
 }
 
+///	\internal
+///	\brief Writes p_text as UTF-8 into p_out.
+///	\note Code points that are not valid Unicode are kept with the original (up to 6 bytes) UTF-8 scheme, or 7 bytes past 0x7FFFFFFF, so that any text converts back unchanged
+void encode_item_text(std::u32string_view p_text, std::u8string& p_out);
+void encode_item_text(std::u32string_view p_text, std::pmr::u8string& p_out);
+
+///	\internal
+///	\brief Reads the UTF-8 in p_text into p_out, the reverse of \ref encode_item_text. Malformed sequences read as U+FFFD
+void decode_item_text(std::u8string_view p_text, std::u32string& p_out);
+void decode_item_text(std::u8string_view p_text, std::pmr::u32string& p_out);
+
+///	\internal
+///	\brief Same as decoding p_utf8 and comparing with p_utf32, without allocating
+[[nodiscard]] bool equal_item_text(std::u8string_view p_utf8, std::u32string_view p_utf32);
+
+///	\internal
+///	\brief
+///		Text of an item, kept either as UTF-32 or as UTF-8. Which one is alive is tracked by the item.
+///		The text is allocated from the memory resource of the item, which converting keeps
+union item_text
+{
+	explicit item_text(std::pmr::memory_resource* p_resource): u32{p_resource} {}
+	~item_text() {}
+
+	void destroy	(bool p_utf8);
+	void convert	(bool p_utf8, bool p_to_utf8);
+	void assign		(bool p_utf8, std::u32string_view p_text);
+	void assign		(bool p_utf8, std::u8string_view p_text);
+	void clear		(bool p_utf8);
+	[[nodiscard]] bool empty(bool p_utf8) const;
+
+	std::pmr::u32string	u32;
+	std::pmr::u8string	u8;
+	const symbol_entry*	sym;	//interned name, the item holds a reference to it
+};
+
 /// \brief Wraps the property of an SCEF item having a name
 class NamedItem
 {
+	friend class name_index;
 protected:
 	NamedItem();
-
-	QuotationMode	_quotation_mode;
-	std::u32string	_name;
+	explicit NamedItem(std::pmr::memory_resource* p_resource);
+	NamedItem(const NamedItem& p_other);
+	~NamedItem();
+
+	void convert_name(bool p_utf8);
+	void release_symbol(bool p_keep);
+	void renamed() const;
+
+	QuotationMode				_quotation_mode;
+	bool						_utf8 = false;
+	bool						_interned = false;
+	mutable bool				_indexed = false;	//a list indexed the item by its name, see ItemList::index_names
+	std::pmr::memory_resource*	_resource;	//where the name is allocated from, also while it is interned
+	item_text					_name;
 public:
-
-	[[nodiscard]] std::u32string&		name			();
-	[[nodiscard]] const std::u32string&	name			() const;
-	[[nodiscard]] std::u32string_view	view_name		() const;
+	///	\brief Copies the name, in the encoding it is kept in. An interned name is shared
+	NamedItem& operator = (const NamedItem& p_other);
+
+	///	\brief
+	///		The name of the item is kept as UTF-8 instead of UTF-32, set by loading with Flag::Utf8Text or with set_utf8.
+	///		Items kept as UTF-8 are read with the _u8 accessors, the others with the UTF-32 ones.
+	///		The accessors of the encoding the text is not kept in give an empty view, name_u32 and the like decode a copy in either case.
+	///		Reading never converts, only set_utf8 does. set_name and set_value take either encoding in both modes
+	[[nodiscard]] bool utf8() const;
+
+	[[nodiscard]] std::u32string_view	name			() const;	//!< Empty if \ref utf8
+	[[nodiscard]] std::u32string_view	view_name		() const;	//!< Empty if \ref utf8
+	[[nodiscard]] std::u8string_view	name_u8			() const;	//!< Empty unless \ref utf8
+	[[nodiscard]] std::u8string_view	view_name_u8	() const;	//!< Empty unless \ref utf8
+	[[nodiscard]] std::u32string		name_u32		() const;	//!< Copy of the name, whichever encoding it is kept in
 	[[nodiscard]] QuotationMode			quotation_mode	() const;
 
+	///	\brief
+	///		The symbol shared with other items of the same name, null unless interned by loading with Flag::InternNames or set_name(symbol).
+	///		Setting the name as text gives the item its own copy
+	[[nodiscard]] symbol				name_symbol		() const;
+	///	\internal
+	///	\brief Same as \ref name_symbol without taking a reference to it
+	[[nodiscard]] const symbol_entry*	name_entry		() const;
+
 	void set_name		(std::u32string_view p_text);
+	void set_name		(std::u8string_view p_text);
+	///	\brief Shares the symbol's name, which the item keeps alive. Items kept as UTF-8 copy it instead
+	void set_name		(symbol p_symbol);
 	void set_quotation_mode(QuotationMode p_mode);
 	void clear_name		();
 };
@@ -329,8 +625,11 @@ class lineSpace
 {
 	friend Danger_Action;
 private:
-	std::u8string	_space;
+	std::pmr::u8string	_space;
 public:
+	lineSpace() = default;
+	explicit lineSpace(std::pmr::memory_resource* p_resource);
+
 	[[nodiscard]] std::u8string_view spacing() const;
 
 	void set_spacing	(std::u8string_view p_spacing);
@@ -343,9 +642,12 @@ class multiLineSpace
 {
 	friend Danger_Action;
 private:
-	uint64_t		_lines = 0;
-	std::u8string	_space;
+	uint64_t			_lines = 0;
+	std::pmr::u8string	_space;
 public:
+	multiLineSpace() = default;
+	explicit multiLineSpace(std::pmr::memory_resource* p_resource);
+
 	[[nodiscard]] std::u8string_view	flat_spacing	() const;
 	[[nodiscard]] uint64_t				num_lines		() const;
 
@@ -354,13 +656,25 @@ public:
 	void clear			();
 };
 
+///	\internal
+///	\brief Where the body of a group loaded with Flag::DeferGroups starts, see \ref document::expand
+struct deferred_body
+{
+	uint64_t	source	= 0;	//!< Load the group came from, 0 if the body is not deferred
+	uint64_t	offset	= 0;
+	uintptr_t	count	= 0;
+	uint64_t	line	= 0;
+	uint64_t	column	= 0;
+};
+
 } //namespace _p
 
 
 //======== ======== ======== Items ======== ======== ========
 
 /// \brief Abstract class representing an SCEF entity
-class item
+///	\note Items are always owned through an \ref itemProxy, which \ref itemRef::lock finds through enable_shared_from_this
+class item: public std::enable_shared_from_this<item>
 {
 protected:
 	item(ItemType p_type);
@@ -400,9 +714,12 @@ class spacer final: public item, public _p::multiLineSpace
 {
 private:
 	spacer();
+	explicit spacer(std::pmr::memory_resource* p_resource);
 
 public:
 	static itemProxy<spacer> make();
+	///	\brief The item and its spacing are allocated from p_arena, which it keeps alive. Same as make() if p_arena is null
+	static itemProxy<spacer> make(const std::shared_ptr<std::pmr::memory_resource>& p_arena);
 	static constexpr ItemType static_type(){ return ItemType::spacer; }
 };
 
@@ -420,30 +737,59 @@ class comment final: public item
 {
 private:
 	comment();
-	std::u32string	_text;
+	explicit comment(std::pmr::memory_resource* p_resource);
+	bool			_utf8 = false;
+	_p::item_text	_text;
 
 public:
+	~comment();
+
 	[[nodiscard]] static itemProxy<comment> make();
+	///	\brief The item and its text are allocated from p_arena, which it keeps alive. Same as make() if p_arena is null
+	[[nodiscard]] static itemProxy<comment> make(const std::shared_ptr<std::pmr::memory_resource>& p_arena);
 	[[nodiscard]] static constexpr ItemType static_type() { return ItemType::comment; }
 
-	[[nodiscard]] std::u32string&		str		();
-	[[nodiscard]] const std::u32string&	str		() const;
-	[[nodiscard]] std::u32string_view	view	() const;
+	[[nodiscard]] std::u32string_view	str		() const;	//!< Empty if \ref utf8
+	[[nodiscard]] std::u32string_view	view	() const;	//!< Empty if \ref utf8
+
+	///	\brief The text is kept as UTF-8, see \ref _p::NamedItem::utf8
+	[[nodiscard]] bool utf8() const;
+	[[nodiscard]] std::u8string_view	str_u8	() const;	//!< Empty unless \ref utf8
+	[[nodiscard]] std::u8string_view	view_u8	() const;	//!< Empty unless \ref utf8
+	[[nodiscard]] std::u32string		str_u32	() const;	//!< Copy of the text, whichever encoding it is kept in
 
 	void set	(std::u32string_view p_text);
+	void set	(std::u8string_view p_text);
 	void clear	();
+	///	\brief Converts the text already held to the new encoding
+	void set_utf8(bool p_utf8);
 };
 
 ///	\brief SCEF entity that can contain child items
 class group final: public item, public _p::NamedItem, public ItemList
 {
+	friend _p::Danger_Action;
 private:
 	group();
+	explicit group(std::pmr::memory_resource* p_resource);
+
+	_p::deferred_body m_deferred;
 
 public:
+	///	\brief Releases nested groups one level at a time, so that nesting depth is not bounded by the thread's stack
+	~group();
+
 	[[nodiscard]] static itemProxy<group> make();
+	///	\brief The item, its name and its spacing are allocated from p_arena, which it keeps alive. Same as make() if p_arena is null. Its children are not
+	[[nodiscard]] static itemProxy<group> make(const std::shared_ptr<std::pmr::memory_resource>& p_arena);
 	[[nodiscard]] static constexpr ItemType static_type() { return ItemType::group; }
 
+	///	\brief The body of the group is yet to be read with \ref document::expand, the group is empty until then
+	[[nodiscard]] inline bool deferred() const { return m_deferred.source != 0; }
+
+	///	\brief Converts the name already held to the new encoding. Children are not affected
+	void set_utf8(bool p_utf8);
+
 	_p::lineSpace m_preSpace;
 	_p::lineSpace m_postSpace;
 };
@@ -453,11 +799,17 @@ class singlet: public item, public _p::NamedItem
 {
 private:
 	singlet();
+	explicit singlet(std::pmr::memory_resource* p_resource);
 
 public:
 	[[nodiscard]] static itemProxy<singlet> make();
+	///	\brief The item, its name and its spacing are allocated from p_arena, which it keeps alive. Same as make() if p_arena is null
+	[[nodiscard]] static itemProxy<singlet> make(const std::shared_ptr<std::pmr::memory_resource>& p_arena);
 	[[nodiscard]] static constexpr ItemType static_type() { return ItemType::singlet; }
 
+	///	\brief Converts the name already held to the new encoding
+	void set_utf8(bool p_utf8);
+
 	_p::lineSpace m_postSpace;
 };
 
@@ -470,25 +822,44 @@ public:
 class keyedValue final: public item, public _p::NamedItem
 {
 private:
-	QuotationMode	_value_quotation_mode = QuotationMode::standard;
-	std::u32string	_value;
+	QuotationMode		_value_quotation_mode = QuotationMode::standard;
+	bool				_value_utf8 = false;
+	_p::item_text		_value;
 	uint64_t m_valueColumn = 0;
 
 private:
 	keyedValue();
+	explicit keyedValue(std::pmr::memory_resource* p_resource);
 
 public:
+	~keyedValue();
+
 	[[nodiscard]] static itemProxy<keyedValue> make();
+	///	\brief The item, its text and its spacing are allocated from p_arena, which it keeps alive. Same as make() if p_arena is null
+	[[nodiscard]] static itemProxy<keyedValue> make(const std::shared_ptr<std::pmr::memory_resource>& p_arena);
 	[[nodiscard]] static constexpr ItemType static_type(){ return ItemType::key_value; }
 
-	[[nodiscard]] std::u32string&		value();
-	[[nodiscard]] const std::u32string&	value() const;
-	[[nodiscard]] std::u32string_view	view_value() const;
+	///	\brief The value is kept as UTF-8, see \ref _p::NamedItem::utf8. Same as utf8() unless only the name or the value was converted
+	[[nodiscard]] bool value_utf8() const;
+
+	[[nodiscard]] std::u32string_view	value() const;			//!< Empty if \ref value_utf8
+	[[nodiscard]] std::u32string_view	view_value() const;		//!< Empty if \ref value_utf8
+	[[nodiscard]] std::u8string_view	value_u8() const;		//!< Empty unless \ref value_utf8
+	[[nodiscard]] std::u8string_view	view_value_u8() const;	//!< Empty unless \ref value_utf8
+	[[nodiscard]] std::u32string		value_u32() const;		//!< Copy of the value, whichever encoding it is kept in
 
 	template<core::char_conv_dec_supported_c T>
-	[[nodiscard]] inline ::core::from_chars_result<T> value_as_num() const { return core::from_chars<T>(_value); };
+	[[nodiscard]] inline ::core::from_chars_result<T> value_as_num() const
+	{
+		if(_value_utf8) return core::from_chars<T>(std::u8string_view{_value.u8});
+		return core::from_chars<T>(std::u32string_view{_value.u32});
+	};
 
 	void set_value(std::u32string_view p_text);
+	void set_value(std::u8string_view p_text);
+
+	///	\brief Converts the name and value already held to the new encoding
+	void set_utf8(bool p_utf8);
 
 	[[nodiscard]] QuotationMode value_quotation_mode() const;
 
@@ -518,7 +889,8 @@ inline bool _t_list_iterator::operator != (const _t_list_iterator&			p_other) co
 inline bool _t_list_iterator::operator == (const _t_list_const_iterator&	p_other) const { return _node == p_other._node; }
 inline bool _t_list_iterator::operator != (const _t_list_const_iterator&	p_other) const { return _node != p_other._node; }
 
-inline itemProxy<item> _t_list_iterator::operator * () const { return _node.operator *(); }
+inline itemRef<item>	_t_list_iterator::operator *	() const { return itemRef<item>{_node->get()}; }
+inline item*			_t_list_iterator::operator ->	() const { return _node->get(); }
 
 inline bool					_t_list_iterator::is_end		() const	{ return _node == _end; }
 inline ItemType				_t_list_iterator::mask			() const	{ return _mask; }
@@ -536,30 +908,71 @@ inline bool _t_list_const_iterator::operator != (const _t_list_iterator&		p_othe
 inline bool _t_list_const_iterator::operator == (const _t_list_const_iterator&	p_other) const { return _node == p_other._node; }
 inline bool _t_list_const_iterator::operator != (const _t_list_const_iterator&	p_other) const { return _node != p_other._node; }
 
-inline itemProxy<const item> _t_list_const_iterator::operator * () const { return _node.operator *(); }
+inline itemRef<const item>	_t_list_const_iterator::operator *	() const { return itemRef<const item>{_node->get()}; }
+inline const item*			_t_list_const_iterator::operator ->	() const { return _node->get(); }
 
 inline bool					_t_list_const_iterator::is_end		() const { return _node == _end; }
 inline ItemType				_t_list_const_iterator::mask		() const { return _mask; }
 inline _list_const_iterator	_t_list_const_iterator::to_const_it	() const { return _node; }
 
-//======== ======== class NamedItem
-inline NamedItem::NamedItem(): _quotation_mode(QuotationMode::standard){}
+//======== ======== class item_text
+inline void item_text::destroy(bool p_utf8)
+{
+	if(p_utf8) u8.~basic_string();
+	else u32.~basic_string();
+}
+
+inline void item_text::assign(bool p_utf8, std::u32string_view p_text)
+{
+	if(p_utf8) encode_item_text(p_text, u8);
+	else u32 = p_text;
+}
+
+inline void item_text::assign(bool p_utf8, std::u8string_view p_text)
+{
+	if(p_utf8) u8 = p_text;
+	else decode_item_text(p_text, u32);
+}
+
+inline void item_text::clear(bool p_utf8)
+{
+	if(p_utf8) u8.clear();
+	else u32.clear();
+}
 
-inline std::u32string&			NamedItem::name					()								{ return _name; }
-inline const std::u32string&	NamedItem::name					() const 						{ return _name; }
-inline std::u32string_view		NamedItem::view_name			() const						{ return _name; }
-inline void						NamedItem::set_name				(std::u32string_view p_text)	{ _name = p_text; }
+inline bool item_text::empty(bool p_utf8) const { return p_utf8 ? u8.empty() : u32.empty(); }
+
+//======== ======== class NamedItem
+inline NamedItem::NamedItem(): NamedItem(std::pmr::get_default_resource()) {}
+inline NamedItem::NamedItem(std::pmr::memory_resource* p_resource): _quotation_mode(QuotationMode::standard), _resource(p_resource), _name(p_resource) {}
+inline NamedItem::NamedItem(const NamedItem& p_other): NamedItem() { *this = p_other; }
+inline NamedItem::~NamedItem() { if(_interned) _name.sym->release(); else _name.destroy(_utf8); }
+
+inline bool						NamedItem::utf8					() const						{ return _utf8; }
+inline std::u32string_view		NamedItem::name					() const 						{ return _interned ? std::u32string_view{_name.sym->name} : _utf8 ? std::u32string_view{} : std::u32string_view{_name.u32}; }
+inline std::u32string_view		NamedItem::view_name			() const						{ return name(); }
+inline std::u8string_view		NamedItem::name_u8				() const 						{ return _utf8 ? std::u8string_view{_name.u8} : std::u8string_view{}; }
+inline std::u8string_view		NamedItem::view_name_u8			() const						{ return name_u8(); }
+inline std::u32string			NamedItem::name_u32				() const						{ if(!_utf8) return std::u32string{name()}; std::u32string t_name; decode_item_text(_name.u8, t_name); return t_name; }
+inline symbol					NamedItem::name_symbol			() const						{ return _interned ? symbol{_name.sym} : symbol{}; }
+inline const symbol_entry*		NamedItem::name_entry			() const						{ return _interned ? _name.sym : nullptr; }
+inline void						NamedItem::set_name				(std::u32string_view p_text)	{ if(_indexed) renamed(); if(_interned) release_symbol(false); _name.assign(_utf8, p_text); }
+inline void						NamedItem::set_name				(std::u8string_view p_text)		{ if(_indexed) renamed(); if(_interned) release_symbol(false); _name.assign(_utf8, p_text); }
 inline QuotationMode			NamedItem::quotation_mode		() const						{ return _quotation_mode; }
 inline void						NamedItem::set_quotation_mode	(QuotationMode p_mode)			{ _quotation_mode = p_mode; }
-inline void						NamedItem::clear_name			()								{ _name.clear(); }
+inline void						NamedItem::clear_name			()								{ if(_indexed) renamed(); if(_interned) release_symbol(false); else _name.clear(_utf8); }
 
 
 //======== ======== class lineSpace
+inline lineSpace::lineSpace(std::pmr::memory_resource* p_resource): _space(p_resource) {}
+
 inline std::u8string_view	lineSpace::spacing	() const	{ return _space; }
 inline void					lineSpace::clear	()			{ _space.clear(); }
 
 
 //======== ======== class multiLineSpace
+inline multiLineSpace::multiLineSpace(std::pmr::memory_resource* p_resource): _space(p_resource) {}
+
 inline std::u8string_view	multiLineSpace::flat_spacing	() const	{ return _space; }
 inline uint64_t				multiLineSpace::num_lines		() const	{ return _lines; }
 inline void					multiLineSpace::clear			()			{ _lines = 0; _space.clear(); }
@@ -569,22 +982,62 @@ inline void					multiLineSpace::clear			()			{ _lines = 0; _space.clear(); }
 //======== ======== class constTypeListProxy
 inline constTypeListProxy::constTypeListProxy(const ItemList& p_list, ItemType p_type): _list{p_list}, _type{p_type} {}
 inline void constTypeListProxy::mutate(ItemType p_type) { _type = p_type; }
-inline const_type_iterator constTypeListProxy::begin	() const	{ return const_type_iterator{_list.cbegin(), _list.cend(), _type}; }
+inline const_type_iterator constTypeListProxy::begin	() const	{ return _list.typed_begin(_type); }
 inline const_type_iterator constTypeListProxy::end		() const	{ return const_type_iterator{_list.cend  (), _list.cend(), _type}; }
-inline const_type_iterator constTypeListProxy::cbegin	() const	{ return const_type_iterator{_list.cbegin(), _list.cend(), _type}; }
+inline const_type_iterator constTypeListProxy::cbegin	() const	{ return _list.typed_begin(_type); }
 inline const_type_iterator constTypeListProxy::cend		() const	{ return const_type_iterator{_list.cend  (), _list.cend(), _type}; }
 
 //======== ======== class TypeListProxy
 inline TypeListProxy::TypeListProxy(ItemList& p_list, ItemType p_type): _list{p_list}, _type{p_type} {}
 inline void TypeListProxy::mutate(ItemType p_type) { _type = p_type; }
-inline type_iterator		TypeListProxy::begin	()			{ return type_iterator		{_list.begin (), _list.end (), _type}; }
+inline type_iterator		TypeListProxy::begin	()			{ return _list.typed_begin(_type); }
 inline type_iterator		TypeListProxy::end		()			{ return type_iterator		{_list.end   (), _list.end (), _type}; }
-inline const_type_iterator	TypeListProxy::begin	() const	{ return const_type_iterator{_list.cbegin(), _list.cend(), _type}; }
+inline const_type_iterator	TypeListProxy::begin	() const	{ return std::as_const(_list).typed_begin(_type); }
 inline const_type_iterator	TypeListProxy::end		() const	{ return const_type_iterator{_list.cend  (), _list.cend(), _type}; }
-inline const_type_iterator	TypeListProxy::cbegin	() const	{ return const_type_iterator{_list.cbegin(), _list.cend(), _type}; }
+inline const_type_iterator	TypeListProxy::cbegin	() const	{ return std::as_const(_list).typed_begin(_type); }
 inline const_type_iterator	TypeListProxy::cend		() const	{ return const_type_iterator{_list.cend  (), _list.cend(), _type}; }
 
 //======== ======== class ItemList
+inline void				ItemList::clear		()																{ ++m_changes; _p::_p_item_list::clear(); }
+inline void				ItemList::push_back	(const itemProxy<item>& p_item)									{ ++m_changes; _p::_p_item_list::push_back(p_item); }
+inline void				ItemList::push_back	(itemProxy<item>&& p_item)										{ ++m_changes; _p::_p_item_list::push_back(std::move(p_item)); }
+inline void				ItemList::pop_back	()																{ ++m_changes; _p::_p_item_list::pop_back(); }
+inline iterator			ItemList::erase		(const_iterator p_pos)											{ ++m_changes; return _p::_p_item_list::erase(p_pos); }
+inline iterator			ItemList::erase		(const_iterator p_first, const_iterator p_last)					{ ++m_changes; return _p::_p_item_list::erase(p_first, p_last); }
+inline iterator			ItemList::insert	(const_iterator p_pos, std::initializer_list<itemProxy<item>> p_items)	{ ++m_changes; return _p::_p_item_list::insert(p_pos, p_items); }
+inline void				ItemList::assign	(std::initializer_list<itemProxy<item>> p_items)				{ ++m_changes; _p::_p_item_list::assign(p_items); }
+inline void				ItemList::resize	(size_type p_count)												{ ++m_changes; _p::_p_item_list::resize(p_count); }
+inline void				ItemList::resize	(size_type p_count, const itemProxy<item>& p_item)				{ ++m_changes; _p::_p_item_list::resize(p_count, p_item); }
+inline void				ItemList::swap		(ItemList& p_other)												{ ++m_changes; ++p_other.m_changes; _p::_p_item_list::swap(p_other); }
+
+template<typename... Args>
+inline itemProxy<item>& ItemList::emplace_back(Args&&... p_args)
+{
+	++m_changes;
+	return _p::_p_item_list::emplace_back(std::forward<Args>(p_args)...);
+}
+
+template<typename... Args>
+inline iterator ItemList::emplace(const_iterator p_pos, Args&&... p_args)
+{
+	++m_changes;
+	return _p::_p_item_list::emplace(p_pos, std::forward<Args>(p_args)...);
+}
+
+template<typename... Args>
+inline iterator ItemList::insert(const_iterator p_pos, Args&&... p_args)
+{
+	++m_changes;
+	return _p::_p_item_list::insert(p_pos, std::forward<Args>(p_args)...);
+}
+
+template<typename... Args>
+inline void ItemList::assign(Args&&... p_args)
+{
+	++m_changes;
+	_p::_p_item_list::assign(std::forward<Args>(p_args)...);
+}
+
 inline type_iterator		ItemList::convert2type_iterator			(iterator p_other,			ItemType p_type)		{ return type_iterator		(p_other, end (), p_type); }
 inline const_type_iterator	ItemList::convert2const_type_iterator	(iterator p_other,			ItemType p_type) const	{ return const_type_iterator(p_other, cend(), p_type); }
 inline const_type_iterator	ItemList::convert2const_type_iterator	(const_iterator p_other,	ItemType p_type) const	{ return const_type_iterator(p_other, cend(), p_type); }
@@ -602,39 +1055,82 @@ inline void			item::set_position(uint64_t p_line, uint64_t p_column) { _line = p
 
 //======== ======== class spacer
 inline spacer::spacer(): item(static_type()) {}
+inline spacer::spacer(std::pmr::memory_resource* p_resource): item(static_type()), multiLineSpace(p_resource) {}
 inline itemProxy<spacer> spacer::make() { return itemProxy<spacer>{new spacer()}; }
+inline itemProxy<spacer> spacer::make(const std::shared_ptr<std::pmr::memory_resource>& p_arena)
+{
+	if(!p_arena) return make();
+	return _p::adopt_item(new (p_arena->allocate(sizeof(spacer), alignof(spacer))) spacer(p_arena.get()), p_arena);
+}
 
 //======== ======== class comment
-inline comment::comment(): item(static_type()) {}
+inline comment::comment(): comment(std::pmr::get_default_resource()) {}
+inline comment::comment(std::pmr::memory_resource* p_resource): item(static_type()), _text(p_resource) {}
+inline comment::~comment() { _text.destroy(_utf8); }
 inline itemProxy<comment> comment::make() { return itemProxy<comment>{new comment()}; }
+inline itemProxy<comment> comment::make(const std::shared_ptr<std::pmr::memory_resource>& p_arena)
+{
+	if(!p_arena) return make();
+	return _p::adopt_item(new (p_arena->allocate(sizeof(comment), alignof(comment))) comment(p_arena.get()), p_arena);
+}
 
-inline std::u32string&			comment::str	()								{ return _text; }
-inline const std::u32string&	comment::str	() const						{ return _text; }
-inline std::u32string_view		comment::view	() const						{ return _text; }
-inline void						comment::set	(std::u32string_view p_text)	{ _text = p_text; }
-inline void						comment::clear	()								{ _text.clear(); }
+inline std::u32string_view		comment::str	() const						{ return _utf8 ? std::u32string_view{} : std::u32string_view{_text.u32}; }
+inline std::u32string_view		comment::view	() const						{ return str(); }
+inline bool						comment::utf8	() const						{ return _utf8; }
+inline std::u8string_view		comment::str_u8	() const						{ return _utf8 ? std::u8string_view{_text.u8} : std::u8string_view{}; }
+inline std::u8string_view		comment::view_u8	() const					{ return str_u8(); }
+inline std::u32string			comment::str_u32	() const					{ if(!_utf8) return std::u32string{_text.u32}; std::u32string t_text; _p::decode_item_text(_text.u8, t_text); return t_text; }
+inline void						comment::set	(std::u32string_view p_text)	{ _text.assign(_utf8, p_text); }
+inline void						comment::set	(std::u8string_view p_text)		{ _text.assign(_utf8, p_text); }
+inline void						comment::clear	()								{ _text.clear(_utf8); }
 
 //======== ======== class singlet
 inline singlet::singlet(): item(static_type()), NamedItem() {}
+inline singlet::singlet(std::pmr::memory_resource* p_resource): item(static_type()), NamedItem(p_resource), m_postSpace(p_resource) {}
 inline itemProxy<singlet> singlet::make() { return itemProxy<singlet>{new singlet()}; }
+inline itemProxy<singlet> singlet::make(const std::shared_ptr<std::pmr::memory_resource>& p_arena)
+{
+	if(!p_arena) return make();
+	return _p::adopt_item(new (p_arena->allocate(sizeof(singlet), alignof(singlet))) singlet(p_arena.get()), p_arena);
+}
+inline void singlet::set_utf8(bool p_utf8) { convert_name(p_utf8); }
 
 //======== ======== class keyedValue
-inline keyedValue::keyedValue(): item(static_type()), NamedItem() {}
+inline keyedValue::keyedValue(): keyedValue(std::pmr::get_default_resource()) {}
+inline keyedValue::keyedValue(std::pmr::memory_resource* p_resource): item(static_type()), NamedItem(p_resource), _value(p_resource), m_preSpace(p_resource), m_midSpace(p_resource), m_postSpace(p_resource) {}
 inline itemProxy<keyedValue> keyedValue::make() { return itemProxy<keyedValue>{new keyedValue()}; }
+inline itemProxy<keyedValue> keyedValue::make(const std::shared_ptr<std::pmr::memory_resource>& p_arena)
+{
+	if(!p_arena) return make();
+	return _p::adopt_item(new (p_arena->allocate(sizeof(keyedValue), alignof(keyedValue))) keyedValue(p_arena.get()), p_arena);
+}
 
-inline std::u32string&			keyedValue::value()									{ return _value; }
-inline const std::u32string&	keyedValue::value() const 							{ return _value; }
-inline std::u32string_view		keyedValue::view_value() const						{ return _value; }
-inline void						keyedValue::set_value(std::u32string_view p_text)	{ _value = p_text; }
+inline keyedValue::~keyedValue() { _value.destroy(_value_utf8); }
+
+inline bool						keyedValue::value_utf8() const						{ return _value_utf8; }
+inline std::u32string_view		keyedValue::value() const 							{ return _value_utf8 ? std::u32string_view{} : std::u32string_view{_value.u32}; }
+inline std::u32string_view		keyedValue::view_value() const						{ return value(); }
+inline std::u8string_view		keyedValue::value_u8() const 						{ return _value_utf8 ? std::u8string_view{_value.u8} : std::u8string_view{}; }
+inline std::u8string_view		keyedValue::view_value_u8() const					{ return value_u8(); }
+inline std::u32string			keyedValue::value_u32() const						{ if(!_value_utf8) return std::u32string{_value.u32}; std::u32string t_value; _p::decode_item_text(_value.u8, t_value); return t_value; }
+inline void						keyedValue::set_value(std::u32string_view p_text)	{ _value.assign(_value_utf8, p_text); }
+inline void						keyedValue::set_value(std::u8string_view p_text)	{ _value.assign(_value_utf8, p_text); }
 
 inline QuotationMode	keyedValue::value_quotation_mode	() const				{ return _value_quotation_mode; }
 inline void				keyedValue::set_value_quotation_mode(QuotationMode p_mode)	{ _value_quotation_mode = p_mode; }
-inline void				keyedValue::clear_value				()						{ _value.clear(); }
+inline void				keyedValue::clear_value				()						{ _value.clear(_value_utf8); }
 inline uint64_t			keyedValue::column_value			() const				{ return m_valueColumn; }
 inline void				keyedValue::set_column_value		(uint64_t p_column)		{ m_valueColumn = p_column; }
 
 //======== ======== class group
 inline group::group(): item(static_type()), NamedItem() {}
+inline group::group(std::pmr::memory_resource* p_resource): item(static_type()), NamedItem(p_resource), m_preSpace(p_resource), m_postSpace(p_resource) {}
 inline itemProxy<group> group::make() { return itemProxy<group>{new group()}; }
+inline itemProxy<group> group::make(const std::shared_ptr<std::pmr::memory_resource>& p_arena)
+{
+	if(!p_arena) return make();
+	return _p::adopt_item(new (p_arena->allocate(sizeof(group), alignof(group))) group(p_arena.get()), p_arena);
+}
+inline void group::set_utf8(bool p_utf8) { convert_name(p_utf8); }
 
 } //namespace scef
@@ -28,6 +28,7 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 #include <istream>
 #include <ostream>
 #include <filesystem>
@@ -60,6 +61,11 @@ public:
 
 	virtual void set_pos(uint64_t pos) = 0;
 
+	// Optional capability, for streams that already hold their data contiguously in memory.
+	// Returns the bytes from pos() to the end of the stream, or an empty span if not supported.
+	// Does not advance the stream, the view must remain valid for as long as the stream exists.
+	[[nodiscard]] virtual std::span<const char8_t> contiguous_view() const;
+
 	[[nodiscard]] inline uint64_t size		() const { return _size; }
 	[[nodiscard]] inline uint64_t remaining	() const { return _size - pos(); }
 };
@@ -135,6 +141,36 @@ public:
 	stream_error write(const void* p_buffer, uintptr_t p_size) override;
 };
 
+///	\brief
+///		Maps an entire file into memory (read-only) and reads it like a \ref buffer_istream
+///	\note
+///		1. The file must not be modified while mapped
+class mmap_istream: public base_istreamer
+{
+private:
+	const char8_t*	_first	= nullptr;
+	const char8_t*	_pivot	= nullptr;
+
+public:
+	mmap_istream() = default;
+	~mmap_istream();
+
+	mmap_istream(const mmap_istream&)				= delete;
+	mmap_istream& operator = (const mmap_istream&)	= delete;
+
+	bool open(const std::filesystem::path& p_file);
+	void close();
+	[[nodiscard]] inline bool is_open() const { return _first != nullptr; }
+
+	uintptr_t read(void* p_buffer, uintptr_t p_size) override;
+	stream_error stat() const override;
+
+	uint64_t pos() const override;
+	void set_pos(uint64_t p_pos) override;
+
+	std::span<const char8_t> contiguous_view() const override;
+};
+
 
 //======== ======== ======== generic ======== ======== ========
 class buffer_istream: public base_istreamer
@@ -153,6 +189,8 @@ public:
 
 	uint64_t pos() const override;
 	void set_pos(uint64_t pos) override;
+
+	std::span<const char8_t> contiguous_view() const override;
 };	//class buffer_istream
 
 }	// namespace scef
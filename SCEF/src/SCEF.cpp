@@ -29,6 +29,10 @@
 
 #include <memory>
 #include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 #include <CoreLib/core_endian.hpp>
 #include <CoreLib/core_file.hpp>
@@ -37,6 +41,7 @@
 #include "scef_format.hpp"
 #include "scef_format_v1.hpp"
 #include "scef_danger_act_p.hpp"
+#include "scef_symbols_p.hpp"
 
 namespace scef
 {
@@ -77,71 +82,67 @@ void _Error_Context::SetErrorPrematureEnding(char32_t p_expected)
 	m_extra.premature_ending.expected	= p_expected;
 }
 
-} //namespace _p
-
-//======== document
+using make_decoder_f = std::unique_ptr<stream_decoder> (*)(base_istreamer&);
 
-void document::clear()
+//Keeps what the groups deferred by a load are read from, for as long as the document refers to them
+class deferred_source
 {
-	m_document_properties.version	= __SCEF_NO_VERSION;
-	m_document_properties.encoding	= Encoding::Unspecified;
-	m_last_error.clear();
-	m_rootObject.clear();
-}
+public:
+	core::file_read						m_file;			//!< When loaded from a file that is not mapped
+	std::unique_ptr<base_istreamer>		m_fileStream;	//!< When loaded from a file
+	std::unique_ptr<stream_decoder>		m_decoder;
+	make_decoder_f						m_make			= nullptr;	//!< Decoders of the same type, for other streams over the same data
+	format::v1::expand_f				m_expand		= nullptr;
+	Flag								m_flags			= Flag::Default;
+	_warning_callback					m_callback		= nullptr;
+	void*								m_user_context	= nullptr;
+	const uint64_t						m_id			= next_id();	//!< Marks the groups deferred from here
 
-Error document::load(const std::filesystem::path& p_file, Flag p_flags, _warning_callback p_warning_callback, void* p_user_context)
-{
-	core::file_read f_reader;
-	f_reader.open(p_file);
-	if(f_reader.is_open())
+private:
+	static uint64_t next_id()
 	{
-		file_istream t_reader{f_reader};
-		return load(t_reader, p_flags, p_warning_callback, p_user_context);
+		static std::atomic<uint64_t> s_last{0};
+		return ++s_last;
 	}
-	m_last_error.clear();
-	_p::Danger_Action::publicError(m_last_error).SetPlainError(Error::FileNotFound);
+};
 
-	m_document_properties.encoding	= Encoding::Unspecified;
-	m_document_properties.version	= __SCEF_NO_VERSION;
-	m_rootObject.clear();
+} //namespace _p
 
-	return m_last_error.error_code();
-}
+//what is compiled for each concrete decoder type
+struct decoder_kind
+{
+	_p::make_decoder_f			decoder		= nullptr;
+	format::v1::load_f			load_v1		= nullptr;
+	format::v1::expand_f		expand_v1	= nullptr;
+	format::v1::make_cursor_f	cursor_v1	= nullptr;
+};
 
-Error document::save(const std::filesystem::path& p_file, Flag p_flags, uint16_t p_version, Encoding p_encoding)
+template<typename Decoder>
+static std::unique_ptr<stream_decoder> make_decoder(base_istreamer& p_stream)
 {
-	if(!write_supports_version(p_version))
-	{
-		return Error::UnsuportedVersion;
-	}
+	return std::make_unique<Decoder>(p_stream);
+}
 
-	core::file_write f_writer;
-	f_writer.open(p_file, core::file_write::open_mode::create);
-	if(f_writer.is_open())
-	{
-		file_ostream t_writer{f_writer};
-		return save(t_writer, p_flags, p_version, p_encoding);
-	}
-	return Error::Unable2Write;
+template<typename Decoder>
+static void select_decoder(base_istreamer& p_stream, std::unique_ptr<stream_decoder>& p_decoder, decoder_kind& p_kind)
+{
+	p_decoder			= std::make_unique<Decoder>(p_stream);
+	p_kind.decoder		= make_decoder<Decoder>;
+	p_kind.load_v1		= format::v1::load<Decoder>;
+	p_kind.expand_v1	= format::v1::expand<Decoder>;
+	p_kind.cursor_v1	= format::v1::make_cursor<Decoder>;
 }
 
+//Detects the encoding and version of the document, and picks the decoder for it
 //Note:
 //	1.	It is known that if the characters 0xEF, 0xFE, or 0xFF, appear at the beginning
 //		of the document while not indicating an encoding, this parser is not capable
 //		of handling the document, as read backtracking is not supported on this implementation
-Error document::load(base_istreamer& p_stream, Flag p_flags, _warning_callback p_warning_callback, void* p_user_context)
+//	2.	Returns Error::None if the document can be read from p_decoder on
+static Error open_document(base_istreamer& p_stream, Flag p_flags, format::_Warning_Def& p_warn, document::doc_prop& p_prop, std::unique_ptr<stream_decoder>& p_decoder, decoder_kind& p_kind)
 {
-	Encoding t_encoding	= Encoding::Unspecified;
-	std::unique_ptr<stream_decoder> t_decoder;
-
-	clear();
-
-	if(p_warning_callback == nullptr) p_warning_callback = DefaultWarningHandler;
-
-	format::_Warning_Def		t_warn;
-	t_warn._error_context			= &m_last_error;
-	t_warn._user_context			= p_user_context;
-	t_warn._user_warning_callback	= p_warning_callback;
+	Error_Context& t_error	= *p_warn._error_context;
+	Encoding t_encoding		= Encoding::Unspecified;
 
 	{
 		char8_t t_Sequence[4];
@@ -151,10 +152,10 @@ Error document::load(base_istreamer& p_stream, Flag p_flags, _warning_callback p
 		{
 			if(p_stream.stat() == stream_error::Control_EndOfStream)
 			{
-				_p::Danger_Action::publicError(m_last_error).SetPlainError(Error::BadFormat);
+				_p::Danger_Action::publicError(t_error).SetPlainError(Error::BadFormat);
 				return Error::BadFormat;
 			}
-			_p::Danger_Action::publicError(m_last_error).SetPlainError(Error::Unable2Read);
+			_p::Danger_Action::publicError(t_error).SetPlainError(Error::Unable2Read);
 			return Error::Unable2Read;
 		}
 
@@ -170,13 +171,13 @@ Error document::load(base_istreamer& p_stream, Flag p_flags, _warning_callback p
 						break;
 					}
 				}
-				_p::Danger_Action::publicError(m_last_error).SetPlainError(Error::BadEncoding);
+				_p::Danger_Action::publicError(t_error).SetPlainError(Error::BadEncoding);
 				return Error::BadEncoding;
 			case 0xEF:	//UTF8 or ANSI
 				{
 					constexpr uintptr_t bom_size = ENCODER_P::BOM_UTF8.size();
 					if(	std::u8string_view{ENCODER_P::BOM_UTF8.data(), bom_size} ==
-						std::u8string_view{t_Sequence + 1, bom_size})
+						std::u8string_view{t_Sequence, bom_size})
 					{
 						p_stream.set_pos(startPos + bom_size);
 						t_encoding	= Encoding::UTF8;
@@ -216,12 +217,12 @@ backup_ANSI:
 		}
 	}
 
-	m_document_properties.encoding = t_encoding;
+	p_prop.encoding = t_encoding;
 
 	//asks the user if they want to support this encoding
-	_p::Danger_Action::publicError(m_last_error).SetPlainError(Error::Warning_EncodingDetected);
-	_p::Danger_Action::publicError(m_last_error).m_extra.format = {0, t_encoding};
-	if(t_warn.Notify() > warningBehaviour::Accept)
+	_p::Danger_Action::publicError(t_error).SetPlainError(Error::Warning_EncodingDetected);
+	_p::Danger_Action::publicError(t_error).m_extra.format = {0, t_encoding};
+	if(p_warn.Notify() > warningBehaviour::Accept)
 	{
 		return Error::Warning_EncodingDetected;
 	}
@@ -231,42 +232,42 @@ backup_ANSI:
 		case Encoding::UTF8:
 			if((p_flags & Flag::LaxedEncoding) != Flag{})
 			{
-				t_decoder	= std::make_unique<ENCODER_P::Stream_UTF8_Decoder>(p_stream);
+				select_decoder<ENCODER_P::Stream_UTF8_Decoder>(p_stream, p_decoder, p_kind);
 			}
 			else
 			{
-				t_decoder	= std::make_unique<ENCODER_P::Stream_UTF8_Decoder_s>(p_stream);
+				select_decoder<ENCODER_P::Stream_UTF8_Decoder_s>(p_stream, p_decoder, p_kind);
 			}
 			break;
 		case Encoding::UTF16_LE:
 			if(p_stream.remaining() % 2)
 			{
-				_p::Danger_Action::publicError(m_last_error).SetPlainError(Error::BadPredictedEncoding);
-				warningBehaviour res = t_warn.Notify();
+				_p::Danger_Action::publicError(t_error).SetPlainError(Error::BadPredictedEncoding);
+				warningBehaviour res = p_warn.Notify();
 				if(res != warningBehaviour::Accept && res != warningBehaviour::Continue)
 				{
 					return Error::BadPredictedEncoding;
 				}
 			}
-			t_decoder	= std::make_unique<ENCODER_P::Stream_UTF16LE_Decoder>(p_stream);
+			select_decoder<ENCODER_P::Stream_UTF16LE_Decoder>(p_stream, p_decoder, p_kind);
 			break;
 		case Encoding::UTF16_BE:
 			if(p_stream.remaining() % 2)
 			{
-				_p::Danger_Action::publicError(m_last_error).SetPlainError(Error::BadPredictedEncoding);
-				warningBehaviour res = t_warn.Notify();
+				_p::Danger_Action::publicError(t_error).SetPlainError(Error::BadPredictedEncoding);
+				warningBehaviour res = p_warn.Notify();
 				if(res != warningBehaviour::Accept && res != warningBehaviour::Continue)
 				{
 					return Error::BadPredictedEncoding;
 				}
 			}
-			t_decoder	= std::make_unique<ENCODER_P::Stream_UTF16BE_Decoder>(p_stream);
+			select_decoder<ENCODER_P::Stream_UTF16BE_Decoder>(p_stream, p_decoder, p_kind);
 			break;
 		case Encoding::UCS4_LE:
 			if(p_stream.remaining() % 4)
 			{
-				_p::Danger_Action::publicError(m_last_error).SetPlainError(Error::BadPredictedEncoding);
-				warningBehaviour res = t_warn.Notify();
+				_p::Danger_Action::publicError(t_error).SetPlainError(Error::BadPredictedEncoding);
+				warningBehaviour res = p_warn.Notify();
 				if(res != warningBehaviour::Accept && res != warningBehaviour::Continue)
 				{
 					return Error::BadPredictedEncoding;
@@ -274,18 +275,18 @@ backup_ANSI:
 			}
 			if((p_flags & Flag::LaxedEncoding) != Flag{})
 			{
-				t_decoder	= std::make_unique<ENCODER_P::Stream_UCS4LE_Decoder>(p_stream);
+				select_decoder<ENCODER_P::Stream_UCS4LE_Decoder>(p_stream, p_decoder, p_kind);
 			}
 			else
 			{
-				t_decoder	= std::make_unique<ENCODER_P::Stream_UCS4LE_Decoder_s>(p_stream);
+				select_decoder<ENCODER_P::Stream_UCS4LE_Decoder_s>(p_stream, p_decoder, p_kind);
 			}
 			break;
 		case Encoding::UCS4_BE:
 			if(p_stream.remaining() % 4)
 			{
-				_p::Danger_Action::publicError(m_last_error).SetPlainError(Error::BadPredictedEncoding);
-				warningBehaviour res = t_warn.Notify();
+				_p::Danger_Action::publicError(t_error).SetPlainError(Error::BadPredictedEncoding);
+				warningBehaviour res = p_warn.Notify();
 				if(res != warningBehaviour::Accept && res != warningBehaviour::Continue)
 				{
 					return Error::BadPredictedEncoding;
@@ -293,15 +294,15 @@ backup_ANSI:
 			}
 			if((p_flags & Flag::LaxedEncoding) != Flag{})
 			{
-				t_decoder	= std::make_unique<ENCODER_P::Stream_UCS4BE_Decoder>(p_stream);
+				select_decoder<ENCODER_P::Stream_UCS4BE_Decoder>(p_stream, p_decoder, p_kind);
 			}
 			else
 			{
-				t_decoder	= std::make_unique<ENCODER_P::Stream_UCS4BE_Decoder_s>(p_stream);
+				select_decoder<ENCODER_P::Stream_UCS4BE_Decoder_s>(p_stream, p_decoder, p_kind);
 			}
 			break;
 		default:	//ANSI
-			t_decoder	= std::make_unique<ENCODER_P::Stream_ANSI_Decoder>(p_stream);
+			select_decoder<ENCODER_P::Stream_ANSI_Decoder>(p_stream, p_decoder, p_kind);
 			break;
 	}
 
@@ -310,51 +311,475 @@ backup_ANSI:
 		uint64_t startPos = p_stream.pos();
 
 		//collects version number
-		Error t_lasErr = format::FinishVersionDecoding(*t_decoder, t_version, m_last_error);
+		Error t_lasErr = format::FinishVersionDecoding(*p_decoder, t_version, t_error);
 		if(t_lasErr != Error::None)
 		{
 			if(t_lasErr != Error::Control_NoHeader || (p_flags & Flag::ForceHeader) == Flag{}) //No header found in SCEF file
 			{
-				_p::Danger_Action::publicError(m_last_error).SetPlainError(t_lasErr);
+				_p::Danger_Action::publicError(t_error).SetPlainError(t_lasErr);
 				return t_lasErr;
 			}
 			p_stream.set_pos(startPos);
-			t_decoder->reset_context();
+			p_decoder->reset_context();
 		}
 	}
 
-	if(read_supports_version(t_version)) //does the API support this version?
+	if(!document::read_supports_version(t_version)) //does the API support this version?
+	{
+		_p::Danger_Action::publicError(t_error).SetPlainError(Error::UnsuportedVersion);
+		return Error::UnsuportedVersion;
+	}
+
+	//asks the user if they want to support this version
+	_p::Danger_Action::publicError(t_error).SetPlainError(Error::Warning_VersionDetected);
+	_p::Danger_Action::publicError(t_error).m_extra.format = {t_version, t_encoding};
+	if(p_warn.Notify() > warningBehaviour::Accept)
+	{
+		return Error::Warning_VersionDetected;
+	}
+
+	//in case version = 0, i.e. no header, tries to deformat with most recent API version
+	if(t_version == __SCEF_NO_VERSION) t_version = __SCEF_API_VERSION;
+	p_prop.version = t_version;
+
+	return Error::None;
+}
+
+//======== path_filter
+
+path_filter::path_filter(std::initializer_list<std::u32string_view> p_paths)
+{
+	for(std::u32string_view t_path : p_paths)
+	{
+		add(t_path);
+	}
+}
+
+void path_filter::add(std::u32string_view p_path)
+{
+	uint32_t t_index = 0;
+	bool t_empty = true;
+	while(!p_path.empty())
 	{
-		//asks the user if they want to support this version
-		_p::Danger_Action::publicError(m_last_error).SetPlainError(Error::Warning_VersionDetected);
-		_p::Danger_Action::publicError(m_last_error).m_extra.format = {t_version, t_encoding};
-		if(t_warn.Notify() > warningBehaviour::Accept)
+		const uintptr_t t_split = p_path.find(U'/');
+		const std::u32string_view t_name = p_path.substr(0, t_split);
+		p_path = t_split == std::u32string_view::npos ? std::u32string_view{} : p_path.substr(t_split + 1);
+		if(t_name.empty()) continue;
+
+		const bool t_any = t_name == U"*";
+		uint32_t t_next = 0;
+		for(uint32_t t_child : m_nodes[t_index].m_children)
 		{
-			return Error::Warning_VersionDetected;
+			if(m_nodes[t_child].m_any == t_any && m_nodes[t_child].m_name == t_name)
+			{
+				t_next = t_child;
+				break;
+			}
 		}
-		else
+		if(t_next == 0)
 		{
-			//in case version = 0, i.e. no header, tries to deformat with most recent API version
-			if(t_version == __SCEF_NO_VERSION) t_version = __SCEF_API_VERSION;
+			t_next = static_cast<uint32_t>(m_nodes.size());
+			m_nodes.emplace_back();
+			m_nodes.back().m_any = t_any;
+			if(!t_any) m_nodes.back().m_name = t_name;
+			m_nodes[t_index].m_children.push_back(t_next);
 		}
-		m_document_properties.version = t_version;
+		t_index = t_next;
+		t_empty = false;
+	}
 
-		//chooses the formater version to use
-		switch(t_version)
+	if(!t_empty) m_nodes[t_index].m_whole = true;
+}
+
+void path_filter::clear()
+{
+	m_nodes.resize(1);
+	m_nodes[0].m_children.clear();
+}
+
+path_filter::match path_filter::find(std::span<const uint32_t> p_nodes, std::u32string_view p_name, std::vector<uint32_t>& p_next) const
+{
+	p_next.clear();
+	for(uint32_t t_index : p_nodes)
+	{
+		for(uint32_t t_child : m_nodes[t_index].m_children)
 		{
-			case 1: //start decoding based on version
-				{
-					format::v1::load(m_rootObject, *t_decoder, p_flags, t_version, t_warn);
-				}
-				break;
-			default: //cosmic rays maybe?
-				_p::Danger_Action::publicError(m_last_error).SetPlainError(Error::UnknownInternal);
-				break;
+			const node& t_node = m_nodes[t_child];
+			if(t_node.m_any || t_node.m_name == p_name)
+			{
+				if(t_node.m_whole) return match::whole;
+				p_next.push_back(t_child);
+			}
+		}
+	}
+	return p_next.empty() ? match::none : match::partial;
+}
+
+//======== document
+
+document::document(std::pmr::memory_resource* p_upstream)
+	: m_upstream(p_upstream)
+{
+	add_arena();
+}
+
+void document::clear()
+{
+	m_document_properties.version	= __SCEF_NO_VERSION;
+	m_document_properties.encoding	= Encoding::Unspecified;
+	m_last_error.clear();
+	m_rootObject.clear();
+	m_rootObject.drop_name_index();
+	m_rootObject.drop_type_index();
+	m_deferred.reset();
+	//names only the items just released had
+	if(m_symbols) m_symbols->sweep();
+
+	//the arena goes back in one go once the items that were kept from it are gone as well
+	if(m_upstream)
+	{
+		m_arenas.clear();
+		add_arena();
+	}
+}
+
+std::shared_ptr<std::pmr::memory_resource> document::resource() const
+{
+	return m_arenas.empty() ? nullptr : m_arenas.front();
+}
+
+_p::symbol_table* document::symbols(Flag p_flags)
+{
+	if((p_flags & Flag::InternNames) == Flag{} || (p_flags & Flag::Utf8Text) != Flag{})
+	{
+		return nullptr;
+	}
+	//not from an arena, the names are kept for as long as items have them
+	if(!m_symbols)
+	{
+		m_symbols = _p::symbol_table::make(m_upstream ? m_upstream : std::pmr::get_default_resource());
+	}
+	return m_symbols.get();
+}
+
+symbol document::find_symbol(std::u32string_view p_name) const
+{
+	return m_symbols ? m_symbols->find(p_name) : symbol{};
+}
+
+std::shared_ptr<std::pmr::memory_resource> document::add_arena()
+{
+	if(!m_upstream)
+	{
+		return nullptr;
+	}
+	return m_arenas.emplace_back(std::make_shared<std::pmr::monotonic_buffer_resource>(m_upstream));
+}
+
+//Files at least this big are memory mapped instead of read
+constexpr uint64_t mmap_threshold = 0x100000;
+
+//p_stream reads from p_file, and from p_file_read if the file is not mapped
+static bool open_file(const std::filesystem::path& p_file, core::file_read& p_file_read, std::unique_ptr<base_istreamer>& p_stream)
+{
+	{
+		std::error_code ec;
+		if(std::filesystem::is_regular_file(p_file, ec) && std::filesystem::file_size(p_file, ec) >= mmap_threshold && !ec)
+		{
+			std::unique_ptr<mmap_istream> t_mapped = std::make_unique<mmap_istream>();
+			if(t_mapped->open(p_file))
+			{
+				p_stream = std::move(t_mapped);
+				return true;
+			}
+		}
+	}
+
+	p_file_read.open(p_file);
+	if(!p_file_read.is_open())
+	{
+		return false;
+	}
+	p_stream = std::make_unique<file_istream>(p_file_read);
+	return true;
+}
+
+Error document::load(const std::filesystem::path& p_file, Flag p_flags, _warning_callback p_warning_callback, void* p_user_context)
+{
+	return _load(p_file, nullptr, nullptr, p_flags, p_warning_callback, p_user_context);
+}
+
+Error document::load(const std::filesystem::path& p_file, event_handler& p_handler, Flag p_flags, _warning_callback p_warning_callback, void* p_user_context)
+{
+	return _load(p_file, &p_handler, nullptr, p_flags, p_warning_callback, p_user_context);
+}
+
+Error document::load(base_istreamer& p_stream, Flag p_flags, _warning_callback p_warning_callback, void* p_user_context)
+{
+	return _load(p_stream, nullptr, nullptr, nullptr, p_flags, p_warning_callback, p_user_context);
+}
+
+Error document::load(base_istreamer& p_stream, event_handler& p_handler, Flag p_flags, _warning_callback p_warning_callback, void* p_user_context)
+{
+	return _load(p_stream, nullptr, &p_handler, nullptr, p_flags, p_warning_callback, p_user_context);
+}
+
+Error document::load(const std::filesystem::path& p_file, const path_filter& p_filter, Flag p_flags, _warning_callback p_warning_callback, void* p_user_context)
+{
+	return _load(p_file, nullptr, &p_filter, p_flags, p_warning_callback, p_user_context);
+}
+
+Error document::load(base_istreamer& p_stream, const path_filter& p_filter, Flag p_flags, _warning_callback p_warning_callback, void* p_user_context)
+{
+	return _load(p_stream, nullptr, nullptr, &p_filter, p_flags, p_warning_callback, p_user_context);
+}
+
+Error document::_load(const std::filesystem::path& p_file, event_handler* p_handler, const path_filter* p_filter, Flag p_flags, _warning_callback p_warning_callback, void* p_user_context)
+{
+	//deferred groups are read from the file later on, so the source keeps it open
+	if((p_flags & Flag::DeferGroups) != Flag{} && p_handler == nullptr)
+	{
+		std::shared_ptr<_p::deferred_source> t_source = std::make_shared<_p::deferred_source>();
+		if(open_file(p_file, t_source->m_file, t_source->m_fileStream))
+		{
+			base_istreamer& t_reader = *t_source->m_fileStream;
+			return _load(t_reader, std::move(t_source), p_handler, p_filter, p_flags, p_warning_callback, p_user_context);
 		}
 	}
 	else
 	{
-		_p::Danger_Action::publicError(m_last_error).SetPlainError(Error::UnsuportedVersion);
+		core::file_read f_reader;
+		std::unique_ptr<base_istreamer> t_reader;
+		if(open_file(p_file, f_reader, t_reader))
+		{
+			return _load(*t_reader, nullptr, p_handler, p_filter, p_flags, p_warning_callback, p_user_context);
+		}
+	}
+	clear();
+	_p::Danger_Action::publicError(m_last_error).SetPlainError(Error::FileNotFound);
+
+	return m_last_error.error_code();
+}
+
+Error document::save(const std::filesystem::path& p_file, Flag p_flags, uint16_t p_version, Encoding p_encoding)
+{
+	if(!write_supports_version(p_version))
+	{
+		return Error::UnsuportedVersion;
+	}
+
+	core::file_write f_writer;
+	f_writer.open(p_file, core::file_write::open_mode::create);
+	if(f_writer.is_open())
+	{
+		file_ostream t_writer{f_writer};
+		return save(t_writer, p_flags, p_version, p_encoding);
+	}
+	return Error::Unable2Write;
+}
+
+Error document::_load(base_istreamer& p_stream, std::shared_ptr<_p::deferred_source> p_source, event_handler* p_handler, const path_filter* p_filter, Flag p_flags, _warning_callback p_warning_callback, void* p_user_context)
+{
+	std::unique_ptr<stream_decoder> t_decoder;
+	decoder_kind t_kind;
+
+	clear();
+
+	if(p_warning_callback == nullptr) p_warning_callback = DefaultWarningHandler;
+
+	format::_Warning_Def		t_warn;
+	t_warn._error_context			= &m_last_error;
+	t_warn._user_context			= p_user_context;
+	t_warn._user_warning_callback	= p_warning_callback;
+
+	Error t_err = open_document(p_stream, p_flags, t_warn, m_document_properties, t_decoder, t_kind);
+	if(t_err != Error::None)
+	{
+		return t_err;
+	}
+
+	//chooses the formater version to use
+	switch(m_document_properties.version)
+	{
+		case 1: //start decoding based on version
+		{
+			//reported items are not kept, so there is nothing to expand later
+			if((p_flags & Flag::DeferGroups) == Flag{} || p_handler != nullptr)
+			{
+				p_source.reset();
+			}
+			else if(!p_source)
+			{
+				p_source = std::make_shared<_p::deferred_source>();
+			}
+
+			t_kind.load_v1(m_rootObject, *t_decoder, p_flags, m_document_properties.version, t_warn, format::v1::load_options{p_handler, p_filter, p_source ? p_source->m_id : 0, p_handler ? nullptr : resource(), symbols(p_flags)});
+
+			if(p_source)
+			{
+				p_source->m_decoder			= std::move(t_decoder);
+				p_source->m_make			= t_kind.decoder;
+				p_source->m_expand			= t_kind.expand_v1;
+				p_source->m_flags			= p_flags;
+				p_source->m_callback		= p_warning_callback;
+				p_source->m_user_context	= p_user_context;
+				m_deferred = std::move(p_source);
+			}
+			break;
+		}
+		default: //cosmic rays maybe?
+			_p::Danger_Action::publicError(m_last_error).SetPlainError(Error::UnknownInternal);
+			break;
+	}
+
+	return m_last_error.error_code();
+}
+
+Error document::expand(group& p_group)
+{
+	const _p::deferred_body& t_body = _p::Danger_Action::deferred(p_group);
+	if(t_body.source == 0)
+	{
+		return Error::None;
+	}
+
+	m_last_error.clear();
+	if(!m_deferred || m_deferred->m_id != t_body.source)
+	{
+		_p::Danger_Action::publicError(m_last_error).SetPlainError(Error::Unable2Read);
+		return m_last_error.error_code();
+	}
+
+	format::_Warning_Def		t_warn;
+	t_warn._error_context			= &m_last_error;
+	t_warn._user_context			= m_deferred->m_user_context;
+	t_warn._user_warning_callback	= m_deferred->m_callback;
+
+	m_deferred->m_expand(p_group, *m_deferred->m_decoder, m_deferred->m_flags, t_warn, m_deferred->m_id, resource(), symbols(m_deferred->m_flags));
+
+	return m_last_error.error_code();
+}
+
+Error document::load_parallel(const std::filesystem::path& p_file, Flag p_flags, uint32_t p_threads, _warning_callback p_warning_callback, void* p_user_context)
+{
+	core::file_read f_reader;
+	std::unique_ptr<base_istreamer> t_reader;
+	if(open_file(p_file, f_reader, t_reader))
+	{
+		return load_parallel(*t_reader, p_flags, p_threads, p_warning_callback, p_user_context);
+	}
+	clear();
+	_p::Danger_Action::publicError(m_last_error).SetPlainError(Error::FileNotFound);
+
+	return m_last_error.error_code();
+}
+
+namespace
+{
+	//Warnings from different threads reach the user one at a time
+	struct shared_warning
+	{
+		std::mutex			m_lock;
+		_warning_callback	m_callback;
+		void*				m_user_context;
+
+		static warningBehaviour notify(const Error_Context& p_context, void* p_shared)
+		{
+			shared_warning& t_shared = *static_cast<shared_warning*>(p_shared);
+			std::lock_guard t_guard{t_shared.m_lock};
+			return t_shared.m_callback(p_context, t_shared.m_user_context);
+		}
+	};
+
+	struct group_task
+	{
+		group*			m_group;
+		Error_Context	m_error;
+	};
+} //namespace
+
+Error document::load_parallel(base_istreamer& p_stream, Flag p_flags, uint32_t p_threads, _warning_callback p_warning_callback, void* p_user_context)
+{
+	const std::span<const char8_t> t_view = p_stream.contiguous_view();
+	const uint64_t t_base = p_stream.pos();
+
+	//more threads than cores only adds switching, with a single core this is a plain load
+	const uint32_t t_cores = std::thread::hardware_concurrency();
+	if(p_threads == 0 || (t_cores != 0 && p_threads > t_cores))
+	{
+		p_threads = std::max(t_cores, 1u);
+	}
+
+	//nothing to split the work with, or not asked to
+	if(t_view.empty() || p_threads == 1 || (p_flags & Flag::DeferGroups) != Flag{})
+	{
+		return _load(p_stream, nullptr, nullptr, nullptr, p_flags, p_warning_callback, p_user_context);
+	}
+
+	//1st pass, top level items are read and group bodies are only scanned for their end
+	//Note: Even if it fails, the bodies before the failure may fail earlier
+	const Error t_err = _load(p_stream, nullptr, nullptr, nullptr, p_flags | Flag::DeferGroups, p_warning_callback, p_user_context);
+	const std::shared_ptr<_p::deferred_source> t_source = std::move(m_deferred);
+	if(!t_source)
+	{
+		return t_err;
+	}
+
+	std::vector<group_task> t_tasks;
+	for(const itemProxy<item>& t_item : m_rootObject)
+	{
+		if(t_item->type() == ItemType::group)
+		{
+			group& t_group = static_cast<group&>(*t_item);
+			_p::deferred_body& t_body = _p::Danger_Action::deferred(t_group);
+			if(t_body.source != t_source->m_id) continue;
+			//the views read by the tasks start where the stream was
+			t_body.offset -= t_base;
+			t_tasks.push_back(group_task{&t_group, {}});
+		}
+	}
+
+	//2nd pass, group bodies are read in parallel, each thread with its own view of the data
+	shared_warning t_shared{{}, t_source->m_callback, t_source->m_user_context};
+	std::atomic<uintptr_t> t_next{0};
+
+	//each thread makes items from its own arena, monotonic arenas are not thread safe
+	_p::symbol_table* const t_symbols = symbols(t_source->m_flags);
+	const auto t_work = [&](const std::shared_ptr<std::pmr::memory_resource>& p_arena)
+	{
+		buffer_istream t_stream{t_view.data(), t_view.size()};
+		std::unique_ptr<stream_decoder> t_decoder = t_source->m_make(t_stream);
+		for(uintptr_t i = t_next++; i < t_tasks.size(); i = t_next++)
+		{
+			format::_Warning_Def t_warn;
+			t_warn._error_context			= &t_tasks[i].m_error;
+			t_warn._user_context			= &t_shared;
+			t_warn._user_warning_callback	= shared_warning::notify;
+			//groups in the body are read as well
+			t_source->m_expand(*t_tasks[i].m_group, *t_decoder, t_source->m_flags, t_warn, 0, p_arena, t_symbols);
+		}
+	};
+
+	{
+		std::vector<std::jthread> t_threads;
+		const uintptr_t t_count = std::min<uintptr_t>(p_threads, t_tasks.size());
+		for(uintptr_t i = 1; i < t_count; ++i)
+		{
+			t_threads.emplace_back(t_work, add_arena());
+		}
+		t_work(resource());
+	}
+
+	//same outcome as a sequential load, which would have stopped at the first group that failed
+	for(const group_task& t_task : t_tasks)
+	{
+		if(t_task.m_error.error_code() != Error::None)
+		{
+			m_last_error = t_task.m_error;
+			const auto t_failed = std::find_if(m_rootObject.begin(), m_rootObject.end(), [&t_task](const itemProxy<item>& p_item) { return p_item.get() == t_task.m_group; });
+			m_rootObject.erase(t_failed + 1, m_rootObject.end());
+			break;
+		}
 	}
 
 	return m_last_error.error_code();
@@ -484,9 +909,137 @@ Error document::save(base_ostreamer& p_stream, Flag p_flags, uint16_t p_version,
 				_p::Danger_Action::publicError(m_last_error).SetPlainError(Error::UnknownInternal);
 				break;
 		}
+
+		//write out whatever is still buffered, even if the save failed midway
+		if(t_encoder->flush() != stream_error::None && m_last_error.error_code() == Error::None)
+		{
+			_p::Danger_Action::publicError(m_last_error).SetPlainError(Error::Unable2Write);
+		}
 	}
 
 	return m_last_error.error_code();
 }
 
+
+//======== reader
+
+reader::reader() = default;
+reader::~reader() = default;
+
+void reader::close()
+{
+	m_cursor.reset();
+	m_fileStream.reset();
+	m_file.close();
+	m_document_properties.version	= __SCEF_NO_VERSION;
+	m_document_properties.encoding	= Encoding::Unspecified;
+	m_last_error.clear();
+}
+
+Error reader::open(const std::filesystem::path& p_file, Flag p_flags, _warning_callback p_warning_callback, void* p_user_context)
+{
+	close();
+	if(!open_file(p_file, m_file, m_fileStream))
+	{
+		_p::Danger_Action::publicError(m_last_error).SetPlainError(Error::FileNotFound);
+		return Error::FileNotFound;
+	}
+
+	return start(*m_fileStream, p_flags, p_warning_callback, p_user_context);
+}
+
+Error reader::open(base_istreamer& p_stream, Flag p_flags, _warning_callback p_warning_callback, void* p_user_context)
+{
+	close();
+	return start(p_stream, p_flags, p_warning_callback, p_user_context);
+}
+
+Error reader::start(base_istreamer& p_stream, Flag p_flags, _warning_callback p_warning_callback, void* p_user_context)
+{
+	if(p_warning_callback == nullptr) p_warning_callback = DefaultWarningHandler;
+
+	format::_Warning_Def		t_warn;
+	t_warn._error_context			= &m_last_error;
+	t_warn._user_context			= p_user_context;
+	t_warn._user_warning_callback	= p_warning_callback;
+
+	std::unique_ptr<stream_decoder> t_decoder;
+	decoder_kind t_kind;
+
+	Error t_err = open_document(p_stream, p_flags, t_warn, m_document_properties, t_decoder, t_kind);
+	if(t_err != Error::None)
+	{
+		return t_err;
+	}
+
+	switch(m_document_properties.version)
+	{
+		case 1:
+			m_cursor = t_kind.cursor_v1(std::move(t_decoder), p_flags, t_warn);
+			break;
+		default:
+			_p::Danger_Action::publicError(m_last_error).SetPlainError(Error::UnknownInternal);
+			return Error::UnknownInternal;
+	}
+
+	m_last_error.clear();
+	return Error::None;
+}
+
+bool reader::next()
+{
+	return m_cursor && m_cursor->next();
+}
+
+bool reader::skip_group()
+{
+	return m_cursor && m_cursor->skip_group();
+}
+
+reader::token reader::kind() const
+{
+	return m_cursor ? m_cursor->m_kind : token::none;
+}
+
+const item* reader::current() const
+{
+	return m_cursor ? m_cursor->m_item : nullptr;
+}
+
+uintptr_t reader::depth() const
+{
+	return m_cursor ? m_cursor->m_depth : 0;
+}
+
+std::u32string_view reader::name() const
+{
+	switch(kind())
+	{
+		case token::group_begin:
+		case token::group_end:
+			return static_cast<const group*>(m_cursor->m_item)->view_name();
+		case token::key_value:
+			return static_cast<const keyedValue*>(m_cursor->m_item)->view_name();
+		case token::singlet:
+			return static_cast<const singlet*>(m_cursor->m_item)->view_name();
+		default:
+			break;
+	}
+	return {};
+}
+
+std::u32string_view reader::value() const
+{
+	switch(kind())
+	{
+		case token::key_value:
+			return static_cast<const keyedValue*>(m_cursor->m_item)->view_value();
+		case token::comment:
+			return static_cast<const comment*>(m_cursor->m_item)->view();
+		default:
+			break;
+	}
+	return {};
+}
+
 }	// namespace scef
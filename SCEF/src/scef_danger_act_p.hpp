@@ -37,12 +37,12 @@ namespace scef::_p
 class Danger_Action
 {
 public:
-	static inline void move_spacing(lineSpace& p_spacing, std::u8string& p_string)
+	static inline void move_spacing(lineSpace& p_spacing, std::pmr::u8string& p_string)
 	{
 		p_spacing._space = std::move(p_string);
 	}
 
-	static inline void move_spacing(multiLineSpace& p_spacing, std::u8string& p_string)
+	static inline void move_spacing(multiLineSpace& p_spacing, std::pmr::u8string& p_string)
 	{
 		p_spacing._space = std::move(p_string);
 	}
@@ -54,6 +54,8 @@ public:
 
 	static inline _Error_Context& publicError(Error_Context& p_obj) { return p_obj; }
 
+	static inline deferred_body& deferred(group& p_group) { return p_group.m_deferred; }
+
 };
 
 } //namespace scef::_p
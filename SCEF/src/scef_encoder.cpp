@@ -26,8 +26,9 @@
 //======== ======== ======== ======== ======== ======== ======== ========
 
 #include "scef_encoder.hpp"
+#include "scef_transcode.hpp"
 
-#include <span>
+#include <algorithm>
 
 #include <CoreLib/core_endian.hpp>
 #include <CoreLib/string/core_string_encoding.hpp>
@@ -35,384 +36,220 @@
 namespace scef
 {
 
-stream_decoder::~stream_decoder() = default;
-
-//======== ======== class: Stream_Decoder ======== ========
-stream_error stream_decoder::read_while(read_f p_user_cb, void* p_context)
+//======== ======== class: istream_buffer ======== ========
+void istream_buffer::refill(uintptr_t p_size)
 {
-	while(true)
+	if(!m_direct && m_pivot == m_last)
 	{
-		if(m_lastChar == '\n') nextLine();
-		result_t res = v_get_char();
-		if(!res.has_value())
+		const std::span<const char8_t> t_view = m_reader.contiguous_view();
+		if(!t_view.empty())
 		{
-			m_lastChar = 0;
-			return res.error_code();
+			m_lastOffset = m_reader.pos() + t_view.size();
+			m_reader.set_pos(m_lastOffset);
+			m_pivot		= t_view.data();
+			m_last		= t_view.data() + t_view.size();
+			m_direct	= true;
 		}
-		m_lastChar = res.value();
-		bool should_continue = p_user_cb(res.value(), p_context);
-		++m_column;
-		if(!should_continue) return stream_error::None;
 	}
-}
 
+	//nothing follows the view
+	if(m_direct) return;
 
-stream_decoder::result_t stream_decoder::get_char()
-{
-	if(m_lastChar == '\n') nextLine();
-	result_t res = v_get_char();
-	m_lastChar = res.value();
-	++m_column;
-	return res;
-}
+	if(!m_buffer)
+	{
+		m_buffer = std::make_unique_for_overwrite<char8_t[]>(block_size);
+		m_pivot = m_last = m_buffer.get();
+	}
 
+	//keep what is left, and top up the rest of the block
+	const uintptr_t left = static_cast<uintptr_t>(m_last - m_pivot);
+	char8_t* const first = m_buffer.get();
+	if(left) memmove(first, m_pivot, left);
+	m_pivot	= first;
+	m_last	= first + left;
 
-stream_encoder::~stream_encoder() = default;
-
-namespace ENCODER_P
-{
-//---- Decoders ----
-
-stream_decoder::result_t Stream_ANSI_Decoder::v_get_char()
-{
-	char8_t r;
-	if(m_reader.read(&r, 1) != 1)
+	while(static_cast<uintptr_t>(m_last - m_pivot) < p_size)
 	{
-		return m_reader.stat() == stream_error::Control_EndOfStream ? stream_error::Control_EndOfStream : stream_error::Unable2Read;
+		const uintptr_t count = m_reader.read(first + (m_last - first), block_size - static_cast<uintptr_t>(m_last - first));
+		if(count == 0) break;
+		m_last += count;
+		m_lastOffset += count;
 	}
-	return static_cast<char32_t>(r);
 }
 
-
-static inline stream_error extract_utf8_layers(base_istreamer& p_reader, std::span<char8_t> p_buffer)
+uintptr_t istream_buffer::underflow(void* p_buffer, uintptr_t p_size)
 {
-	uintptr_t count = p_reader.read(p_buffer.data(), p_buffer.size());
+	refill(p_size);
 
-	if(count != p_buffer.size())
-	{
-		if(p_reader.stat() == stream_error::Control_EndOfStream)
-		{
-			for(uintptr_t it = 0; it < count; ++it)
-			{
-				if((p_buffer[it] & 0xC0) != 0x80)
-				{
-					p_reader.set_pos(p_reader.pos() - p_buffer.size() - it);
-				}
-			}
-			return stream_error::BadEncoding;
-		}
-		return stream_error::Unable2Read;
-	}
+	const uintptr_t available = static_cast<uintptr_t>(m_last - m_pivot);
+	if(available < p_size) p_size = available;
+	memcpy(p_buffer, m_pivot, p_size);
+	m_pivot += p_size;
+	return p_size;
+}
 
-	for(uintptr_t it = 0; it < count; ++it)
-	{
-		if((p_buffer[it] & 0xC0) != 0x80)
-		{
-			p_reader.set_pos(p_reader.pos() - (p_buffer.size() - it));
-			return stream_error::BadEncoding;
-		}
-	}
-	return stream_error::None;
+stream_decoder::~stream_decoder() = default;
+
+//======== ======== class: Stream_Decoder ======== ========
+uintptr_t stream_decoder::v_get_bulk(char32_t*, uintptr_t)
+{
+	return 0;
 }
 
-stream_decoder::result_t Stream_UTF8_Decoder::v_get_char()
+
+//======== ======== class: ostream_buffer ======== ========
+stream_error ostream_buffer::make_room()
 {
-	char8_t r;
-	if(m_reader.read(&r, 1) != 1)
+	if(!m_buffer)
 	{
-		return (m_reader.stat() == stream_error::Control_EndOfStream) ? stream_error::Control_EndOfStream : stream_error::Unable2Read;
+		m_buffer = std::make_unique_for_overwrite<char8_t[]>(block_size);
+		m_last	= m_buffer.get();
+		m_end	= m_last + block_size;
 	}
 
-	if(r & 0x80)
-	{
-		if((r & 0xC0) == 0x80) return stream_error::BadEncoding;
-		if((r & 0xE0) == 0xC0)	//level 1
-		{
-			char8_t r1;
-			if(m_reader.read(&r1, 1) != 1)	return (m_reader.stat() == stream_error::Control_EndOfStream) ? stream_error::BadEncoding : stream_error::Unable2Read;
-			if((r1 & 0xC0) != 0x80)
-			{
-				m_reader.set_pos(m_reader.pos() - 1);
-				return stream_error::BadEncoding;
-			}
-			return
-				((char32_t{r} &0x1F) << 6) |
-				( char32_t{r1} &0x3F);
-		}
-		if((r & 0xF0) == 0xE0) //level 2
-		{
-			char8_t r1[2];
-			stream_error ret = extract_utf8_layers(m_reader, std::span<char8_t>{r1, 2});
-			if(ret != stream_error::None) return ret;
-			return
-				((char32_t{r} & 0x0F) << 12) |
-				((char32_t{r1[0]} & 0x3F) << 6) |
-				( char32_t{r1[1]} & 0x3F);
-		}
-		if((r & 0xF8) == 0xF0) //level 3
-		{
-			char8_t r1[3];
-			stream_error ret = extract_utf8_layers(m_reader, std::span<char8_t>{r1, 3});
-			if(ret != stream_error::None) return ret;
-			//todo code point validation
-			return ((char32_t{r} & 0x07) << 18) | ((char32_t{r1[0]} & 0x3F) << 12) | ((char32_t{r1[1]} & 0x3F) << 6) | (char32_t{r1[2]} & 0x3F);
-		}
-		if((r & 0xFC) == 0xF8) //level 4
-		{
-			char8_t r1[4];
-			stream_error ret = extract_utf8_layers(m_reader, std::span<char8_t>{r1, 4});
-			if(ret != stream_error::None) return ret;
-
-			return
-				((char32_t{r} & 0x03) << 24) |
-				((char32_t{r1[0]} & 0x3F) << 18) |
-				((char32_t{r1[1]} & 0x3F) << 12) |
-				((char32_t{r1[2]} & 0x3F) << 6) |
-				( char32_t{r1[3]} & 0x3F);
-		}
-		if((r & 0xFE) == 0xFC) //level 5
-		{
-			char8_t r1[5];
-			stream_error ret = extract_utf8_layers(m_reader, std::span<char8_t>{r1, 5});
-			if(ret != stream_error::None) return ret;
-
-			return
-				((char32_t{r} & 0x03) << 30) |
-				((char32_t{r1[0]} & 0x3F) << 24) |
-				((char32_t{r1[1]} & 0x3F) << 18) |
-				((char32_t{r1[2]} & 0x3F) << 12) |
-				((char32_t{r1[3]} & 0x3F) << 6) |
-				( char32_t{r1[4]} & 0x3F);
-		}
-		if((r & 0xFF) == 0xFE) //level 6
-		{
-			char8_t r1[6];
-			stream_error ret = extract_utf8_layers(m_reader, std::span<char8_t>{r1, 6});
-			if(ret != stream_error::None) return ret;
-
-			if((r1[0] & 0x3F) > 0x03) return stream_error::BadEncoding;
-
-			return
-				((char32_t{r1[0]} & 0x03) << 30) |
-				((char32_t{r1[1]} & 0x3F) << 24) |
-				((char32_t{r1[2]} & 0x3F) << 18) |
-				((char32_t{r1[3]} & 0x3F) << 12) |
-				((char32_t{r1[4]} & 0x3F) << 6) |
-				( char32_t{r1[5]} & 0x3F);
-		}
-		return stream_error::BadEncoding;
-	}
-	return static_cast<char32_t>(r);
+	return flush();
 }
 
-stream_decoder::result_t Stream_UTF8_Decoder_s::v_get_char()
+stream_error ostream_buffer::overflow(const void* p_buffer, uintptr_t p_size)
 {
-	char8_t r;
-	if(m_reader.read(&r, 1) != 1)
-	{
-		return (m_reader.stat() == stream_error::Control_EndOfStream) ? stream_error::Control_EndOfStream : stream_error::Unable2Read;
-	}
+	stream_error ret = make_room();
+	if(ret != stream_error::None) return ret;
 
-	if(r & 0x80)
+	if(p_size >= block_size)
 	{
-		if((r & 0xC0) == 0x80) return stream_error::BadEncoding;
-		if((r & 0xE0) == 0xC0) //level 1
-		{
-			char8_t r1;
-			if(m_reader.read(&r1, 1) != 1)	return (m_reader.stat() == stream_error::Control_EndOfStream) ? stream_error::BadEncoding : stream_error::Unable2Read;
-			if((r1 & 0xC0) != 0x80)
-			{
-				m_reader.set_pos(m_reader.pos() - 1);
-				return stream_error::BadEncoding;
-			}
-
-			if(((r & 0x1F) < 0x02)) return stream_error::BadEncoding;
-			return
-				((char32_t{r} &0x1F) << 6) |
-				( char32_t{r1} &0x3F);
-		}
-		if((r & 0xF0) == 0xE0) //level 2
-		{
-			char8_t r1[2];
-			stream_error ret = extract_utf8_layers(m_reader, std::span<char8_t>{r1, 2});
-			if(ret != stream_error::None) return ret;
-
-			if((r & 0x0F) == 0 && (r1[0] & 0x3F) < 0x20) return stream_error::BadEncoding;
-			return
-				((char32_t{r} & 0x0F) << 12) |
-				((char32_t{r1[0]} & 0x3F) << 6) |
-				( char32_t{r1[1]} & 0x3F);
-		}
-		if((r & 0xF8) == 0xF0) //level 3
-		{
-			char8_t r1[3];
-			stream_error ret = extract_utf8_layers(m_reader, std::span<char8_t>{r1, 3});
-			if(ret != stream_error::None) return ret;
-
-			if((r & 0x07) == 0 && (r1[0] & 0x3F) < 0x10) return stream_error::BadEncoding;
-			return ((char32_t{r} & 0x07) << 18) | ((char32_t{r1[0]} & 0x3F) << 12) | ((char32_t{r1[1]} & 0x3F) << 6) | (char32_t{r1[2]} & 0x3F);
-		}
-		if((r & 0xFC) == 0xF8) //level 4
-		{
-			char8_t r1[4];
-			stream_error ret = extract_utf8_layers(m_reader, std::span<char8_t>{r1, 4});
-			if(ret != stream_error::None) return ret;
-		}
-		else if((r & 0xFE) == 0xFC) //level 5
-		{
-			char8_t r1[5];
-			stream_error ret = extract_utf8_layers(m_reader, std::span<char8_t>{r1, 5});
-			if(ret != stream_error::None) return ret;
-		}
-		else if((r & 0xFF) == 0xFE) //level 6
-		{
-			char8_t r1[6];
-			stream_error ret = extract_utf8_layers(m_reader, std::span<char8_t>{r1, 6});
-			if(ret != stream_error::None) return ret;
-		}
-		return stream_error::BadEncoding;
+		return m_writer.write(p_buffer, p_size);
 	}
-	return static_cast<char32_t>(r);
+	memcpy(m_last, p_buffer, p_size);
+	m_last += p_size;
+	return stream_error::None;
 }
 
-stream_decoder::result_t Stream_UTF16LE_Decoder::v_get_char()
+stream_error ostream_buffer::flush()
 {
-	char16_t r;
-	uintptr_t t_col = m_reader.read(reinterpret_cast<void*>(&r), 2);
-	if(t_col != 2)
-	{
-		if(m_reader.stat() == stream_error::Control_EndOfStream)
-		{
-			return (t_col == 0) ? stream_error::Control_EndOfStream : stream_error::BadEncoding;
-		}
-		return stream_error::Unable2Read;
-	}
+	char8_t* const first = m_buffer.get();
+	if(m_last == first) return stream_error::None;
 
-	r = core::endian_little2host(r);
+	const uintptr_t size = static_cast<uintptr_t>(m_last - first);
+	m_last = first;
+	return m_writer.write(first, size);
+}
 
-	if(r > 0xD7FF && r < 0xE000)
-	{
-		if((r & 0xFC00) != 0xD800) return stream_error::BadEncoding;
+stream_encoder::~stream_encoder() = default;
 
-		char16_t r1;
+namespace ENCODER_P
+{
+//---- Encoders ----
 
-		t_col  = m_reader.read(reinterpret_cast<void*>(&r1), 2);
+//encodes straight into the writer's buffer, only going through core::encode_UTF8 for what UCS4_to_UTF8 does not take
+static stream_error put_UTF8(ostream_buffer& p_writer, std::u32string_view p_string)
+{
+	std::array<char8_t, 4> temp;
+	while(!p_string.empty())
+	{
+		const std::span<char8_t> t_out = p_writer.window(temp.size());
+		if(t_out.empty()) return stream_error::Unable2Write;
 
-		if(t_col != 2) return (m_reader.stat() == stream_error::Control_EndOfStream) ? stream_error::BadEncoding : stream_error::Unable2Read;
+		const transcode_result res = UCS4_to_UTF8(p_string.data(), p_string.size(), t_out.data(), t_out.size());
+		p_writer.commit(res.produced);
+		p_string.remove_prefix(res.consumed);
 
-		r1 = core::endian_little2host(r1);
-		if((r1 & 0xFC00) != 0xDC0)
+		if(res.consumed == 0)
 		{
-			m_reader.set_pos(m_reader.pos() - 2);
-			return stream_error::BadEncoding;
+			if(p_writer.write(temp.data(), core::encode_UTF8(p_string.front(), temp)) != stream_error::None) return stream_error::Unable2Write;
+			p_string.remove_prefix(1);
 		}
-		return (((char32_t{r} & 0x03FF) << 10) | (char32_t{r1} & 0x03FF)) + 0x10000;
 	}
-	return static_cast<char32_t>(r);
+	return stream_error::None;
 }
 
-stream_decoder::result_t Stream_UTF16BE_Decoder::v_get_char()
+//same as put_UTF8, falls back to core::encode_UTF16 for what UCS4_to_UTF16LE/BE does not take
+template<bool t_big>
+static stream_error put_UTF16(ostream_buffer& p_writer, std::u32string_view p_string)
 {
-	char16_t r;
-	uintptr_t t_col = m_reader.read(reinterpret_cast<void*>(&r), 2);
-	if(t_col != 2)
+	std::array<char16_t, 2> temp;
+	while(!p_string.empty())
 	{
-		if(m_reader.stat() == stream_error::Control_EndOfStream)
-		{
-			return (t_col == 0) ? stream_error::Control_EndOfStream : stream_error::BadEncoding;
-		}
-		return stream_error::Unable2Read;
-	}
-
-	r = core::endian_big2host(r);
-
-	if(r > 0xD7FF && r < 0xE000)
-	{
-		if((r & 0xFC00) != 0xD800) return stream_error::BadEncoding;
-
-		char16_t r1;
+		const std::span<char8_t> t_out = p_writer.window(sizeof(temp));
+		if(t_out.empty()) return stream_error::Unable2Write;
 
-		t_col  = m_reader.read(reinterpret_cast<void*>(&r1), 2);
+		const transcode_result res = t_big ?
+			UCS4_to_UTF16BE(p_string.data(), p_string.size(), t_out.data(), t_out.size()):
+			UCS4_to_UTF16LE(p_string.data(), p_string.size(), t_out.data(), t_out.size());
+		p_writer.commit(res.produced);
+		p_string.remove_prefix(res.consumed);
 
-		if(t_col != 2) return (m_reader.stat() == stream_error::Control_EndOfStream) ? stream_error::BadEncoding : stream_error::Unable2Read;
-
-		r1 = core::endian_big2host(r1);
-		if((r1 & 0xFC00) != 0xDC0)
+		if(res.consumed == 0)
 		{
-			m_reader.set_pos(m_reader.pos() - 2);
-			return stream_error::BadEncoding;
+			const uint8_t ret = core::encode_UTF16(p_string.front(), temp);
+			for(uint8_t it = 0; it < ret; ++it)
+			{
+				temp[it] = t_big ? core::endian_host2big(temp[it]) : core::endian_host2little(temp[it]);
+			}
+			if(p_writer.write(temp.data(), ret * sizeof(char16_t)) != stream_error::None) return stream_error::Unable2Write;
+			p_string.remove_prefix(1);
 		}
-		return (((char32_t{r} & 0x03FF) << 10) | (char32_t{r1} & 0x03FF)) + 0x10000;
 	}
-	return static_cast<char32_t>(r);
+	return stream_error::None;
 }
 
-stream_decoder::result_t Stream_UCS4LE_Decoder::v_get_char()
+template<bool t_big>
+static stream_error put_flat_UTF16(ostream_buffer& p_writer, std::u8string_view p_string)
 {
-	char32_t r;
-	uintptr_t t_col = m_reader.read(reinterpret_cast<void*>(&r), 4);
-	if(t_col != 4)
+	while(!p_string.empty())
 	{
-		if(m_reader.stat() == stream_error::Control_EndOfStream)
-		{
-			return (t_col == 0) ? stream_error::Control_EndOfStream : stream_error::BadEncoding;
-		}
-		return stream_error::Unable2Read;
-	}
-	return core::endian_little2host(r);
-}
+		const std::span<char8_t> t_out = p_writer.window(sizeof(char16_t));
+		if(t_out.empty()) return stream_error::Unable2Write;
 
-stream_decoder::result_t Stream_UCS4LE_Decoder_s::v_get_char()
-{
-	char32_t r;
-	uintptr_t t_col = m_reader.read(reinterpret_cast<void*>(&r), 4);
-	if(t_col != 4)
-	{
-		if(m_reader.stat() == stream_error::Control_EndOfStream)
+		const uintptr_t count = std::min<uintptr_t>(p_string.size(), t_out.size() / sizeof(char16_t));
+		for(uintptr_t it = 0; it < count; ++it)
 		{
-			return (t_col == 0) ? stream_error::Control_EndOfStream : stream_error::BadEncoding;
+			t_out[it * 2 + (t_big ? 1 : 0)] = p_string[it];
+			t_out[it * 2 + (t_big ? 0 : 1)] = 0;
 		}
-		return stream_error::Unable2Read;
+		p_writer.commit(count * sizeof(char16_t));
+		p_string.remove_prefix(count);
 	}
-	r = core::endian_little2host(r);
-	if(core::UNICODE_Compliant(r)) return r;
-	return stream_error::BadEncoding;
+	return stream_error::None;
 }
 
-stream_decoder::result_t Stream_UCS4BE_Decoder::v_get_char()
+template<bool t_big>
+static stream_error put_UCS4(ostream_buffer& p_writer, std::u32string_view p_string)
 {
-	char32_t r;
-	uintptr_t t_col = m_reader.read(reinterpret_cast<void*>(&r), 4);
-	if(t_col != 4)
+	while(!p_string.empty())
 	{
-		if(m_reader.stat() == stream_error::Control_EndOfStream)
-		{
-			return (t_col == 0) ? stream_error::Control_EndOfStream : stream_error::BadEncoding;
-		}
-		return stream_error::Unable2Read;
+		const std::span<char8_t> t_out = p_writer.window(sizeof(char32_t));
+		if(t_out.empty()) return stream_error::Unable2Write;
+
+		const transcode_result res = t_big ?
+			UCS4_to_UCS4BE(p_string.data(), p_string.size(), t_out.data(), t_out.size()):
+			UCS4_to_UCS4LE(p_string.data(), p_string.size(), t_out.data(), t_out.size());
+		p_writer.commit(res.produced);
+		p_string.remove_prefix(res.consumed);
 	}
-	return core::endian_big2host(r);
+	return stream_error::None;
 }
 
-stream_decoder::result_t Stream_UCS4BE_Decoder_s::v_get_char()
+template<bool t_big>
+static stream_error put_flat_UCS4(ostream_buffer& p_writer, std::u8string_view p_string)
 {
-	char32_t r;
-	uintptr_t t_col = m_reader.read(reinterpret_cast<void*>(&r), 4);
-	if(t_col != 4)
+	while(!p_string.empty())
 	{
-		if(m_reader.stat() == stream_error::Control_EndOfStream)
+		const std::span<char8_t> t_out = p_writer.window(sizeof(char32_t));
+		if(t_out.empty()) return stream_error::Unable2Write;
+
+		const uintptr_t count = std::min<uintptr_t>(p_string.size(), t_out.size() / sizeof(char32_t));
+		for(uintptr_t it = 0; it < count; ++it)
 		{
-			return (t_col == 0) ? stream_error::Control_EndOfStream : stream_error::BadEncoding;
+			char8_t* const out = t_out.data() + it * 4;
+			out[0] = out[1] = out[2] = out[3] = 0;
+			out[t_big ? 3 : 0] = p_string[it];
 		}
-		return stream_error::Unable2Read;
+		p_writer.commit(count * sizeof(char32_t));
+		p_string.remove_prefix(count);
 	}
-	r = core::endian_big2host(r);
-	if(core::UNICODE_Compliant(r)) return r;
-	return stream_error::BadEncoding;
+	return stream_error::None;
 }
 
-//---- Encoders ----
-
 //======== ======== class:  ======== ========
 stream_error Stream_ANSI_Encoder::put_control(char8_t p_char)
 {
@@ -457,12 +294,7 @@ stream_error Stream_UTF8_Encoder::put_control(char8_t p_char)
 
 stream_error Stream_UTF8_Encoder::put_sequence(std::u32string_view p_string)
 {
-	std::array<char8_t, 4> temp;
-	for(char32_t tchar : p_string)
-	{
-		if(m_writer.write(temp.data(), core::encode_UTF8(tchar, temp)) != stream_error::None) return stream_error::Unable2Write;
-	}
-	return stream_error::None;
+	return put_UTF8(m_writer, p_string);
 }
 
 stream_error Stream_UTF8_Encoder::put_flat(std::u8string_view p_string)
@@ -492,12 +324,7 @@ stream_error Stream_UTF8_Encoder_s::put_control(char8_t p_char)
 
 stream_error Stream_UTF8_Encoder_s::put_sequence(std::u32string_view p_string)
 {
-	std::array<char8_t, 4> temp;
-	for(char32_t tchar : p_string)
-	{
-		if(m_writer.write(temp.data(), core::encode_UTF8(tchar, temp)) != stream_error::None) return stream_error::Unable2Write;
-	}
-	return stream_error::None;
+	return put_UTF8(m_writer, p_string);
 }
 
 stream_error Stream_UTF8_Encoder_s::put_flat(std::u8string_view p_string)
@@ -524,29 +351,12 @@ stream_error Stream_UTF16LE_Encoder::put_control(char8_t p_char)
 
 stream_error Stream_UTF16LE_Encoder::put_sequence(std::u32string_view p_string)
 {
-	for(char32_t tchar : p_string)
-	{
-		std::array<char16_t, 2> temp;
-		uint8_t ret = core::encode_UTF16(tchar, temp);
-
-		temp[0] = core::endian_host2little(temp[0]);
-		if(ret == 2)
-		{
-			temp[1] = core::endian_host2little(temp[1]);
-		}
-		if(m_writer.write(temp.data(), ret * sizeof(char16_t)) != stream_error::None) return stream_error::Unable2Write;
-	}
-	return stream_error::None;
+	return put_UTF16<false>(m_writer, p_string);
 }
 
 stream_error Stream_UTF16LE_Encoder::put_flat(std::u8string_view p_string)
 {
-	for(char8_t tchar : p_string)
-	{
-		char16_t temp = core::endian_host2little(static_cast<char16_t>(tchar));
-		if(m_writer.write(&temp, sizeof(char16_t)) != stream_error::None) return stream_error::Unable2Write;
-	}
-	return stream_error::None;
+	return put_flat_UTF16<false>(m_writer, p_string);
 }
 
 bool Stream_UTF16LE_Encoder::requires_escape(std::u32string_view p_string) const
@@ -567,29 +377,12 @@ stream_error Stream_UTF16BE_Encoder::put_control(char8_t p_char)
 
 stream_error Stream_UTF16BE_Encoder::put_sequence(std::u32string_view p_string)
 {
-	for(char32_t tchar : p_string)
-	{
-		std::array<char16_t, 2> temp;
-		const uint8_t ret = core::encode_UTF16(tchar, temp);
-
-		temp[0] = core::endian_host2big(temp[0]);
-		if(ret == 2)
-		{
-			temp[1] = core::endian_host2big(temp[1]);
-		}
-		if(m_writer.write(temp.data(), ret * sizeof(char16_t)) != stream_error::None) return stream_error::Unable2Write;
-	}
-	return stream_error::None;
+	return put_UTF16<true>(m_writer, p_string);
 }
 
 stream_error Stream_UTF16BE_Encoder::put_flat(std::u8string_view p_string)
 {
-	for(char8_t tchar : p_string)
-	{
-		char16_t temp = core::endian_host2big(static_cast<char16_t>(tchar));
-		if(m_writer.write(&temp, sizeof(char16_t)) != stream_error::None) return stream_error::Unable2Write;
-	}
-	return stream_error::None;
+	return put_flat_UTF16<true>(m_writer, p_string);
 }
 
 bool Stream_UTF16BE_Encoder::requires_escape(std::u32string_view p_string) const
@@ -610,22 +403,12 @@ stream_error Stream_UCS4LE_Encoder::put_control(char8_t p_char)
 
 stream_error Stream_UCS4LE_Encoder::put_sequence(std::u32string_view p_string)
 {
-	for(char32_t tchar : p_string)
-	{
-		tchar = core::endian_host2little(tchar);
-		if(m_writer.write(reinterpret_cast<void*>(&tchar), sizeof(char32_t)) != stream_error::None) return stream_error::Unable2Write;
-	}
-	return stream_error::None;
+	return put_UCS4<false>(m_writer, p_string);
 }
 
 stream_error Stream_UCS4LE_Encoder::put_flat(std::u8string_view p_string)
 {
-	for(char8_t lchar : p_string)
-	{
-		char32_t tchar = core::endian_host2little(static_cast<char32_t>(lchar));
-		if(m_writer.write(reinterpret_cast<void*>(&tchar), sizeof(char32_t)) != stream_error::None) return stream_error::Unable2Write;
-	}
-	return stream_error::None;
+	return put_flat_UCS4<false>(m_writer, p_string);
 }
 
 bool Stream_UCS4LE_Encoder::requires_escape(std::u32string_view) const
@@ -648,22 +431,12 @@ stream_error Stream_UCS4LE_Encoder_s::put_control(char8_t p_char)
 
 stream_error Stream_UCS4LE_Encoder_s::put_sequence(std::u32string_view p_string)
 {
-	for(char32_t tchar : p_string)
-	{
-		tchar = core::endian_host2little(tchar);
-		if(m_writer.write(reinterpret_cast<void*>(&tchar), sizeof(char32_t)) != stream_error::None) return stream_error::Unable2Write;
-	}
-	return stream_error::None;
+	return put_UCS4<false>(m_writer, p_string);
 }
 
 stream_error Stream_UCS4LE_Encoder_s::put_flat(std::u8string_view p_string)
 {
-	for(char8_t lchar: p_string)
-	{
-		const char32_t tchar = core::endian_host2little(static_cast<char32_t>(lchar));
-		if(m_writer.write(&tchar, sizeof(char32_t)) != stream_error::None) return stream_error::Unable2Write;
-	}
-	return stream_error::None;
+	return put_flat_UCS4<false>(m_writer, p_string);
 }
 
 bool Stream_UCS4LE_Encoder_s::requires_escape(std::u32string_view p_string) const
@@ -685,22 +458,12 @@ stream_error Stream_UCS4BE_Encoder::put_control(char8_t p_char)
 
 stream_error Stream_UCS4BE_Encoder::put_sequence(std::u32string_view p_string)
 {
-	for(char32_t tchar: p_string)
-	{
-		tchar = core::endian_host2big(tchar);
-		if(m_writer.write(&tchar, sizeof(char32_t)) != stream_error::None) return stream_error::Unable2Write;
-	}
-	return stream_error::None;
+	return put_UCS4<true>(m_writer, p_string);
 }
 
 stream_error Stream_UCS4BE_Encoder::put_flat(std::u8string_view p_string)
 {
-	for(char8_t lchar : p_string)
-	{
-		const char32_t tchar = core::endian_host2big(static_cast<char32_t>(lchar));
-		if(m_writer.write(&tchar, sizeof(char32_t)) != stream_error::None) return stream_error::Unable2Write;
-	}
-	return stream_error::None;
+	return put_flat_UCS4<true>(m_writer, p_string);
 }
 
 bool Stream_UCS4BE_Encoder::requires_escape(std::u32string_view) const
@@ -722,22 +485,12 @@ stream_error Stream_UCS4BE_Encoder_s::put_control(char8_t p_char)
 
 stream_error Stream_UCS4BE_Encoder_s::put_sequence(std::u32string_view p_string)
 {
-	for(char32_t tchar: p_string)
-	{
-		tchar = core::endian_host2big(tchar);
-		if(m_writer.write(&tchar, sizeof(char32_t)) != stream_error::None) return stream_error::Unable2Write;
-	}
-	return stream_error::None;
+	return put_UCS4<true>(m_writer, p_string);
 }
 
 stream_error Stream_UCS4BE_Encoder_s::put_flat(std::u8string_view p_string)
 {
-	for(char8_t lchar : p_string)
-	{
-		const char32_t tchar = core::endian_host2big(static_cast<char32_t>(lchar));
-		if(m_writer.write(&tchar, sizeof(char32_t)) != stream_error::None) return stream_error::Unable2Write;
-	}
-	return stream_error::None;
+	return put_flat_UCS4<true>(m_writer, p_string);
 }
 
 bool Stream_UCS4BE_Encoder_s::requires_escape(std::u32string_view p_string) const
@@ -28,15 +28,122 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
 #include <array>
+#include <bit>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <type_traits>
 
 #include <CoreLib/core_alternate.hpp>
+#include <CoreLib/core_endian.hpp>
+#include <CoreLib/string/core_string_encoding.hpp>
 
 #include <SCEF/scef_stream.hpp>
 
+#include "scef_transcode.hpp"
+
 namespace scef
 {
 
+// Pulls large blocks from a base_istreamer so that decoders can work from memory
+// Note:
+//	1. unread can only step back over bytes returned by the last call to read
+//	2. If the stream provides a contiguous_view, it is used in place and nothing is copied
+class istream_buffer
+{
+public:
+	static constexpr uintptr_t block_size = 0x10000;
+
+	inline istream_buffer(base_istreamer& p_reader): m_reader{p_reader}, m_lastOffset{p_reader.pos()} {}
+
+	[[nodiscard]] inline uintptr_t read(void* p_buffer, uintptr_t p_size)
+	{
+		if(static_cast<uintptr_t>(m_last - m_pivot) < p_size)
+		{
+			return underflow(p_buffer, p_size);
+		}
+		memcpy(p_buffer, m_pivot, p_size);
+		m_pivot += p_size;
+		return p_size;
+	}
+
+	inline void unread(uintptr_t p_size) { m_pivot -= p_size; }
+
+	//bytes available without copying, only refills if there are none
+	[[nodiscard]] inline std::span<const char8_t> peek()
+	{
+		if(m_pivot == m_last) refill(1);
+		return {m_pivot, m_last};
+	}
+
+	inline void skip(uintptr_t p_size) { m_pivot += p_size; }
+
+	[[nodiscard]] inline stream_error stat() const { return m_pivot != m_last ? stream_error::None : m_reader.stat(); }
+
+	//drops buffered data, must be called if the underlying stream is repositioned
+	inline void discard()
+	{
+		m_pivot = m_last = m_buffer.get();
+		m_direct = false;
+		m_lastOffset = m_reader.pos();
+	}
+
+	//position in the stream of the next byte to be read
+	[[nodiscard]] inline uint64_t offset() const { return m_lastOffset - static_cast<uint64_t>(m_last - m_pivot); }
+
+	inline void seek(uint64_t p_offset)
+	{
+		m_reader.set_pos(p_offset);
+		discard();
+	}
+
+private:
+	void refill(uintptr_t p_size);
+	[[nodiscard]] uintptr_t underflow(void* p_buffer, uintptr_t p_size);
+
+	base_istreamer&				m_reader;
+	std::unique_ptr<char8_t[]>	m_buffer;
+	const char8_t*				m_pivot		= nullptr;
+	const char8_t*				m_last		= nullptr;
+	uint64_t					m_lastOffset;			//position in the stream of m_last
+	bool						m_direct	= false;	//m_pivot and m_last point into the stream's contiguous_view
+};
+
+// Set of characters to be consumed by stream_decoder::read_span
+// Code points below 0x80 are looked up in a table, the ones above are either all in or all out
+class char_class
+{
+public:
+	template<typename Pred>
+	static consteval char_class make(Pred p_pred, bool p_high)
+	{
+		char_class ret;
+		ret.m_indexed = p_high;
+		for(char32_t it = 0; it < 0x80; ++it)
+		{
+			ret.m_table[it] = p_pred(it);
+			if(!ret.m_table[it] && !ENCODER_P::is_structural(it)) ret.m_indexed = false;
+		}
+		ret.m_high = p_high;
+		return ret;
+	}
+
+	[[nodiscard]] inline constexpr bool contains(char32_t p_char) const
+	{
+		return p_char < 0x80 ? m_table[p_char] : m_high;
+	}
+
+	//only structural characters can be outside of the class
+	[[nodiscard]] inline constexpr bool indexed() const { return m_indexed; }
+
+private:
+	std::array<bool, 0x80> m_table = {};
+	bool m_high = false;
+	bool m_indexed = false;
+};
+
 // Used to interpret character encoding
 // Ex. ANSI, UTF8, UTF16, UCS4, etc...
 class stream_decoder
@@ -44,38 +151,340 @@ class stream_decoder
 public:
 	using result_t	= core::alternate<char32_t, stream_error, stream_error::None, stream_error::Unable2Read>;
 	using read_f	= bool (*) (char32_t, void*);
+	using span_f	= void (*) (std::u32string_view, void*);
 
 protected:
-	base_istreamer& m_reader;
+	istream_buffer m_reader;
 	[[nodiscard]] virtual result_t v_get_char() = 0;
 
+	//Decodes as many characters as possible from what m_reader has buffered, in one go.
+	//Stops short of anything v_get_char is needed for (errors, sequences split by a refill, end of stream).
+	[[nodiscard]] virtual uintptr_t v_get_bulk(char32_t* p_out, uintptr_t p_size);
+
+	//Decoder is the concrete type of this object, calling into it directly rather than through the vtable
+	//lets the decoding be inlined. Use stream_decoder when the type is not known.
+	template<typename Decoder> [[nodiscard]] result_t		get_char_as();
+	template<typename Decoder> [[nodiscard]] stream_error	read_while_as(read_f p_user_cb, void* p_context);
+	template<typename Decoder> [[nodiscard]] stream_error	read_span_as(const char_class& p_class, span_f p_user_cb, void* p_context);
+
 private:
+	static constexpr uintptr_t decoded_size = 256;
+
 	uint64_t m_column	= 0;
 	uint64_t m_line		= 1;
 	char32_t m_lastChar	= 0;
 
+	//characters decoded ahead by v_get_bulk
+	std::array<char32_t, decoded_size> m_decoded;
+	uintptr_t m_decodedPivot	= 0;
+	uintptr_t m_decodedLast		= 0;
+	uint64_t  m_decodedOffset	= 0;	//position in the stream m_decoded was decoded from, or of the character decoded without it
+
+	//where the structural characters in m_decoded are, only kept up to date if m_indexed
+	std::array<uint64_t, decoded_size / 64> m_structural;
+	bool m_indexed = false;
+
 	inline void nextLine() { m_column = 0; ++m_line; }
 
+	inline void index_decoded()
+	{
+		ENCODER_P::structural_index(m_decoded.data(), m_decodedLast, m_structural.data());
+	}
+
+	//first marked character at or after p_from, m_decodedLast if there is none
+	[[nodiscard]] inline uintptr_t next_structural(uintptr_t p_from) const
+	{
+		const uintptr_t t_words = (m_decodedLast + 63) / 64;
+		uintptr_t t_word = p_from / 64;
+		if(t_word >= t_words) return m_decodedLast;
+		uint64_t t_bits = m_structural[t_word] & (~uint64_t{0} << (p_from % 64));
+		while(t_bits == 0)
+		{
+			if(++t_word == t_words) return m_decodedLast;
+			t_bits = m_structural[t_word];
+		}
+		return t_word * 64 + static_cast<uintptr_t>(std::countr_zero(t_bits));
+	}
+
+	template<typename Decoder>
+	[[nodiscard]] inline result_t decode_char()
+	{
+		if constexpr(std::is_same_v<Decoder, stream_decoder>) return v_get_char();
+		else return static_cast<Decoder*>(this)->Decoder::v_get_char();
+	}
+
+	template<typename Decoder>
+	[[nodiscard]] inline uintptr_t decode_bulk()
+	{
+		if constexpr(std::is_same_v<Decoder, stream_decoder>) return v_get_bulk(m_decoded.data(), decoded_size);
+		else return static_cast<Decoder*>(this)->Decoder::v_get_bulk(m_decoded.data(), decoded_size);
+	}
+
+	template<typename Decoder>
+	inline void refill_decoded()
+	{
+		m_decodedOffset	= m_reader.offset();
+		m_decodedPivot	= 0;
+		m_decodedLast	= decode_bulk<Decoder>();
+		if(m_indexed) index_decoded();
+	}
+
+	template<typename Decoder>
+	[[nodiscard]] inline result_t next_char()
+	{
+		if(m_decodedPivot == m_decodedLast)
+		{
+			refill_decoded<Decoder>();
+			if(m_decodedLast == 0) return decode_char<Decoder>();
+		}
+		return m_decoded[m_decodedPivot++];
+	}
+
 public:
+	//where lastChar was read from, reading can resume from there with resume
+	struct mark_t
+	{
+		uint64_t	offset;	//a character boundary in the stream, before lastChar
+		uintptr_t	count;	//characters from offset up to and including lastChar
+		uint64_t	line;
+		uint64_t	column;
+	};
+
 	inline stream_decoder(base_istreamer& p_reader): m_reader{p_reader} {}
 	virtual ~stream_decoder();
 
-	[[nodiscard]] stream_error read_while(read_f p_user_cb, void* p_context);
-	[[nodiscard]] result_t get_char();
+	[[nodiscard]] inline stream_error read_while(read_f p_user_cb, void* p_context) { return read_while_as<stream_decoder>(p_user_cb, p_context); }
+
+	//Consumes characters for as long as they are in p_class, the first one that is not is also consumed (see lastChar).
+	//Accepted characters are passed to p_user_cb in runs, p_user_cb can be nullptr if they are to be discarded.
+	[[nodiscard]] inline stream_error read_span(const char_class& p_class, span_f p_user_cb, void* p_context)
+	{
+		return read_span_as<stream_decoder>(p_class, p_user_cb, p_context);
+	}
 
-	[[nodiscard]] inline stream_error stat() { return m_reader.stat(); }
+	[[nodiscard]] inline result_t get_char() { return get_char_as<stream_decoder>(); }
+
+	[[nodiscard]] inline stream_error stat() { return m_decodedPivot != m_decodedLast ? stream_error::None : m_reader.stat(); }
 	[[nodiscard]] inline char32_t lastChar() const { return m_lastChar; }
 
 	[[nodiscard]] inline uint64_t line	() const { return m_line; }
 	[[nodiscard]] inline uint64_t column	() const { return m_column; }
 
+	[[nodiscard]] inline mark_t mark() const
+	{
+		return {m_decodedOffset, m_decodedLast ? m_decodedPivot : 1, m_line, m_column};
+	}
+
+	//Repositions the stream and decodes again up to the lastChar of p_mark
+	template<typename Decoder> [[nodiscard]] stream_error resume_as(const mark_t& p_mark);
+
+	//With it read_span takes runs of characters that can not be structural whole, when the class allows it.
+	//Nothing else changes, it only saves looking at each character of a span.
+	//Note: The index is of the decoded characters, not of the raw bytes, so it is the same for every encoding.
+	//Everything is still decoded, and outside of read_span the grammar still reads one character at a time.
+	inline void use_span_index(bool p_enable)
+	{
+		if(p_enable && !m_indexed) index_decoded();
+		m_indexed = p_enable;
+	}
+
+	//Note: Must be called if the underlying stream is repositioned
 	inline void reset_context()
 	{
 		m_column		= 0;
 		m_line			= 1;
 		m_lastChar		= 0;
+		m_decodedPivot	= 0;
+		m_decodedLast	= 0;
+		m_reader.discard();
+	}
+
+};
+
+template<typename Decoder>
+stream_decoder::result_t stream_decoder::get_char_as()
+{
+	if(m_lastChar == '\n') nextLine();
+	result_t res = next_char<Decoder>();
+	m_lastChar = res.value();
+	++m_column;
+	return res;
+}
+
+template<typename Decoder>
+stream_error stream_decoder::read_while_as(read_f p_user_cb, void* p_context)
+{
+	while(true)
+	{
+		if(m_lastChar == '\n') nextLine();
+		result_t res = next_char<Decoder>();
+		if(!res.has_value())
+		{
+			m_lastChar = 0;
+			return res.error_code();
+		}
+		m_lastChar = res.value();
+		bool should_continue = p_user_cb(res.value(), p_context);
+		++m_column;
+		if(!should_continue) return stream_error::None;
 	}
+}
 
+template<typename Decoder>
+stream_error stream_decoder::read_span_as(const char_class& p_class, span_f p_user_cb, void* p_context)
+{
+	while(true)
+	{
+		if(m_decodedPivot == m_decodedLast)
+		{
+			refill_decoded<Decoder>();
+			if(m_decodedLast == 0)
+			{
+				if(m_lastChar == '\n') nextLine();
+				result_t res = decode_char<Decoder>();
+				if(!res.has_value())
+				{
+					m_lastChar = 0;
+					return res.error_code();
+				}
+				m_lastChar = res.value();
+				++m_column;
+				if(!p_class.contains(m_lastChar)) return stream_error::None;
+				if(p_user_cb) p_user_cb(std::u32string_view{&m_lastChar, 1}, p_context);
+				continue;
+			}
+		}
+
+		const char32_t* const	first	= m_decoded.data() + m_decodedPivot;
+		const char32_t* const	last	= m_decoded.data() + m_decodedLast;
+		const char32_t*			pivot	= first;
+		if(m_indexed && p_class.indexed())
+		{
+			//characters that are not marked are in the class, and none of them is a new line
+			uintptr_t t_pos = m_decodedPivot;
+			while(true)
+			{
+				const uintptr_t t_next = next_structural(t_pos);
+				if(t_next != t_pos)
+				{
+					if(m_lastChar == '\n') nextLine();
+					m_column += t_next - t_pos;
+					m_lastChar = m_decoded[t_next - 1];
+				}
+				pivot = m_decoded.data() + t_next;
+				if(pivot == last) break;
+
+				if(m_lastChar == '\n') nextLine();
+				m_lastChar = *pivot;
+				++m_column;
+				if(!p_class.contains(*pivot)) break;
+				t_pos = t_next + 1;
+			}
+		}
+		else
+		{
+			for(; pivot != last; ++pivot)
+			{
+				if(m_lastChar == '\n') nextLine();
+				m_lastChar = *pivot;
+				++m_column;
+				if(!p_class.contains(*pivot)) break;
+			}
+		}
+
+		if(p_user_cb && pivot != first) p_user_cb(std::u32string_view{first, pivot}, p_context);
+
+		if(pivot != last)
+		{
+			m_decodedPivot = static_cast<uintptr_t>(pivot - m_decoded.data()) + 1;
+			return stream_error::None;
+		}
+		m_decodedPivot = m_decodedLast;
+	}
+}
+
+template<typename Decoder>
+stream_error stream_decoder::resume_as(const mark_t& p_mark)
+{
+	m_reader.seek(p_mark.offset);
+	reset_context();
+
+	for(uintptr_t i = 1; i < p_mark.count; ++i)
+	{
+		result_t res = next_char<Decoder>();
+		if(!res.has_value()) return res.error_code();
+	}
+
+	m_line		= p_mark.line;
+	m_column	= p_mark.column - 1;
+	return get_char_as<Decoder>().error_code();
+}
+
+// Base of the concrete decoders
+// Same interface as stream_decoder, but calls made through the concrete type are not dispatched per character
+template<typename Decoder>
+class stream_decoder_t: public stream_decoder
+{
+public:
+	inline stream_decoder_t(base_istreamer& p_reader): stream_decoder(p_reader) {}
+
+	[[nodiscard]] inline stream_error read_while(read_f p_user_cb, void* p_context) { return read_while_as<Decoder>(p_user_cb, p_context); }
+
+	[[nodiscard]] inline stream_error read_span(const char_class& p_class, span_f p_user_cb, void* p_context)
+	{
+		return read_span_as<Decoder>(p_class, p_user_cb, p_context);
+	}
+
+	[[nodiscard]] inline result_t get_char() { return get_char_as<Decoder>(); }
+
+	[[nodiscard]] inline stream_error resume(const mark_t& p_mark) { return resume_as<Decoder>(p_mark); }
+};
+
+// Collects small writes and passes them on to a base_ostreamer in large blocks
+// Note:
+//	1. Errors from the underlying stream may only be reported on a later write or on flush
+class ostream_buffer
+{
+public:
+	static constexpr uintptr_t block_size = 0x10000;
+
+	inline ostream_buffer(base_ostreamer& p_writer): m_writer{p_writer} {}
+
+	inline stream_error write(const void* p_buffer, uintptr_t p_size)
+	{
+		if(static_cast<uintptr_t>(m_end - m_last) < p_size)
+		{
+			return overflow(p_buffer, p_size);
+		}
+		memcpy(m_last, p_buffer, p_size);
+		m_last += p_size;
+		return stream_error::None;
+	}
+
+	//free space to encode into directly, at least p_size long (p_size <= block_size)
+	//empty if room could not be made
+	[[nodiscard]] inline std::span<char8_t> window(uintptr_t p_size)
+	{
+		if(static_cast<uintptr_t>(m_end - m_last) < p_size && make_room() != stream_error::None)
+		{
+			return {};
+		}
+		return {m_last, m_end};
+	}
+
+	//marks p_size bytes of the window as written
+	inline void commit(uintptr_t p_size) { m_last += p_size; }
+
+	stream_error flush();
+
+private:
+	stream_error make_room();
+	stream_error overflow(const void* p_buffer, uintptr_t p_size);
+
+	base_ostreamer&				m_writer;
+	std::unique_ptr<char8_t[]>	m_buffer;
+	char8_t*					m_last	= nullptr;
+	char8_t*					m_end	= nullptr;
 };
 
 // Used to translate character encoding
@@ -83,12 +492,15 @@ public:
 class stream_encoder
 {
 protected:
-	base_ostreamer& m_writer;
+	ostream_buffer m_writer;
 
 public:
 	inline stream_encoder(base_ostreamer& p_writer): m_writer{p_writer}{}
 	virtual ~stream_encoder();
 
+	//Note: must be called once done, pending data is not written otherwise
+	inline stream_error flush() { return m_writer.flush(); }
+
 	virtual stream_error put_control(char8_t p_char) = 0;
 	virtual stream_error put_sequence(std::u32string_view p_string) = 0;
 	virtual stream_error put_flat(std::u8string_view p_string) = 0;
@@ -108,79 +520,88 @@ namespace ENCODER_P
 //---- Decoders ----
 
 //---- ANSI ----
-class Stream_ANSI_Decoder: public stream_decoder
+class Stream_ANSI_Decoder final: public stream_decoder_t<Stream_ANSI_Decoder>
 {
-protected:
+public:
 	result_t v_get_char() override;
+	uintptr_t v_get_bulk(char32_t* p_out, uintptr_t p_size) override;
 public:
-	inline Stream_ANSI_Decoder(base_istreamer& p_reader): stream_decoder(p_reader) {}
+	inline Stream_ANSI_Decoder(base_istreamer& p_reader): stream_decoder_t(p_reader) {}
 };
 
 //---- UTF8 ----
-class Stream_UTF8_Decoder: public stream_decoder
+class Stream_UTF8_Decoder final: public stream_decoder_t<Stream_UTF8_Decoder>
 {
 public:
 	result_t v_get_char() override;
+	uintptr_t v_get_bulk(char32_t* p_out, uintptr_t p_size) override;
 public:
-	inline Stream_UTF8_Decoder(base_istreamer& p_reader): stream_decoder(p_reader) {}
+	inline Stream_UTF8_Decoder(base_istreamer& p_reader): stream_decoder_t(p_reader) {}
 };
 
-class Stream_UTF8_Decoder_s: public stream_decoder //strict version
+class Stream_UTF8_Decoder_s final: public stream_decoder_t<Stream_UTF8_Decoder_s> //strict version
 {
 public:
 	result_t v_get_char() override;
+	uintptr_t v_get_bulk(char32_t* p_out, uintptr_t p_size) override;
 public:
-	inline Stream_UTF8_Decoder_s(base_istreamer& p_reader): stream_decoder(p_reader) {}
+	inline Stream_UTF8_Decoder_s(base_istreamer& p_reader): stream_decoder_t(p_reader) {}
 };
 
 //---- UTF16 ----
-class Stream_UTF16LE_Decoder: public stream_decoder
+class Stream_UTF16LE_Decoder final: public stream_decoder_t<Stream_UTF16LE_Decoder>
 {
 public:
 	result_t v_get_char() override;
+	uintptr_t v_get_bulk(char32_t* p_out, uintptr_t p_size) override;
 public:
-	inline Stream_UTF16LE_Decoder(base_istreamer& p_reader): stream_decoder(p_reader) {}
+	inline Stream_UTF16LE_Decoder(base_istreamer& p_reader): stream_decoder_t(p_reader) {}
 };
 
-class Stream_UTF16BE_Decoder: public stream_decoder
+class Stream_UTF16BE_Decoder final: public stream_decoder_t<Stream_UTF16BE_Decoder>
 {
 public:
 	result_t v_get_char() override;
+	uintptr_t v_get_bulk(char32_t* p_out, uintptr_t p_size) override;
 public:
-	inline Stream_UTF16BE_Decoder(base_istreamer& p_reader): stream_decoder(p_reader) {}
+	inline Stream_UTF16BE_Decoder(base_istreamer& p_reader): stream_decoder_t(p_reader) {}
 };
 
 //---- UCS4 ----
-class Stream_UCS4LE_Decoder: public stream_decoder
+class Stream_UCS4LE_Decoder final: public stream_decoder_t<Stream_UCS4LE_Decoder>
 {
 public:
 	result_t v_get_char() override;
+	uintptr_t v_get_bulk(char32_t* p_out, uintptr_t p_size) override;
 public:
-	inline Stream_UCS4LE_Decoder(base_istreamer& p_reader): stream_decoder(p_reader) {}
+	inline Stream_UCS4LE_Decoder(base_istreamer& p_reader): stream_decoder_t(p_reader) {}
 };
 
-class Stream_UCS4LE_Decoder_s: public stream_decoder //strict version
+class Stream_UCS4LE_Decoder_s final: public stream_decoder_t<Stream_UCS4LE_Decoder_s> //strict version
 {
 public:
 	result_t v_get_char() override;
+	uintptr_t v_get_bulk(char32_t* p_out, uintptr_t p_size) override;
 public:
-	inline Stream_UCS4LE_Decoder_s(base_istreamer& p_reader): stream_decoder(p_reader) {}
+	inline Stream_UCS4LE_Decoder_s(base_istreamer& p_reader): stream_decoder_t(p_reader) {}
 };
 
-class Stream_UCS4BE_Decoder: public stream_decoder
+class Stream_UCS4BE_Decoder final: public stream_decoder_t<Stream_UCS4BE_Decoder>
 {
 public:
 	result_t v_get_char() override;
+	uintptr_t v_get_bulk(char32_t* p_out, uintptr_t p_size) override;
 public:
-	inline Stream_UCS4BE_Decoder(base_istreamer& p_reader): stream_decoder(p_reader) {}
+	inline Stream_UCS4BE_Decoder(base_istreamer& p_reader): stream_decoder_t(p_reader) {}
 };
 
-class Stream_UCS4BE_Decoder_s: public stream_decoder //strict version
+class Stream_UCS4BE_Decoder_s final: public stream_decoder_t<Stream_UCS4BE_Decoder_s> //strict version
 {
 public:
 	result_t v_get_char() override;
+	uintptr_t v_get_bulk(char32_t* p_out, uintptr_t p_size) override;
 public:
-	inline Stream_UCS4BE_Decoder_s(base_istreamer& p_reader): stream_decoder(p_reader) {}
+	inline Stream_UCS4BE_Decoder_s(base_istreamer& p_reader): stream_decoder_t(p_reader) {}
 };
 
 //---- Encoders ----
@@ -296,5 +717,420 @@ public:
 	bool requires_escape(char32_t p_char) const final;
 };
 
+//======== ======== Decoders ======== ========
+//Defined here so that the reader, instantiated for each decoder, can inline them
+
+inline stream_decoder::result_t Stream_ANSI_Decoder::v_get_char()
+{
+	char8_t r;
+	if(m_reader.read(&r, 1) != 1)
+	{
+		return m_reader.stat() == stream_error::Control_EndOfStream ? stream_error::Control_EndOfStream : stream_error::Unable2Read;
+	}
+	return static_cast<char32_t>(r);
+}
+
+inline uintptr_t Stream_ANSI_Decoder::v_get_bulk(char32_t* p_out, uintptr_t p_size)
+{
+	const std::span<const char8_t> t_input = m_reader.peek();
+	const transcode_result res = ANSI_to_UCS4(t_input.data(), t_input.size(), p_out, p_size);
+	m_reader.skip(res.consumed);
+	return res.produced;
+}
+
+
+inline stream_error extract_utf8_layers(istream_buffer& p_reader, std::span<char8_t> p_buffer)
+{
+	uintptr_t count = p_reader.read(p_buffer.data(), p_buffer.size());
+
+	if(count != p_buffer.size())
+	{
+		if(p_reader.stat() == stream_error::Control_EndOfStream)
+		{
+			for(uintptr_t it = 0; it < count; ++it)
+			{
+				if((p_buffer[it] & 0xC0) != 0x80)
+				{
+					p_reader.unread(count - it);
+					break;
+				}
+			}
+			return stream_error::BadEncoding;
+		}
+		return stream_error::Unable2Read;
+	}
+
+	for(uintptr_t it = 0; it < count; ++it)
+	{
+		if((p_buffer[it] & 0xC0) != 0x80)
+		{
+			p_reader.unread(p_buffer.size() - it);
+			return stream_error::BadEncoding;
+		}
+	}
+	return stream_error::None;
+}
+
+inline stream_decoder::result_t Stream_UTF8_Decoder::v_get_char()
+{
+	char8_t r;
+	if(m_reader.read(&r, 1) != 1)
+	{
+		return (m_reader.stat() == stream_error::Control_EndOfStream) ? stream_error::Control_EndOfStream : stream_error::Unable2Read;
+	}
+
+	if(r & 0x80)
+	{
+		if((r & 0xC0) == 0x80) return stream_error::BadEncoding;
+		if((r & 0xE0) == 0xC0)	//level 1
+		{
+			char8_t r1;
+			if(m_reader.read(&r1, 1) != 1)	return (m_reader.stat() == stream_error::Control_EndOfStream) ? stream_error::BadEncoding : stream_error::Unable2Read;
+			if((r1 & 0xC0) != 0x80)
+			{
+				m_reader.unread(1);
+				return stream_error::BadEncoding;
+			}
+			return
+				((char32_t{r} &0x1F) << 6) |
+				( char32_t{r1} &0x3F);
+		}
+		if((r & 0xF0) == 0xE0) //level 2
+		{
+			char8_t r1[2];
+			stream_error ret = extract_utf8_layers(m_reader, std::span<char8_t>{r1, 2});
+			if(ret != stream_error::None) return ret;
+			return
+				((char32_t{r} & 0x0F) << 12) |
+				((char32_t{r1[0]} & 0x3F) << 6) |
+				( char32_t{r1[1]} & 0x3F);
+		}
+		if((r & 0xF8) == 0xF0) //level 3
+		{
+			char8_t r1[3];
+			stream_error ret = extract_utf8_layers(m_reader, std::span<char8_t>{r1, 3});
+			if(ret != stream_error::None) return ret;
+			//todo code point validation
+			return ((char32_t{r} & 0x07) << 18) | ((char32_t{r1[0]} & 0x3F) << 12) | ((char32_t{r1[1]} & 0x3F) << 6) | (char32_t{r1[2]} & 0x3F);
+		}
+		if((r & 0xFC) == 0xF8) //level 4
+		{
+			char8_t r1[4];
+			stream_error ret = extract_utf8_layers(m_reader, std::span<char8_t>{r1, 4});
+			if(ret != stream_error::None) return ret;
+
+			return
+				((char32_t{r} & 0x03) << 24) |
+				((char32_t{r1[0]} & 0x3F) << 18) |
+				((char32_t{r1[1]} & 0x3F) << 12) |
+				((char32_t{r1[2]} & 0x3F) << 6) |
+				( char32_t{r1[3]} & 0x3F);
+		}
+		if((r & 0xFE) == 0xFC) //level 5
+		{
+			char8_t r1[5];
+			stream_error ret = extract_utf8_layers(m_reader, std::span<char8_t>{r1, 5});
+			if(ret != stream_error::None) return ret;
+
+			return
+				((char32_t{r} & 0x03) << 30) |
+				((char32_t{r1[0]} & 0x3F) << 24) |
+				((char32_t{r1[1]} & 0x3F) << 18) |
+				((char32_t{r1[2]} & 0x3F) << 12) |
+				((char32_t{r1[3]} & 0x3F) << 6) |
+				( char32_t{r1[4]} & 0x3F);
+		}
+		if((r & 0xFF) == 0xFE) //level 6
+		{
+			char8_t r1[6];
+			stream_error ret = extract_utf8_layers(m_reader, std::span<char8_t>{r1, 6});
+			if(ret != stream_error::None) return ret;
+
+			if((r1[0] & 0x3F) > 0x03) return stream_error::BadEncoding;
+
+			return
+				((char32_t{r1[0]} & 0x03) << 30) |
+				((char32_t{r1[1]} & 0x3F) << 24) |
+				((char32_t{r1[2]} & 0x3F) << 18) |
+				((char32_t{r1[3]} & 0x3F) << 12) |
+				((char32_t{r1[4]} & 0x3F) << 6) |
+				( char32_t{r1[5]} & 0x3F);
+		}
+		return stream_error::BadEncoding;
+	}
+	return static_cast<char32_t>(r);
+}
+
+//both versions agree on everything UTF8_to_UCS4 accepts
+inline uintptr_t Stream_UTF8_Decoder::v_get_bulk(char32_t* p_out, uintptr_t p_size)
+{
+	const std::span<const char8_t> t_input = m_reader.peek();
+	const transcode_result res = UTF8_to_UCS4(t_input.data(), t_input.size(), p_out, p_size);
+	m_reader.skip(res.consumed);
+	return res.produced;
+}
+
+inline uintptr_t Stream_UTF8_Decoder_s::v_get_bulk(char32_t* p_out, uintptr_t p_size)
+{
+	const std::span<const char8_t> t_input = m_reader.peek();
+	const transcode_result res = UTF8_to_UCS4(t_input.data(), t_input.size(), p_out, p_size);
+	m_reader.skip(res.consumed);
+	return res.produced;
+}
+
+inline stream_decoder::result_t Stream_UTF8_Decoder_s::v_get_char()
+{
+	char8_t r;
+	if(m_reader.read(&r, 1) != 1)
+	{
+		return (m_reader.stat() == stream_error::Control_EndOfStream) ? stream_error::Control_EndOfStream : stream_error::Unable2Read;
+	}
+
+	if(r & 0x80)
+	{
+		if((r & 0xC0) == 0x80) return stream_error::BadEncoding;
+		if((r & 0xE0) == 0xC0) //level 1
+		{
+			char8_t r1;
+			if(m_reader.read(&r1, 1) != 1)	return (m_reader.stat() == stream_error::Control_EndOfStream) ? stream_error::BadEncoding : stream_error::Unable2Read;
+			if((r1 & 0xC0) != 0x80)
+			{
+				m_reader.unread(1);
+				return stream_error::BadEncoding;
+			}
+
+			if(((r & 0x1F) < 0x02)) return stream_error::BadEncoding;
+			return
+				((char32_t{r} &0x1F) << 6) |
+				( char32_t{r1} &0x3F);
+		}
+		if((r & 0xF0) == 0xE0) //level 2
+		{
+			char8_t r1[2];
+			stream_error ret = extract_utf8_layers(m_reader, std::span<char8_t>{r1, 2});
+			if(ret != stream_error::None) return ret;
+
+			if((r & 0x0F) == 0 && (r1[0] & 0x3F) < 0x20) return stream_error::BadEncoding;
+			return
+				((char32_t{r} & 0x0F) << 12) |
+				((char32_t{r1[0]} & 0x3F) << 6) |
+				( char32_t{r1[1]} & 0x3F);
+		}
+		if((r & 0xF8) == 0xF0) //level 3
+		{
+			char8_t r1[3];
+			stream_error ret = extract_utf8_layers(m_reader, std::span<char8_t>{r1, 3});
+			if(ret != stream_error::None) return ret;
+
+			if((r & 0x07) == 0 && (r1[0] & 0x3F) < 0x10) return stream_error::BadEncoding;
+			return ((char32_t{r} & 0x07) << 18) | ((char32_t{r1[0]} & 0x3F) << 12) | ((char32_t{r1[1]} & 0x3F) << 6) | (char32_t{r1[2]} & 0x3F);
+		}
+		if((r & 0xFC) == 0xF8) //level 4
+		{
+			char8_t r1[4];
+			stream_error ret = extract_utf8_layers(m_reader, std::span<char8_t>{r1, 4});
+			if(ret != stream_error::None) return ret;
+		}
+		else if((r & 0xFE) == 0xFC) //level 5
+		{
+			char8_t r1[5];
+			stream_error ret = extract_utf8_layers(m_reader, std::span<char8_t>{r1, 5});
+			if(ret != stream_error::None) return ret;
+		}
+		else if((r & 0xFF) == 0xFE) //level 6
+		{
+			char8_t r1[6];
+			stream_error ret = extract_utf8_layers(m_reader, std::span<char8_t>{r1, 6});
+			if(ret != stream_error::None) return ret;
+		}
+		return stream_error::BadEncoding;
+	}
+	return static_cast<char32_t>(r);
+}
+
+inline stream_decoder::result_t Stream_UTF16LE_Decoder::v_get_char()
+{
+	char16_t r;
+	uintptr_t t_col = m_reader.read(reinterpret_cast<void*>(&r), 2);
+	if(t_col != 2)
+	{
+		if(m_reader.stat() == stream_error::Control_EndOfStream)
+		{
+			return (t_col == 0) ? stream_error::Control_EndOfStream : stream_error::BadEncoding;
+		}
+		return stream_error::Unable2Read;
+	}
+
+	r = core::endian_little2host(r);
+
+	if(r > 0xD7FF && r < 0xE000)
+	{
+		if((r & 0xFC00) != 0xD800) return stream_error::BadEncoding;
+
+		char16_t r1;
+
+		t_col  = m_reader.read(reinterpret_cast<void*>(&r1), 2);
+
+		if(t_col != 2) return (m_reader.stat() == stream_error::Control_EndOfStream) ? stream_error::BadEncoding : stream_error::Unable2Read;
+
+		r1 = core::endian_little2host(r1);
+		if((r1 & 0xFC00) != 0xDC00)
+		{
+			m_reader.unread(2);
+			return stream_error::BadEncoding;
+		}
+		return (((char32_t{r} & 0x03FF) << 10) | (char32_t{r1} & 0x03FF)) + 0x10000;
+	}
+	return static_cast<char32_t>(r);
+}
+
+inline stream_decoder::result_t Stream_UTF16BE_Decoder::v_get_char()
+{
+	char16_t r;
+	uintptr_t t_col = m_reader.read(reinterpret_cast<void*>(&r), 2);
+	if(t_col != 2)
+	{
+		if(m_reader.stat() == stream_error::Control_EndOfStream)
+		{
+			return (t_col == 0) ? stream_error::Control_EndOfStream : stream_error::BadEncoding;
+		}
+		return stream_error::Unable2Read;
+	}
+
+	r = core::endian_big2host(r);
+
+	if(r > 0xD7FF && r < 0xE000)
+	{
+		if((r & 0xFC00) != 0xD800) return stream_error::BadEncoding;
+
+		char16_t r1;
+
+		t_col  = m_reader.read(reinterpret_cast<void*>(&r1), 2);
+
+		if(t_col != 2) return (m_reader.stat() == stream_error::Control_EndOfStream) ? stream_error::BadEncoding : stream_error::Unable2Read;
+
+		r1 = core::endian_big2host(r1);
+		if((r1 & 0xFC00) != 0xDC00)
+		{
+			m_reader.unread(2);
+			return stream_error::BadEncoding;
+		}
+		return (((char32_t{r} & 0x03FF) << 10) | (char32_t{r1} & 0x03FF)) + 0x10000;
+	}
+	return static_cast<char32_t>(r);
+}
+
+inline uintptr_t Stream_UTF16LE_Decoder::v_get_bulk(char32_t* p_out, uintptr_t p_size)
+{
+	const std::span<const char8_t> t_input = m_reader.peek();
+	const transcode_result res = UTF16LE_to_UCS4(t_input.data(), t_input.size(), p_out, p_size);
+	m_reader.skip(res.consumed);
+	return res.produced;
+}
+
+inline uintptr_t Stream_UTF16BE_Decoder::v_get_bulk(char32_t* p_out, uintptr_t p_size)
+{
+	const std::span<const char8_t> t_input = m_reader.peek();
+	const transcode_result res = UTF16BE_to_UCS4(t_input.data(), t_input.size(), p_out, p_size);
+	m_reader.skip(res.consumed);
+	return res.produced;
+}
+
+inline stream_decoder::result_t Stream_UCS4LE_Decoder::v_get_char()
+{
+	char32_t r;
+	uintptr_t t_col = m_reader.read(reinterpret_cast<void*>(&r), 4);
+	if(t_col != 4)
+	{
+		if(m_reader.stat() == stream_error::Control_EndOfStream)
+		{
+			return (t_col == 0) ? stream_error::Control_EndOfStream : stream_error::BadEncoding;
+		}
+		return stream_error::Unable2Read;
+	}
+	return core::endian_little2host(r);
+}
+
+inline stream_decoder::result_t Stream_UCS4LE_Decoder_s::v_get_char()
+{
+	char32_t r;
+	uintptr_t t_col = m_reader.read(reinterpret_cast<void*>(&r), 4);
+	if(t_col != 4)
+	{
+		if(m_reader.stat() == stream_error::Control_EndOfStream)
+		{
+			return (t_col == 0) ? stream_error::Control_EndOfStream : stream_error::BadEncoding;
+		}
+		return stream_error::Unable2Read;
+	}
+	r = core::endian_little2host(r);
+	if(core::UNICODE_Compliant(r)) return r;
+	return stream_error::BadEncoding;
+}
+
+inline stream_decoder::result_t Stream_UCS4BE_Decoder::v_get_char()
+{
+	char32_t r;
+	uintptr_t t_col = m_reader.read(reinterpret_cast<void*>(&r), 4);
+	if(t_col != 4)
+	{
+		if(m_reader.stat() == stream_error::Control_EndOfStream)
+		{
+			return (t_col == 0) ? stream_error::Control_EndOfStream : stream_error::BadEncoding;
+		}
+		return stream_error::Unable2Read;
+	}
+	return core::endian_big2host(r);
+}
+
+inline stream_decoder::result_t Stream_UCS4BE_Decoder_s::v_get_char()
+{
+	char32_t r;
+	uintptr_t t_col = m_reader.read(reinterpret_cast<void*>(&r), 4);
+	if(t_col != 4)
+	{
+		if(m_reader.stat() == stream_error::Control_EndOfStream)
+		{
+			return (t_col == 0) ? stream_error::Control_EndOfStream : stream_error::BadEncoding;
+		}
+		return stream_error::Unable2Read;
+	}
+	r = core::endian_big2host(r);
+	if(core::UNICODE_Compliant(r)) return r;
+	return stream_error::BadEncoding;
+}
+
+inline uintptr_t Stream_UCS4LE_Decoder::v_get_bulk(char32_t* p_out, uintptr_t p_size)
+{
+	const std::span<const char8_t> t_input = m_reader.peek();
+	const transcode_result res = UCS4LE_to_UCS4(t_input.data(), t_input.size(), p_out, p_size);
+	m_reader.skip(res.consumed);
+	return res.produced;
+}
+
+inline uintptr_t Stream_UCS4LE_Decoder_s::v_get_bulk(char32_t* p_out, uintptr_t p_size)
+{
+	const std::span<const char8_t> t_input = m_reader.peek();
+	const transcode_result res = UCS4LE_to_UCS4_s(t_input.data(), t_input.size(), p_out, p_size);
+	m_reader.skip(res.consumed);
+	return res.produced;
+}
+
+inline uintptr_t Stream_UCS4BE_Decoder::v_get_bulk(char32_t* p_out, uintptr_t p_size)
+{
+	const std::span<const char8_t> t_input = m_reader.peek();
+	const transcode_result res = UCS4BE_to_UCS4(t_input.data(), t_input.size(), p_out, p_size);
+	m_reader.skip(res.consumed);
+	return res.produced;
+}
+
+inline uintptr_t Stream_UCS4BE_Decoder_s::v_get_bulk(char32_t* p_out, uintptr_t p_size)
+{
+	const std::span<const char8_t> t_input = m_reader.peek();
+	const transcode_result res = UCS4BE_to_UCS4_s(t_input.data(), t_input.size(), p_out, p_size);
+	m_reader.skip(res.consumed);
+	return res.produced;
+}
+
 }	// namespace ENCODER_P
 }	// namespace scef
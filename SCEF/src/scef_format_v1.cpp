@@ -32,6 +32,7 @@
 #include <SCEF/scef_items.hpp>
 #include "scef_encoder.hpp"
 #include "scef_danger_act_p.hpp"
+#include "scef_symbols_p.hpp"
 
 namespace scef::format::v1
 {
@@ -66,188 +67,230 @@ inline static constexpr bool is_badCodePoint(char32_t p_char)
 
 constexpr uint8_t MAX_LEVEL = 10;
 
+template<typename Decoder>
 struct ReaderFlow
 {
-	inline ReaderFlow(stream_decoder& p_decoder, _Warning_Def& p_warn)
+	inline ReaderFlow(Decoder& p_decoder, _Warning_Def& p_warn)
 		: m_decoder(p_decoder)
 		, m_warnDef(p_warn)
 	{
 	}
 
-	stream_decoder& m_decoder;
-	_Warning_Def&	m_warnDef;
-	bool			m_skipSpaces;
-	bool			m_skipComments;
-};
-
-static bool skipUntilNewLine(char32_t p_char, void*)
-{
-	return p_char != '\n' && !is_badCodePoint(p_char);
-}
-
-static bool loadUntilNewLine(char32_t p_char, void* p_context)
-{
-	if(p_char == '\n' || is_badCodePoint(p_char))
+	//hands the items completed so far over to the handler and drops them
+	//groups with a body are reported by LoadRoot as they open and close, the ones here ended in their header
+	void deliver(ItemList& p_list)
 	{
-		return false;
+		for(const itemProxy<item>& t_item : p_list)
+		{
+			switch(t_item->type())
+			{
+				case ItemType::group:
+					m_handler->on_group_begin(static_cast<const group&>(*t_item));
+					m_handler->on_group_end(static_cast<const group&>(*t_item));
+					break;
+				case ItemType::key_value:
+					m_handler->on_key_value(static_cast<const keyedValue&>(*t_item));
+					break;
+				case ItemType::singlet:
+					m_handler->on_singlet(static_cast<const singlet&>(*t_item));
+					break;
+				case ItemType::comment:
+					m_handler->on_comment(static_cast<const comment&>(*t_item));
+					break;
+				case ItemType::spacer:
+					m_handler->on_spacer(static_cast<const spacer&>(*t_item));
+					break;
+				default:
+					break;
+			}
+		}
+		recycle(p_list);
 	}
 
-	reinterpret_cast<std::u32string*>(p_context)->push_back(p_char);
-	return true;
-}
-
-static bool skipInlineSpacing(char32_t p_char, void*)
-{
-	return _p::is_space_noLF(p_char);
-}
+	//items nobody else holds are kept to be made again, so that reading without keeping them allocates nothing once warmed up
+	void recycle(ItemList& p_list)
+	{
+		for(itemProxy<item>& t_item : p_list) recycle(std::move(t_item));
+		p_list.clear();
+	}
 
-static bool skipMultilineSpacing(char32_t p_char, void*)
-{
-	return _p::is_space(p_char);
-}
+	void recycle(itemProxy<item>&& p_item)
+	{
+		if(p_item.use_count() != 1) return;
+		std::vector<itemProxy<item>>& t_spare = m_spare[spare_slot(p_item->type())];
+		t_spare.push_back(std::move(p_item));
+	}
 
-static bool loadInlineSpacing(char32_t p_char, void* p_context)
-{
-	if(_p::is_space_noLF(p_char))
+	static constexpr uintptr_t spare_slot(ItemType p_type)
 	{
-		reinterpret_cast<std::u8string*>(p_context)->push_back(static_cast<char8_t>(p_char));
-		return true;
+		switch(p_type)
+		{
+			case ItemType::group:		return 0;
+			case ItemType::singlet:		return 1;
+			case ItemType::key_value:	return 2;
+			case ItemType::comment:		return 3;
+			default:					return 4;
+		}
 	}
-	return false;
-}
 
-struct multiline_spacing_helper
-{
-	std::u8string m_spacing;
-	uint64_t m_line_count = 0;
+	Decoder&									m_decoder;
+	_Warning_Def&								m_warnDef;
+	event_handler*								m_handler = nullptr;
+	std::shared_ptr<std::pmr::memory_resource>	m_arena;	//items are made from it, or from the heap if not set
+	bool										m_skipSpaces;
+	bool										m_skipComments;
+	bool										m_utf8 = false;	//items keep their text as UTF-8
+	_p::symbol_table*							m_symbols = nullptr;	//names are interned in it, if set
+	std::array<std::vector<itemProxy<item>>, 5>	m_spare;	//recycled items by spare_slot, only filled when items are not kept
+	std::u32string								m_name;		//names read before there is an item to keep them
+	std::u32string								m_text;		//values and comments read before they are given to their item
 };
 
-static bool loadMultilineSpacing(char32_t p_char, void* p_context)
+//an item made again is as T::make left it, only the capacity of its strings is kept
+template<typename T>
+static inline void reset_item(T& p_item)
 {
-	multiline_spacing_helper* context = reinterpret_cast<multiline_spacing_helper*>(p_context);
-
-	if(_p::is_space(p_char))
+	p_item.set_position(0, 0);
+	if constexpr(std::is_same_v<T, spacer> || std::is_same_v<T, comment>)
+	{
+		p_item.clear();
+	}
+	else
 	{
-		if(p_char == '\n')
+		p_item.clear_name();
+		p_item.set_quotation_mode(QuotationMode::standard);
+		p_item.m_postSpace.clear();
+		if constexpr(std::is_same_v<T, keyedValue>)
 		{
-			++(context->m_line_count);
-			context->m_spacing.clear();
+			p_item.clear_value();
+			p_item.set_value_quotation_mode(QuotationMode::standard);
+			p_item.set_column_value(0);
+			p_item.m_preSpace.clear();
+			p_item.m_midSpace.clear();
+		}
+		else if constexpr(std::is_same_v<T, group>)
+		{
+			p_item.clear();
+			p_item.m_preSpace.clear();
+			_p::Danger_Action::deferred(p_item) = {};
 		}
-		else context->m_spacing.push_back(static_cast<char8_t>(p_char));
-		return true;
 	}
-
-	return false;
 }
 
-static bool loadNameNoQuote(char32_t p_char, void* p_context)
+template<typename T, typename Decoder>
+static inline itemProxy<T> make_item(ReaderFlow<Decoder>& p_flow)
 {
-	switch(p_char)
+	std::vector<itemProxy<item>>& t_spare = p_flow.m_spare[ReaderFlow<Decoder>::spare_slot(T::static_type())];
+	if(!t_spare.empty())
 	{
-		case ' ':
-		case '\"':
-		case '#':
-		case '\'':
-		case ',':
-		case ':':
-		case ';':
-		case '<':
-		case '=':
-		case '>':
-			return false;
-		default:
-			if(is_dangerCodepoint(p_char)) return false;
-			reinterpret_cast<std::u32string*>(p_context)->push_back(p_char);
-			break;
+		itemProxy<T> t_item = std::static_pointer_cast<T>(std::move(t_spare.back()));
+		t_spare.pop_back();
+		reset_item(*t_item);
+		return t_item;
 	}
 
-	return true;
+	itemProxy<T> t_item = T::make(p_flow.m_arena);
+	if constexpr(!std::is_same_v<T, spacer>)
+	{
+		if(p_flow.m_utf8) t_item->set_utf8(true);
+	}
+	return t_item;
 }
 
-static bool loadSingleQuote(char32_t p_char, void* p_context)
+template<typename Decoder>
+static inline void SetName(ReaderFlow<Decoder>& p_flow, _p::NamedItem& p_item, std::u32string_view p_name)
 {
-	switch(p_char)
+	if(p_flow.m_symbols) p_item.set_name(p_flow.m_symbols->intern(p_name));
+	else p_item.set_name(p_name);
+}
+
+//---- character classes for read_span ----
+constexpr char_class class_untilNewLine = char_class::make(
+	[](char32_t p_char) { return p_char != '\n' && !is_badCodePoint(p_char); }, true);
+
+constexpr char_class class_inlineSpacing = char_class::make(
+	[](char32_t p_char) { return _p::is_space_noLF(p_char); }, false);
+
+constexpr char_class class_multilineSpacing = char_class::make(
+	[](char32_t p_char) { return _p::is_space(p_char); }, false);
+
+constexpr char_class class_nameNoQuote = char_class::make(
+	[](char32_t p_char)
 	{
-		case '\n':
-		case '\'':
-		case '^':
-			return false;
-		default:
-			if(is_badCodePoint(p_char)) return false;
-			reinterpret_cast<std::u32string*>(p_context)->push_back(p_char);
-			break;
-	}
+		switch(p_char)
+		{
+			case ' ':
+			case '\"':
+			case '#':
+			case '\'':
+			case ',':
+			case ':':
+			case ';':
+			case '<':
+			case '=':
+			case '>':
+				return false;
+			default:
+				return !is_dangerCodepoint(p_char);
+		}
+	}, true);
 
-	return true;
-}
+constexpr char_class class_singleQuote = char_class::make(
+	[](char32_t p_char) { return p_char != '\n' && p_char != '\'' && p_char != '^' && !is_badCodePoint(p_char); }, true);
 
-static bool loadDoubleQuote(char32_t p_char, void* p_context)
-{
-	switch(p_char)
+constexpr char_class class_doubleQuote = char_class::make(
+	[](char32_t p_char) { return p_char != '\n' && p_char != '\"' && p_char != '^' && !is_badCodePoint(p_char); }, true);
+
+//characters between the items of a group being skipped
+//any other character but a danger codepoint starts text, which is skipped as the reader takes it in, see ReadTrashSequence
+constexpr char_class class_skipBetween = char_class::make(
+	[](char32_t p_char)
 	{
-		case '\n':
-		case '\"':
-		case '^':
-			return false;
-		default:
-			if(is_badCodePoint(p_char)) return false;
-			reinterpret_cast<std::u32string*>(p_context)->push_back(p_char);
-			break;
-	}
+		switch(p_char)
+		{
+			case ',':
+			case ':':
+			case ';':
+			case '=':
+				return true;
+			default:
+				return _p::is_space(p_char);
+		}
+	}, false);
 
-	return true;
+static void loadRun(std::u32string_view p_run, void* p_context)
+{
+	reinterpret_cast<std::u32string*>(p_context)->append(p_run);
 }
 
-static bool trashNameNoQuote(char32_t p_char, void*)
+static void loadInlineSpacing(std::u32string_view p_run, void* p_context)
 {
-	switch(p_char)
+	std::pmr::u8string& context = *reinterpret_cast<std::pmr::u8string*>(p_context);
+	for(const char32_t tchar : p_run)
 	{
-		case ' ':
-		case '\"':
-		case '#':
-		case '\'':
-		case ',':
-		case ':':
-		case ';':
-		case '<':
-		case '=':
-		case '>':
-			return false;
-		default:
-			if(is_dangerCodepoint(p_char)) return false;
-			break;
+		context.push_back(static_cast<char8_t>(tchar));
 	}
-	return true;
 }
 
-static bool trashSingleQuote(char32_t p_char, void*)
+struct multiline_spacing_helper
 {
-	switch(p_char)
-	{
-		case '\n':
-		case '\'':
-		case '^':
-			return false;
-		default:
-			if(is_badCodePoint(p_char)) return false;
-			break;
-	}
-	return true;
-}
+	std::pmr::u8string m_spacing;
+	uint64_t m_line_count = 0;
+};
 
-static bool trashDoubleQuote(char32_t p_char, void*)
+static void loadMultilineSpacing(std::u32string_view p_run, void* p_context)
 {
-	switch(p_char)
+	multiline_spacing_helper* context = reinterpret_cast<multiline_spacing_helper*>(p_context);
+
+	for(const char32_t tchar : p_run)
 	{
-		case '\n':
-		case '\"':
-		case '^':
-			return false;
-		default:
-			if(is_badCodePoint(p_char)) return false;
-			break;
+		if(tchar == '\n')
+		{
+			++(context->m_line_count);
+			context->m_spacing.clear();
+		}
+		else context->m_spacing.push_back(static_cast<char8_t>(tchar));
 	}
-	return true;
 }
 
 
@@ -283,11 +326,13 @@ static bool loadEscapeOcta(char32_t p_char, void* p_context)
 	return false;
 }
 
-static Error ReadComment(ReaderFlow& p_flow, comment& p_comment)
+template<typename Decoder>
+static Error ReadComment(ReaderFlow<Decoder>& p_flow, comment& p_comment)
 {
 	p_comment.set_position(p_flow.m_decoder.line(), p_flow.m_decoder.column());
-	std::u32string temp;
-	stream_error ret = p_flow.m_decoder.read_while(loadUntilNewLine, &temp);
+	std::u32string& temp = p_flow.m_text;
+	temp.clear();
+	stream_error ret = p_flow.m_decoder.read_span(class_untilNewLine, loadRun, &temp);
 	p_comment.set(temp);
 	if(ret != stream_error::None)
 	{
@@ -296,34 +341,41 @@ static Error ReadComment(ReaderFlow& p_flow, comment& p_comment)
 	}
 	if(p_flow.m_decoder.lastChar() != '\n')
 	{
+		_p::Danger_Action::publicError(*p_flow.m_warnDef._error_context).set_position(p_flow.m_decoder.line(), p_flow.m_decoder.column());
+		_p::Danger_Action::publicError(*p_flow.m_warnDef._error_context).SetPlainError(Error::BadFormat);
 		return Error::BadFormat;
 	}
 
 	return static_cast<Error>(p_flow.m_decoder.get_char().error_code());
 }
 
-static Error ReadCommentSkip(ReaderFlow& p_flow)
+template<typename Decoder>
+static Error ReadCommentSkip(ReaderFlow<Decoder>& p_flow)
 {
-	stream_error ret = p_flow.m_decoder.read_while(skipUntilNewLine, nullptr);
+	stream_error ret = p_flow.m_decoder.read_span(class_untilNewLine, nullptr, nullptr);
 	if(ret != stream_error::None) return static_cast<Error>(ret);
 	if(p_flow.m_decoder.lastChar() != '\n')
 	{
+		_p::Danger_Action::publicError(*p_flow.m_warnDef._error_context).set_position(p_flow.m_decoder.line(), p_flow.m_decoder.column());
+		_p::Danger_Action::publicError(*p_flow.m_warnDef._error_context).SetPlainError(Error::BadFormat);
 		return Error::BadFormat;
 	}
 
 	return static_cast<Error>(p_flow.m_decoder.get_char().error_code());
 }
 
-static Error ReadSpaceSkip(ReaderFlow& p_flow)
+template<typename Decoder>
+static Error ReadSpaceSkip(ReaderFlow<Decoder>& p_flow)
 {
-	return static_cast<Error>(p_flow.m_decoder.read_while(skipMultilineSpacing, nullptr));
+	return static_cast<Error>(p_flow.m_decoder.read_span(class_multilineSpacing, nullptr, nullptr));
 }
 
-static Error ReadSpace(ReaderFlow& p_flow, spacer& p_spacer)
+template<typename Decoder>
+static Error ReadSpace(ReaderFlow<Decoder>& p_flow, spacer& p_spacer)
 {
 	p_spacer.set_position(p_flow.m_decoder.line(), p_flow.m_decoder.column());
 	multiline_spacing_helper data;
-	stream_error ret = p_flow.m_decoder.read_while(loadMultilineSpacing, &data);
+	stream_error ret = p_flow.m_decoder.read_span(class_multilineSpacing, loadMultilineSpacing, &data);
 
 	_p::Danger_Action::setlineCount(p_spacer, data.m_line_count);
 	_p::Danger_Action::move_spacing(p_spacer, data.m_spacing);
@@ -331,10 +383,11 @@ static Error ReadSpace(ReaderFlow& p_flow, spacer& p_spacer)
 }
 
 
-static Error ReadTrashEscapeSequence(ReaderFlow& p_flow)
+template<typename Decoder>
+static Error ReadTrashEscapeSequence(ReaderFlow<Decoder>& p_flow)
 {
 	_Warning_Def& twarn		= p_flow.m_warnDef;
-	stream_decoder& decoder	= p_flow.m_decoder;
+	Decoder& decoder	= p_flow.m_decoder;
 
 	_p::Danger_Action::publicError(*twarn._error_context).set_position(decoder.line(), decoder.column() + 1);
 
@@ -358,14 +411,15 @@ static Error ReadTrashEscapeSequence(ReaderFlow& p_flow)
 }
 
 
-static Error ReadTrashSingleQuote(ReaderFlow& p_flow)
+template<typename Decoder>
+static Error ReadTrashSingleQuote(ReaderFlow<Decoder>& p_flow)
 {
-	stream_decoder& decoder	= p_flow.m_decoder;
+	Decoder& decoder	= p_flow.m_decoder;
 
 	Error lastError;
 	do
 	{
-		lastError = static_cast<Error>(decoder.read_while(trashSingleQuote, nullptr));
+		lastError = static_cast<Error>(decoder.read_span(class_singleQuote, nullptr, nullptr));
 
 magic$continuation:
 		if(lastError != Error::None)
@@ -389,14 +443,15 @@ magic$continuation:
 	} while(true);
 }
 
-static Error ReadTrashDoubleQuote(ReaderFlow& p_flow)
+template<typename Decoder>
+static Error ReadTrashDoubleQuote(ReaderFlow<Decoder>& p_flow)
 {
-	stream_decoder& decoder	= p_flow.m_decoder;
+	Decoder& decoder	= p_flow.m_decoder;
 
 	Error lastError;
 	do
 	{
-		lastError = static_cast<Error>(decoder.read_while(trashDoubleQuote, nullptr));
+		lastError = static_cast<Error>(decoder.read_span(class_doubleQuote, nullptr, nullptr));
 
 magic$continuation:
 		if(lastError != Error::None)
@@ -420,9 +475,10 @@ magic$continuation:
 	} while(true);
 }
 
-static Error ReadTrashSequence(ReaderFlow& p_flow)
+template<typename Decoder>
+static Error ReadTrashSequence(ReaderFlow<Decoder>& p_flow)
 {
-	stream_decoder& decoder	= p_flow.m_decoder;
+	Decoder& decoder	= p_flow.m_decoder;
 	Error lastError;
 
 	switch(decoder.lastChar())
@@ -434,7 +490,7 @@ static Error ReadTrashSequence(ReaderFlow& p_flow)
 			lastError = ReadTrashDoubleQuote(p_flow);
 			break;
 		default:
-			lastError = static_cast<Error>(decoder.read_while(trashNameNoQuote, nullptr));
+			lastError = static_cast<Error>(decoder.read_span(class_nameNoQuote, nullptr, nullptr));
 			break;
 	}
 
@@ -460,7 +516,7 @@ static Error ReadTrashSequence(ReaderFlow& p_flow)
 				break;
 			default:
 				if(_p::is_space_noLF(tchar)) return Error::None;
-				lastError = static_cast<Error>(decoder.read_while(trashNameNoQuote, nullptr));
+				lastError = static_cast<Error>(decoder.read_span(class_nameNoQuote, nullptr, nullptr));
 				break;
 		}
 	}
@@ -468,10 +524,11 @@ static Error ReadTrashSequence(ReaderFlow& p_flow)
 	return lastError;
 }
 
-static Error ReadEscapeSequence(ReaderFlow& p_flow, std::u32string& p_out)
+template<typename Decoder>
+static Error ReadEscapeSequence(ReaderFlow<Decoder>& p_flow, std::u32string& p_out)
 {
 	_Warning_Def& twarn		= p_flow.m_warnDef;
-	stream_decoder& decoder	= p_flow.m_decoder;
+	Decoder& decoder	= p_flow.m_decoder;
 
 	_p::Danger_Action::publicError(*twarn._error_context).set_position(decoder.line(), decoder.column() + 1);
 
@@ -644,15 +701,16 @@ static Error ReadEscapeSequence(ReaderFlow& p_flow, std::u32string& p_out)
 	return static_cast<Error>(decoder.get_char().error_code());
 }
 
-static Error ReadSingleQuote(ReaderFlow& p_flow, std::u32string& p_out)
+template<typename Decoder>
+static Error ReadSingleQuote(ReaderFlow<Decoder>& p_flow, std::u32string& p_out)
 {
 	_Warning_Def& twarn		= p_flow.m_warnDef;
-	stream_decoder& decoder	= p_flow.m_decoder;
+	Decoder& decoder	= p_flow.m_decoder;
 
 	Error lastError;
 	do
 	{
-		lastError = static_cast<Error>(decoder.read_while(loadSingleQuote, &p_out));
+		lastError = static_cast<Error>(decoder.read_span(class_singleQuote, loadRun, &p_out));
 
 magic$continuation:
 		if(lastError != Error::None)
@@ -706,15 +764,16 @@ magic$continuation:
 	} while(true);
 }
 
-static Error ReadDoubleQuote(ReaderFlow& p_flow, std::u32string& p_out)
+template<typename Decoder>
+static Error ReadDoubleQuote(ReaderFlow<Decoder>& p_flow, std::u32string& p_out)
 {
 	_Warning_Def& twarn		= p_flow.m_warnDef;
-	stream_decoder& decoder	= p_flow.m_decoder;
+	Decoder& decoder	= p_flow.m_decoder;
 
 	Error lastError;
 	do
 	{
-		lastError = static_cast<Error>(decoder.read_while(loadDoubleQuote, &p_out));
+		lastError = static_cast<Error>(decoder.read_span(class_doubleQuote, loadRun, &p_out));
 
 magic$continuation:
 		if(lastError != Error::None)
@@ -768,10 +827,11 @@ magic$continuation:
 	} while(true);
 }
 
-static Error ReadName(ReaderFlow& p_flow, std::u32string& p_out, QuotationMode& p_quotMode)
+template<typename Decoder>
+static Error ReadName(ReaderFlow<Decoder>& p_flow, std::u32string& p_out, QuotationMode& p_quotMode)
 {
 	_Warning_Def& twarn		= p_flow.m_warnDef;
-	stream_decoder& decoder	= p_flow.m_decoder;
+	Decoder& decoder	= p_flow.m_decoder;
 
 	p_quotMode = QuotationMode::standard;
 	Error lastError;
@@ -788,7 +848,7 @@ static Error ReadName(ReaderFlow& p_flow, std::u32string& p_out, QuotationMode&
 			break;
 		default:
 			p_out.push_back(decoder.lastChar());
-			lastError = static_cast<Error>(decoder.read_while(loadNameNoQuote, &p_out));
+			lastError = static_cast<Error>(decoder.read_span(class_nameNoQuote, loadRun, &p_out));
 			break;
 	}
 
@@ -847,7 +907,7 @@ static Error ReadName(ReaderFlow& p_flow, std::u32string& p_out, QuotationMode&
 			default:
 				if(_p::is_space_noLF(tchar)) return Error::None;
 				p_out.push_back(tchar);
-				lastError = static_cast<Error>(decoder.read_while(loadNameNoQuote, &p_out));
+				lastError = static_cast<Error>(decoder.read_span(class_nameNoQuote, loadRun, &p_out));
 				break;
 		}
 	}
@@ -855,10 +915,11 @@ static Error ReadName(ReaderFlow& p_flow, std::u32string& p_out, QuotationMode&
 	return lastError;
 }
 
-static Error ReadKeyValue(ReaderFlow& p_flow, keyedValue& p_keyValue, ItemList& p_list)
+template<typename Decoder>
+static Error ReadKeyValue(ReaderFlow<Decoder>& p_flow, keyedValue& p_keyValue, ItemList& p_list)
 {
 	_Warning_Def& twarn = p_flow.m_warnDef;
-	stream_decoder& decoder = p_flow.m_decoder;
+	Decoder& decoder = p_flow.m_decoder;
 	uint64_t line = decoder.line();
 	uint64_t column = decoder.column() + 1;
 
@@ -889,17 +950,17 @@ static Error ReadKeyValue(ReaderFlow& p_flow, keyedValue& p_keyValue, ItemList&
 			return static_cast<Error>(str_err);
 	}
 
-	std::u8string tspacing;
+	std::pmr::u8string tspacing;
 
 	if(_p::is_space_noLF(decoder.lastChar()))
 	{
 		if(p_flow.m_skipSpaces)
 		{
-			str_err = decoder.read_while(skipInlineSpacing, nullptr);
+			str_err = decoder.read_span(class_inlineSpacing, nullptr, nullptr);
 		}
 		else
 		{
-			str_err = decoder.read_while(loadInlineSpacing, &tspacing);
+			str_err = decoder.read_span(class_inlineSpacing, loadInlineSpacing, &tspacing);
 		}
 
 		switch(str_err)
@@ -956,7 +1017,7 @@ static Error ReadKeyValue(ReaderFlow& p_flow, keyedValue& p_keyValue, ItemList&
 		case '>':
 			if(!tspacing.empty())
 			{
-				itemProxy<spacer> t_item = spacer::make();
+				itemProxy<spacer> t_item = make_item<spacer>(p_flow);
 				t_item->set_position(line, column);
 				p_list.push_back(t_item);
 				_p::Danger_Action::move_spacing(*t_item, tspacing);
@@ -1008,7 +1069,10 @@ static Error ReadKeyValue(ReaderFlow& p_flow, keyedValue& p_keyValue, ItemList&
 	{
 		QuotationMode tmode;
 		p_keyValue.set_column_value(decoder.column());
-		res = ReadName(p_flow, p_keyValue.value(), tmode);
+		std::u32string& t_value = p_flow.m_text;
+		t_value.clear();
+		res = ReadName(p_flow, t_value, tmode);
+		p_keyValue.set_value(t_value);
 		p_keyValue.set_value_quotation_mode(tmode);
 	}
 
@@ -1043,11 +1107,11 @@ static Error ReadKeyValue(ReaderFlow& p_flow, keyedValue& p_keyValue, ItemList&
 	{
 		if(p_flow.m_skipSpaces)
 		{
-			str_err = decoder.read_while(skipInlineSpacing, nullptr);
+			str_err = decoder.read_span(class_inlineSpacing, nullptr, nullptr);
 		}
 		else
 		{
-			str_err = decoder.read_while(loadInlineSpacing, &tspacing);
+			str_err = decoder.read_span(class_inlineSpacing, loadInlineSpacing, &tspacing);
 		}
 
 		switch(str_err)
@@ -1115,7 +1179,7 @@ static Error ReadKeyValue(ReaderFlow& p_flow, keyedValue& p_keyValue, ItemList&
 		default:
 			if(!tspacing.empty())
 			{
-				itemProxy<spacer> t_item = spacer::make();
+				itemProxy<spacer> t_item = make_item<spacer>(p_flow);
 				t_item->set_position(line, column);
 				p_list.push_back(t_item);
 				_p::Danger_Action::move_spacing(*t_item, tspacing);
@@ -1140,12 +1204,14 @@ static Error ReadKeyValue(ReaderFlow& p_flow, keyedValue& p_keyValue, ItemList&
 	return Error::None;
 }
 
-static Error ReadTValue(ReaderFlow& p_flow, ItemList& p_list)
+template<typename Decoder>
+static Error ReadTValue(ReaderFlow<Decoder>& p_flow, ItemList& p_list)
 {
 	_Warning_Def& twarn = p_flow.m_warnDef;
-	stream_decoder& decoder = p_flow.m_decoder;
+	Decoder& decoder = p_flow.m_decoder;
 
-	std::u32string tName;
+	std::u32string& tName = p_flow.m_name;
+	tName.clear();
 	QuotationMode tmode;
 
 	uint64_t line = decoder.line();
@@ -1157,10 +1223,10 @@ static Error ReadTValue(ReaderFlow& p_flow, ItemList& p_list)
 	{
 		if(lastError == Error::Control_EndOfStream)
 		{
-			itemProxy<singlet> t_singlet = singlet::make();
+			itemProxy<singlet> t_singlet = make_item<singlet>(p_flow);
 			t_singlet->set_position(line, column);
 			p_list.push_back(t_singlet);
-			t_singlet->set_name(tName);
+			SetName(p_flow, *t_singlet, tName);
 			t_singlet->set_quotation_mode(tmode);
 			_p::Danger_Action::publicError(*twarn._error_context).m_criticalItem = t_singlet.get();
 			_p::Danger_Action::publicError(*twarn._error_context).set_position(decoder.line(), decoder.column() + 1);
@@ -1182,7 +1248,7 @@ static Error ReadTValue(ReaderFlow& p_flow, ItemList& p_list)
 	}
 	char32_t lchar = decoder.lastChar();
 
-	std::u8string tspacing;
+	std::pmr::u8string tspacing;
 	uint64_t spacing_column = decoder.column();
 	if(_p::is_space_noLF(decoder.lastChar()))
 	{
@@ -1190,19 +1256,19 @@ static Error ReadTValue(ReaderFlow& p_flow, ItemList& p_list)
 		stream_error str_err;
 		if(p_flow.m_skipSpaces)
 		{
-			str_err = decoder.read_while(skipInlineSpacing, nullptr);
+			str_err = decoder.read_span(class_inlineSpacing, nullptr, nullptr);
 		}
 		else
 		{
-			str_err = decoder.read_while(loadInlineSpacing, &tspacing);
+			str_err = decoder.read_span(class_inlineSpacing, loadInlineSpacing, &tspacing);
 		}
 
 		if(str_err != stream_error::None)
 		{
-			itemProxy<singlet> t_singlet = singlet::make();
+			itemProxy<singlet> t_singlet = make_item<singlet>(p_flow);
 			t_singlet->set_position(line, column);
 			p_list.push_back(t_singlet);
-			t_singlet->set_name(tName);
+			SetName(p_flow, *t_singlet, tName);
 			t_singlet->set_quotation_mode(tmode);
 
 			if(str_err != stream_error::Control_EndOfStream)
@@ -1217,10 +1283,10 @@ static Error ReadTValue(ReaderFlow& p_flow, ItemList& p_list)
 	lchar = decoder.lastChar();
 	if(lchar != '=')
 	{
-		itemProxy<singlet> t_singlet = singlet::make();
+		itemProxy<singlet> t_singlet = make_item<singlet>(p_flow);
 		t_singlet->set_position(line, column);
 		p_list.push_back(t_singlet);
-		t_singlet->set_name(tName);
+		SetName(p_flow, *t_singlet, tName);
 		t_singlet->set_quotation_mode(tmode);
 
 		switch(lchar)
@@ -1265,7 +1331,7 @@ static Error ReadTValue(ReaderFlow& p_flow, ItemList& p_list)
 				//insert spacing here
 				if(!tspacing.empty())
 				{
-					itemProxy<spacer> t_spacer = spacer::make();
+					itemProxy<spacer> t_spacer = make_item<spacer>(p_flow);
 					t_spacer->set_position(line, spacing_column);
 					p_list.push_back(t_spacer);
 					_p::Danger_Action::move_spacing(*t_spacer, tspacing);
@@ -1297,22 +1363,26 @@ static Error ReadTValue(ReaderFlow& p_flow, ItemList& p_list)
 	}
 
 	//at this point it is certain to be a keyvalue
-	itemProxy<keyedValue> t_keyValue = keyedValue::make();
+	itemProxy<keyedValue> t_keyValue = make_item<keyedValue>(p_flow);
 	t_keyValue->set_position(line, column);
 	t_keyValue->set_column_value(decoder.column() + 1);
 	p_list.push_back(t_keyValue);
-	t_keyValue->set_name(tName);
+	SetName(p_flow, *t_keyValue, tName);
 	t_keyValue->set_quotation_mode(tmode);
 	_p::Danger_Action::move_spacing(t_keyValue->m_preSpace, tspacing);
 
 	return ReadKeyValue(p_flow, *t_keyValue, p_list);
 }
 
-static Error ReadGroup(ReaderFlow& p_flow, group& p_group)
+//p_body is set if the header ended in a body, the returned error is then where the body starts from
+//otherwise it is the result of the whole group
+template<typename Decoder>
+static Error ReadGroupHeader(ReaderFlow<Decoder>& p_flow, group& p_group, bool& p_body)
 {
 	_Warning_Def& twarn = p_flow.m_warnDef;
-	stream_decoder& decoder = p_flow.m_decoder;
+	Decoder& decoder = p_flow.m_decoder;
 	Error lastError = Error::None;
+	p_body = false;
 
 	_p::Danger_Action::publicError(*twarn._error_context).m_criticalItem = &p_group;
 
@@ -1320,12 +1390,12 @@ static Error ReadGroup(ReaderFlow& p_flow, group& p_group)
 		stream_error str_err;
 		if(p_flow.m_skipSpaces)
 		{
-			str_err = decoder.read_while(skipInlineSpacing, nullptr);
+			str_err = decoder.read_span(class_inlineSpacing, nullptr, nullptr);
 		}
 		else
 		{
-			std::u8string tsrt;
-			str_err = decoder.read_while(loadInlineSpacing, &tsrt);
+			std::pmr::u8string tsrt;
+			str_err = decoder.read_span(class_inlineSpacing, loadInlineSpacing, &tsrt);
 			_p::Danger_Action::move_spacing(p_group.m_preSpace, tsrt);
 		}
 		switch(str_err)
@@ -1446,7 +1516,10 @@ static Error ReadGroup(ReaderFlow& p_flow, group& p_group)
 			else
 			{
 				QuotationMode tmode = QuotationMode::standard;
-				Error t_err = ReadName(p_flow, p_group.name(), tmode);
+				std::u32string& t_name = p_flow.m_name;
+				t_name.clear();
+				Error t_err = ReadName(p_flow, t_name, tmode);
+				SetName(p_flow, p_group, t_name);
 				p_group.set_quotation_mode(tmode);
 				if(t_err != Error::None)
 				{
@@ -1562,12 +1635,12 @@ static Error ReadGroup(ReaderFlow& p_flow, group& p_group)
 				stream_error str_err;
 				if(p_flow.m_skipSpaces)
 				{
-					str_err = decoder.read_while(skipInlineSpacing, nullptr);
+					str_err = decoder.read_span(class_inlineSpacing, nullptr, nullptr);
 				}
 				else
 				{
-					std::u8string tsrt;
-					str_err = decoder.read_while(loadInlineSpacing, &tsrt);
+					std::pmr::u8string tsrt;
+					str_err = decoder.read_span(class_inlineSpacing, loadInlineSpacing, &tsrt);
 					_p::Danger_Action::move_spacing(p_group.m_postSpace, tsrt);
 				}
 				switch(str_err)
@@ -1625,334 +1698,962 @@ static Error ReadGroup(ReaderFlow& p_flow, group& p_group)
 	}
 
 ReadGroup$HeaderEnd:
-	_p::Danger_Action::publicError(*twarn._error_context).m_stack.push_back(&p_group);
-	_p::Danger_Action::publicError(*twarn._error_context).m_criticalItem = nullptr;
-	do
+	p_body = true;
+	return lastError;
+}
+
+//what a single step through a list of items ended up doing
+enum class Step: uint8_t
+{
+	Continue,	//keep going from p_lastError
+	Open,		//the last item in the list is a group, its header is read and its body starts now
+	Close,		//the group being read is done
+	Stop,		//reading ends here, p_lastError says why
+};
+
+//reads the next item in the body of a group into p_list
+template<typename Decoder>
+static Step StepGroup(ReaderFlow<Decoder>& p_flow, ItemList& p_list, Error& p_lastError)
+{
+	_Warning_Def& twarn = p_flow.m_warnDef;
+	Decoder& decoder = p_flow.m_decoder;
+	Error& lastError = p_lastError;
+
+	switch(lastError)
 	{
-		switch(lastError)
-		{
-			case Error::None:
+		case Error::None:
+			{
+				char32_t lastChar = decoder.lastChar();
+				switch(lastChar)
 				{
-					char32_t lastChar = decoder.lastChar();
-					switch(lastChar)
-					{
-						case ':':
-							{
-								_p::Danger_Action::publicError(*twarn._error_context).set_position(decoder.line(), decoder.column());
-								_p::Danger_Action::publicError(*twarn._error_context).SetErrorInvalidChar(':', 0);
-								switch(twarn.Notify())
-								{
-									case warningBehaviour::Continue:
-									case warningBehaviour::Discard:
-									case warningBehaviour::Default:
-									case warningBehaviour::Accept:
-										lastError = static_cast<Error>(decoder.get_char().error_code());
-										break;
-									case warningBehaviour::Abort:
-									default:
-										return Error::InvalidChar;
-								}
-							}
-							break;
-						case ',':
-						case ';':
+					case ':':
+						{
 							_p::Danger_Action::publicError(*twarn._error_context).set_position(decoder.line(), decoder.column());
-							_p::Danger_Action::publicError(*twarn._error_context).SetErrorInvalidChar(lastChar, 0);
-							switch(p_flow.m_warnDef.Notify())
+							_p::Danger_Action::publicError(*twarn._error_context).SetErrorInvalidChar(':', 0);
+							switch(twarn.Notify())
 							{
 								case warningBehaviour::Continue:
 								case warningBehaviour::Discard:
 								case warningBehaviour::Default:
-									lastError = static_cast<Error>(decoder.get_char().error_code());
-									break;
-								case warningBehaviour::Accept:
-									//Add Ghost singlet
-									{
-										itemProxy<singlet> t_item = singlet::make();
-										t_item->set_position(decoder.line(), decoder.column());
-										p_group.push_back(t_item);
-									}
-									lastError = static_cast<Error>(decoder.get_char().error_code());
-									break;
-								case warningBehaviour::Abort:
-								default:
-									return Error::InvalidChar;
-							}
-							break;
-						case '=':
-							_p::Danger_Action::publicError(*twarn._error_context).set_position(decoder.line(), decoder.column());
-							_p::Danger_Action::publicError(*twarn._error_context).SetErrorInvalidChar('=', 0);
-							switch(twarn.Notify())
-							{
-								case warningBehaviour::Default:
-								case warningBehaviour::Continue:
 								case warningBehaviour::Accept:
-									//Start key
-									{
-										itemProxy<keyedValue> t_item = keyedValue::make();
-										t_item->set_position(decoder.line(), decoder.column());
-										t_item->set_column_value(decoder.column() + 1);
-										p_group.push_back(t_item);
-										lastError = ReadKeyValue(p_flow, *t_item, p_group);
-									}
-									break;
-								case warningBehaviour::Discard:
 									lastError = static_cast<Error>(decoder.get_char().error_code());
 									break;
 								case warningBehaviour::Abort:
 								default:
-									return Error::InvalidChar;
-							}
-							break;
-						case '<':
-							//Start group
-							{
-								itemProxy<group> t_item = group::make();
-								t_item->set_position(decoder.line(), decoder.column());
-								p_group.push_back(t_item);
-								lastError = ReadGroup(p_flow, *t_item);
+									lastError = Error::InvalidChar;
+									return Step::Stop;
 							}
-							break;
-						case '>':
-							_p::Danger_Action::publicError(*twarn._error_context).m_stack.pop_back();
-							return static_cast<Error>(decoder.get_char().error_code());
-						case '#':
-							//Start comment
-							if(p_flow.m_skipComments)
-							{
-								lastError = ReadCommentSkip(p_flow);
-							}
-							else
-							{
-								itemProxy<comment> t_item = comment::make();
-								p_group.push_back(t_item);
-								lastError = ReadComment(p_flow, *t_item);
-							}
-							break;
-						default:
-							if(_p::is_space(lastChar)) //spaces
-							{
-								//Start spacing
-								if(p_flow.m_skipSpaces)
+						}
+						break;
+					case ',':
+					case ';':
+						_p::Danger_Action::publicError(*twarn._error_context).set_position(decoder.line(), decoder.column());
+						_p::Danger_Action::publicError(*twarn._error_context).SetErrorInvalidChar(lastChar, 0);
+						switch(p_flow.m_warnDef.Notify())
+						{
+							case warningBehaviour::Continue:
+							case warningBehaviour::Discard:
+							case warningBehaviour::Default:
+								lastError = static_cast<Error>(decoder.get_char().error_code());
+								break;
+							case warningBehaviour::Accept:
+								//Add Ghost singlet
 								{
-									lastError = ReadSpaceSkip(p_flow);
+									itemProxy<singlet> t_item = make_item<singlet>(p_flow);
+									t_item->set_position(decoder.line(), decoder.column());
+									p_list.push_back(t_item);
 								}
-								else
+								lastError = static_cast<Error>(decoder.get_char().error_code());
+								break;
+							case warningBehaviour::Abort:
+							default:
+								lastError = Error::InvalidChar;
+								return Step::Stop;
+						}
+						break;
+					case '=':
+						_p::Danger_Action::publicError(*twarn._error_context).set_position(decoder.line(), decoder.column());
+						_p::Danger_Action::publicError(*twarn._error_context).SetErrorInvalidChar('=', 0);
+						switch(twarn.Notify())
+						{
+							case warningBehaviour::Default:
+							case warningBehaviour::Continue:
+							case warningBehaviour::Accept:
+								//Start key
 								{
-									itemProxy<spacer> t_item = spacer::make();
-									p_group.push_back(t_item);
-									lastError = ReadSpace(p_flow, *t_item);
+									itemProxy<keyedValue> t_item = make_item<keyedValue>(p_flow);
+									t_item->set_position(decoder.line(), decoder.column());
+									t_item->set_column_value(decoder.column() + 1);
+									p_list.push_back(t_item);
+									lastError = ReadKeyValue(p_flow, *t_item, p_list);
 								}
-							}
-							else if(is_dangerCodepoint(lastChar))
+								break;
+							case warningBehaviour::Discard:
+								lastError = static_cast<Error>(decoder.get_char().error_code());
+								break;
+							case warningBehaviour::Abort:
+							default:
+								lastError = Error::InvalidChar;
+								return Step::Stop;
+						}
+						break;
+					case '<':
+						//Start group
+						{
+							itemProxy<group> t_item = make_item<group>(p_flow);
+							t_item->set_position(decoder.line(), decoder.column());
+							p_list.push_back(t_item);
+							bool t_body;
+							lastError = ReadGroupHeader(p_flow, *t_item, t_body);
+							if(t_body) return Step::Open;
+						}
+						break;
+					case '>':
+						lastError = static_cast<Error>(decoder.get_char().error_code());
+						return Step::Close;
+					case '#':
+						//Start comment
+						if(p_flow.m_skipComments)
+						{
+							lastError = ReadCommentSkip(p_flow);
+						}
+						else
+						{
+							itemProxy<comment> t_item = make_item<comment>(p_flow);
+							p_list.push_back(t_item);
+							lastError = ReadComment(p_flow, *t_item);
+						}
+						break;
+					default:
+						if(_p::is_space(lastChar)) //spaces
+						{
+							//Start spacing
+							if(p_flow.m_skipSpaces)
 							{
-								_p::Danger_Action::publicError(*twarn._error_context).set_position(decoder.line(), decoder.column());
-								_p::Danger_Action::publicError(*twarn._error_context).SetPlainError(Error::BadFormat);
-								return Error::BadFormat;
+								lastError = ReadSpaceSkip(p_flow);
 							}
 							else
 							{
-								lastError = ReadTValue(p_flow, p_group);
+								itemProxy<spacer> t_item = make_item<spacer>(p_flow);
+								p_list.push_back(t_item);
+								lastError = ReadSpace(p_flow, *t_item);
 							}
-							break;
-					}
-				}
-				break;
-			case Error::Control_EndOfStream:
-				_p::Danger_Action::publicError(*twarn._error_context).set_position(decoder.line(), decoder.column() + 1);
-				_p::Danger_Action::publicError(*twarn._error_context).SetErrorPrematureEnding('>');
-				switch(p_flow.m_warnDef.Notify())
-				{
-					case warningBehaviour::Continue:
-					case warningBehaviour::Discard:
-					case warningBehaviour::Accept:
+						}
+						else if(is_dangerCodepoint(lastChar))
+						{
+							_p::Danger_Action::publicError(*twarn._error_context).set_position(decoder.line(), decoder.column());
+							_p::Danger_Action::publicError(*twarn._error_context).SetPlainError(Error::BadFormat);
+							lastError = Error::BadFormat;
+							return Step::Stop;
+						}
+						else
+						{
+							lastError = ReadTValue(p_flow, p_list);
+						}
 						break;
-					case warningBehaviour::Default:
-					case warningBehaviour::Abort:
-					default:
-						return Error::PrematureEnd;
 				}
-				_p::Danger_Action::publicError(*twarn._error_context).m_stack.pop_back();
-				return Error::Control_EndOfStream;
-			default:
-				return lastError;
-		}
-	} while(true);
-	//unreachable
+			}
+			break;
+		case Error::Control_EndOfStream:
+			_p::Danger_Action::publicError(*twarn._error_context).set_position(decoder.line(), decoder.column() + 1);
+			_p::Danger_Action::publicError(*twarn._error_context).SetErrorPrematureEnding('>');
+			switch(p_flow.m_warnDef.Notify())
+			{
+				case warningBehaviour::Continue:
+				case warningBehaviour::Discard:
+				case warningBehaviour::Accept:
+					break;
+				case warningBehaviour::Default:
+				case warningBehaviour::Abort:
+				default:
+					lastError = Error::PrematureEnd;
+					return Step::Stop;
+			}
+			return Step::Close;
+		default:
+			return Step::Stop;
+	}
+	return Step::Continue;
 }
 
-
-void load(root& p_root, stream_decoder& p_decoder, Flag p_flags, [[maybe_unused]] uint16_t p_detected_version, _Warning_Def& p_warn)
+//reads the next item at the top of the document into p_list
+template<typename Decoder>
+static Step StepRoot(ReaderFlow<Decoder>& p_flow, ItemList& p_list, Error& p_lastError)
 {
-	ReaderFlow t_flow(p_decoder, p_warn);
-
-	t_flow.m_skipSpaces		= (p_flags & Flag::DisableSpacers) != Flag{};
-	t_flow.m_skipComments	= (p_flags & Flag::DisableComments) != Flag{};
-
-	Error lastError = static_cast<Error>(p_decoder.get_char().error_code());
-
-	_p::Danger_Action::publicError(*p_warn._error_context).m_criticalItem = nullptr;
+	_Warning_Def& twarn = p_flow.m_warnDef;
+	Decoder& decoder = p_flow.m_decoder;
+	Error& lastError = p_lastError;
 
-	do
+	switch(lastError)
 	{
-		switch(lastError)
-		{
-			case Error::None:
+		case Error::None:
+			{
+				char32_t lastChar = decoder.lastChar();
+				switch(lastChar)
 				{
-					char32_t lastChar = p_decoder.lastChar();
-					switch(lastChar)
-					{
-						case '#':
-							//Start comment
-							if(t_flow.m_skipComments)
-							{
-								lastError = ReadCommentSkip(t_flow);
-							}
-							else
-							{
-								itemProxy<comment> t_item = comment::make();
-								p_root.push_back(t_item);
-								lastError = ReadComment(t_flow, *t_item);
-							}
-							break;
-						case '<':
-							//Start group
-							{
-								itemProxy<group> t_item = group::make();
-								t_item->set_position(p_decoder.line(), p_decoder.column());
-								p_root.push_back(t_item);
-								lastError = ReadGroup(t_flow, *t_item);
-							}
-							break;
-						case ',':
-						case ';':
-							_p::Danger_Action::publicError(*p_warn._error_context).set_position(p_decoder.line(), p_decoder.column());
-							_p::Danger_Action::publicError(*p_warn._error_context).SetErrorInvalidChar(lastChar, 0);
+					case '#':
+						//Start comment
+						if(p_flow.m_skipComments)
+						{
+							lastError = ReadCommentSkip(p_flow);
+						}
+						else
+						{
+							itemProxy<comment> t_item = make_item<comment>(p_flow);
+							p_list.push_back(t_item);
+							lastError = ReadComment(p_flow, *t_item);
+						}
+						break;
+					case '<':
+						//Start group
+						{
+							itemProxy<group> t_item = make_item<group>(p_flow);
+							t_item->set_position(decoder.line(), decoder.column());
+							p_list.push_back(t_item);
+							bool t_body;
+							lastError = ReadGroupHeader(p_flow, *t_item, t_body);
+							if(t_body) return Step::Open;
+						}
+						break;
+					case ',':
+					case ';':
+						_p::Danger_Action::publicError(*twarn._error_context).set_position(decoder.line(), decoder.column());
+						_p::Danger_Action::publicError(*twarn._error_context).SetErrorInvalidChar(lastChar, 0);
 
-							switch(p_warn.Notify())
-							{
-								case warningBehaviour::Default:
-								case warningBehaviour::Continue:
-								case warningBehaviour::Discard:
-									lastError = static_cast<Error>(p_decoder.get_char().error_code());
-									break;
-								case warningBehaviour::Accept:
-									//Add Ghost singlet
-									{
-										itemProxy<singlet> t_item = singlet::make();
-										t_item->set_position(p_decoder.line(), p_decoder.column());
-										p_root.push_back(t_item);
-									}
-									lastError = static_cast<Error>(p_decoder.get_char().error_code());
-									break;
-								case warningBehaviour::Abort:
-								default:
-									return;
-							}
-							break;
-						case '=':
-							_p::Danger_Action::publicError(*p_warn._error_context).set_position(p_decoder.line(), p_decoder.column());
-							_p::Danger_Action::publicError(*p_warn._error_context).SetErrorInvalidChar('=', 0);
-							switch(p_warn.Notify())
-							{
-								case warningBehaviour::Default:
-								case warningBehaviour::Continue:
-								case warningBehaviour::Accept:
-									//Start key
-									{
-										itemProxy<keyedValue> t_item = keyedValue::make();
-										t_item->set_position(p_decoder.line(), p_decoder.column());
-										t_item->set_column_value(p_decoder.column() + 1);
-										p_root.push_back(t_item);
-										lastError = ReadKeyValue(t_flow, *t_item, p_root);
-									}
-									break;
-								case warningBehaviour::Discard:
-									lastError = static_cast<Error>(p_decoder.get_char().error_code());
-									break;
-								case warningBehaviour::Abort:
-								default:
-									return;
-							}
-							break;
-						case ':':
-							_p::Danger_Action::publicError(*p_warn._error_context).set_position(p_decoder.line(), p_decoder.column());
-							_p::Danger_Action::publicError(*p_warn._error_context).SetErrorInvalidChar(':', 0);
-							switch(p_warn.Notify())
-							{
-								case warningBehaviour::Default:
-								case warningBehaviour::Continue:
-								case warningBehaviour::Accept:
-								case warningBehaviour::Discard:
-									lastError = static_cast<Error>(p_decoder.get_char().error_code());
-									break;
-								case warningBehaviour::Abort:
-								default:
-									return;
-							}
-							break;
-						case '>':
-							_p::Danger_Action::publicError(*p_warn._error_context).set_position(p_decoder.line(), p_decoder.column());
-							_p::Danger_Action::publicError(*p_warn._error_context).SetErrorInvalidChar('>', 0);
-							switch(p_warn.Notify())
-							{
-								case warningBehaviour::Continue:
-								case warningBehaviour::Accept:
-								case warningBehaviour::Discard:
-									lastError = static_cast<Error>(p_decoder.get_char().error_code());
-									break;
-								case warningBehaviour::Default:
-								case warningBehaviour::Abort:
-								default:
-									return;
-							}
-							break;
-						default:
-							if(_p::is_space(lastChar)) //spaces
-							{
-								//Start spacing
-								if(t_flow.m_skipSpaces)
+						switch(twarn.Notify())
+						{
+							case warningBehaviour::Default:
+							case warningBehaviour::Continue:
+							case warningBehaviour::Discard:
+								lastError = static_cast<Error>(decoder.get_char().error_code());
+								break;
+							case warningBehaviour::Accept:
+								//Add Ghost singlet
 								{
-									lastError = ReadSpaceSkip(t_flow);
+									itemProxy<singlet> t_item = make_item<singlet>(p_flow);
+									t_item->set_position(decoder.line(), decoder.column());
+									p_list.push_back(t_item);
 								}
-								else
+								lastError = static_cast<Error>(decoder.get_char().error_code());
+								break;
+							case warningBehaviour::Abort:
+							default:
+								lastError = Error::InvalidChar;
+								return Step::Stop;
+						}
+						break;
+					case '=':
+						_p::Danger_Action::publicError(*twarn._error_context).set_position(decoder.line(), decoder.column());
+						_p::Danger_Action::publicError(*twarn._error_context).SetErrorInvalidChar('=', 0);
+						switch(twarn.Notify())
+						{
+							case warningBehaviour::Default:
+							case warningBehaviour::Continue:
+							case warningBehaviour::Accept:
+								//Start key
 								{
-									itemProxy<spacer> t_item = spacer::make();
-									p_root.push_back(t_item);
-									lastError = ReadSpace(t_flow, *t_item);
+									itemProxy<keyedValue> t_item = make_item<keyedValue>(p_flow);
+									t_item->set_position(decoder.line(), decoder.column());
+									t_item->set_column_value(decoder.column() + 1);
+									p_list.push_back(t_item);
+									lastError = ReadKeyValue(p_flow, *t_item, p_list);
 								}
-							}
-							else if(is_dangerCodepoint(lastChar))
+								break;
+							case warningBehaviour::Discard:
+								lastError = static_cast<Error>(decoder.get_char().error_code());
+								break;
+							case warningBehaviour::Abort:
+							default:
+								lastError = Error::InvalidChar;
+								return Step::Stop;
+						}
+						break;
+					case ':':
+						_p::Danger_Action::publicError(*twarn._error_context).set_position(decoder.line(), decoder.column());
+						_p::Danger_Action::publicError(*twarn._error_context).SetErrorInvalidChar(':', 0);
+						switch(twarn.Notify())
+						{
+							case warningBehaviour::Default:
+							case warningBehaviour::Continue:
+							case warningBehaviour::Accept:
+							case warningBehaviour::Discard:
+								lastError = static_cast<Error>(decoder.get_char().error_code());
+								break;
+							case warningBehaviour::Abort:
+							default:
+								lastError = Error::InvalidChar;
+								return Step::Stop;
+						}
+						break;
+					case '>':
+						_p::Danger_Action::publicError(*twarn._error_context).set_position(decoder.line(), decoder.column());
+						_p::Danger_Action::publicError(*twarn._error_context).SetErrorInvalidChar('>', 0);
+						switch(twarn.Notify())
+						{
+							case warningBehaviour::Continue:
+							case warningBehaviour::Accept:
+							case warningBehaviour::Discard:
+								lastError = static_cast<Error>(decoder.get_char().error_code());
+								break;
+							case warningBehaviour::Default:
+							case warningBehaviour::Abort:
+							default:
+								lastError = Error::InvalidChar;
+								return Step::Stop;
+						}
+						break;
+					default:
+						if(_p::is_space(lastChar)) //spaces
+						{
+							//Start spacing
+							if(p_flow.m_skipSpaces)
 							{
-								_p::Danger_Action::publicError(*p_warn._error_context).set_position(p_decoder.line(), p_decoder.column());
-								_p::Danger_Action::publicError(*p_warn._error_context).SetPlainError(Error::BadFormat);
+								lastError = ReadSpaceSkip(p_flow);
 							}
 							else
 							{
-								lastError = ReadTValue(t_flow, p_root);
+								itemProxy<spacer> t_item = make_item<spacer>(p_flow);
+								p_list.push_back(t_item);
+								lastError = ReadSpace(p_flow, *t_item);
 							}
-						break;
-					}
+						}
+						else if(is_dangerCodepoint(lastChar))
+						{
+							_p::Danger_Action::publicError(*twarn._error_context).set_position(decoder.line(), decoder.column());
+							_p::Danger_Action::publicError(*twarn._error_context).SetPlainError(Error::BadFormat);
+							lastError = Error::BadFormat;
+							return Step::Stop;
+						}
+						else
+						{
+							lastError = ReadTValue(p_flow, p_list);
+						}
+					break;
 				}
+			}
+			break;
+		case Error::Control_EndOfStream:
+			twarn._error_context->clear();
+			_p::Danger_Action::publicError(*twarn._error_context).set_position(decoder.line(), decoder.column() + 1);
+			return Step::Stop;
+		default:
+			_p::Danger_Action::publicError(*twarn._error_context).SetPlainError(lastError);
+			return Step::Stop;
+	}
+	return Step::Continue;
+}
+
+//Moves past the end of the group whose body starts at p_lastError, only following its structure.
+//Nothing is built, and only warnings that change the structure (premature endings) are raised.
+//If p_deferred, the body is read later on and raises them itself, with the positions a full read has.
+//Returns Step::Close or Step::Stop
+template<typename Decoder>
+static Step SkipGroup(ReaderFlow<Decoder>& p_flow, Error& p_lastError, bool p_deferred)
+{
+	_Warning_Def& twarn = p_flow.m_warnDef;
+	Decoder& decoder = p_flow.m_decoder;
+	Error& lastError = p_lastError;
+
+	//a nested group's header, where the group is already counted in t_depth
+	enum class Header: uint8_t
+	{
+		none,
+		pre,
+		name,
+		post,
+	};
+
+	uintptr_t t_depth = 1;
+	Header t_header = Header::none;
+
+	do
+	{
+		switch(lastError)
+		{
+			case Error::None:
 				break;
 			case Error::Control_EndOfStream:
-				p_warn._error_context->clear();
-				_p::Danger_Action::publicError(*p_warn._error_context).set_position(p_decoder.line(), p_decoder.column() + 1);
-				return;
+				if(p_deferred) return Step::Close;
+				for(; t_depth; --t_depth)
+				{
+					_p::Danger_Action::publicError(*twarn._error_context).set_position(decoder.line(), decoder.column() + 1);
+					_p::Danger_Action::publicError(*twarn._error_context).SetErrorPrematureEnding('>');
+					switch(twarn.Notify())
+					{
+						case warningBehaviour::Continue:
+						case warningBehaviour::Discard:
+						case warningBehaviour::Accept:
+							break;
+						case warningBehaviour::Default:
+						case warningBehaviour::Abort:
+						default:
+							lastError = Error::PrematureEnd;
+							return Step::Stop;
+					}
+				}
+				return Step::Close;
 			default:
-				_p::Danger_Action::publicError(*p_warn._error_context).SetPlainError(lastError);
-				return;
+				return Step::Stop;
+		}
+
+		char32_t tchar = decoder.lastChar();
+		if(t_header == Header::post)
+		{
+			//after the spacing, anything but ':' starts the body
+			if(_p::is_space_noLF(tchar))
+			{
+				lastError = static_cast<Error>(decoder.get_char().error_code());
+				continue;
+			}
+			t_header = Header::none;
+			if(tchar == ':')
+			{
+				lastError = static_cast<Error>(decoder.get_char().error_code());
+				continue;
+			}
+			if(!is_badCodePoint(tchar)) continue;
+		}
+		else if(t_header != Header::none)
+		{
+			switch(tchar)
+			{
+				case ',':
+				case ';':
+					//after a name, the character that follows is dropped as well
+					if(t_header == Header::name)
+					{
+						lastError = static_cast<Error>(decoder.get_char().error_code());
+						if(lastError != Error::None)
+						{
+							t_header = Header::none;
+							continue;
+						}
+					}
+					[[fallthrough]];
+				case ':':
+					t_header = Header::none;
+					lastError = static_cast<Error>(decoder.get_char().error_code());
+					continue;
+				case '\n':
+				case '=':
+				case '<':
+				case '#':
+					t_header = Header::none;
+					continue;
+				case '>':
+					//the group ends without a body, and the same '>' ends its parent as well
+					t_header = Header::none;
+					--t_depth;
+					continue;
+				default:
+					if(_p::is_space_noLF(tchar))
+					{
+						if(t_header == Header::name) t_header = Header::post;
+						lastError = static_cast<Error>(decoder.get_char().error_code());
+						continue;
+					}
+					//the name ends on spacing or on one of the cases above, same as ReadName
+					if(t_header == Header::pre && !is_dangerCodepoint(tchar))
+					{
+						t_header = Header::name;
+						lastError = ReadTrashSequence(p_flow);
+						continue;
+					}
+					break;
+			}
+		}
+		else
+		{
+			switch(tchar)
+			{
+				case '<':
+					++t_depth;
+					t_header = Header::pre;
+					lastError = static_cast<Error>(decoder.get_char().error_code());
+					continue;
+				case '>':
+					lastError = static_cast<Error>(decoder.get_char().error_code());
+					if(--t_depth == 0) return Step::Close;
+					continue;
+				case '#':
+					lastError = ReadCommentSkip(p_flow);
+					continue;
+				default:
+					if(class_skipBetween.contains(tchar))
+					{
+						lastError = static_cast<Error>(decoder.read_span(class_skipBetween, nullptr, nullptr));
+						continue;
+					}
+					//names and values, danger codepoints are only taken in when merged into one
+					if(!is_dangerCodepoint(tchar))
+					{
+						lastError = ReadTrashSequence(p_flow);
+						continue;
+					}
+					break;
+			}
+		}
+
+		_p::Danger_Action::publicError(*twarn._error_context).set_position(decoder.line(), decoder.column());
+		_p::Danger_Action::publicError(*twarn._error_context).SetPlainError(Error::BadFormat);
+		lastError = Error::BadFormat;
+		return Step::Stop;
+	} while(true);
+}
+
+//keeps only the items selected by a path_filter, one level per open group
+class ItemFilter
+{
+public:
+	ItemFilter(const path_filter* p_filter)
+		: m_filter(p_filter)
+	{
+		if(m_filter) m_levels.push_back({0});
+	}
+
+	//p_group's body is about to be read, false if it is not selected
+	bool open(const group& p_group)
+	{
+		if(!m_filter) return true;
+		if(m_levels.back().empty())
+		{
+			m_levels.emplace_back();
+			return true;
+		}
+		switch(m_filter->find(m_levels.back(), name_of(p_group), m_next))
+		{
+			case path_filter::match::whole:
+				m_levels.emplace_back();
+				return true;
+			case path_filter::match::partial:
+				m_levels.push_back(m_next);
+				return true;
+			default:
+				break;
+		}
+		return false;
+	}
+
+	void close()
+	{
+		if(m_filter) m_levels.pop_back();
+	}
+
+	//everything in the innermost open group is kept
+	[[nodiscard]] bool whole() const
+	{
+		return !m_filter || m_levels.back().empty();
+	}
+
+	//drops what is not selected among the items read into p_list since p_from
+	void trim(ItemList& p_list, uintptr_t p_from, _p::_Error_Context& p_context)
+	{
+		if(whole()) return;
+
+		ItemList::iterator t_keep = p_list.begin() + p_from;
+		for(ItemList::iterator it = t_keep; it != p_list.end(); ++it)
+		{
+			path_filter::match t_match = path_filter::match::none;
+			switch((*it)->type())
+			{
+				case ItemType::group:
+					t_match = m_filter->find(m_levels.back(), name_of(static_cast<const group&>(**it)), m_next);
+					break;
+				case ItemType::key_value:
+					t_match = m_filter->find(m_levels.back(), name_of(static_cast<const keyedValue&>(**it)), m_next);
+					if(t_match != path_filter::match::whole) t_match = path_filter::match::none;
+					break;
+				case ItemType::singlet:
+					t_match = m_filter->find(m_levels.back(), name_of(static_cast<const singlet&>(**it)), m_next);
+					if(t_match != path_filter::match::whole) t_match = path_filter::match::none;
+					break;
+				default:
+					break;
+			}
+
+			if(t_match != path_filter::match::none)
+			{
+				if(t_keep != it) *t_keep = std::move(*it);
+				++t_keep;
+			}
+			else if(p_context.m_criticalItem == it->get())
+			{
+				p_context.m_criticalItem = nullptr;
+			}
+		}
+		p_list.erase(t_keep, p_list.end());
+	}
+
+private:
+	//names kept as UTF-8 are matched through m_name
+	std::u32string_view name_of(const _p::NamedItem& p_item)
+	{
+		if(!p_item.utf8()) return p_item.view_name();
+		_p::decode_item_text(p_item.view_name_u8(), m_name);
+		return m_name;
+	}
+
+	const path_filter*					m_filter;
+	std::vector<std::vector<uint32_t>>	m_levels;	//nodes matched by each open group, empty if the group is kept whole
+	std::vector<uint32_t>				m_next;
+	std::u32string					m_name;
+};
+
+//reads items into p_top until the document ends
+//if p_top is not the root, it is a group whose header was read, and reading stops once it closes
+//returns the last error, as it was when reading stopped
+template<typename Decoder>
+static Error ReadItems(ReaderFlow<Decoder>& p_flow, ItemList& p_top, bool p_isRoot, Error p_lastError, const load_options& p_options)
+{
+	_p::_Error_Context& t_context = _p::Danger_Action::publicError(*p_flow.m_warnDef._error_context);
+	event_handler* const t_handler = p_options.handler;
+	Error& lastError = p_lastError;
+
+	//groups being read, innermost last
+	//kept on the heap so that nesting is not bounded by the thread's stack
+	std::vector<itemProxy<group>> t_open;
+	ItemFilter t_filter{p_options.filter};
+
+	do
+	{
+		ItemList& t_list = t_open.empty() ? p_top : *t_open.back();
+		const uintptr_t t_from = t_list.size();
+		switch(t_open.empty() && p_isRoot ? StepRoot(p_flow, t_list, lastError) : StepGroup(p_flow, t_list, lastError))
+		{
+			case Step::Open:
+				{
+					itemProxy<group> t_child = std::static_pointer_cast<group>(t_list.back());
+					if(!t_filter.open(*t_child))
+					{
+						//not selected, the body is only scanned for where it ends
+						t_list.pop_back();
+						SkipGroup(p_flow, lastError, false);
+						continue;
+					}
+					if(p_options.defer && t_filter.whole() && lastError == Error::None)
+					{
+						//the body is read on expand, for now only where it ends is needed
+						t_filter.close();
+						const stream_decoder::mark_t t_mark = p_flow.m_decoder.mark();
+						_p::Danger_Action::deferred(*t_child) = {p_options.defer, t_mark.offset, t_mark.count, t_mark.line, t_mark.column};
+						t_context.m_criticalItem = nullptr;
+						SkipGroup(p_flow, lastError, true);
+						continue;
+					}
+					//reported as it is read, not as an item
+					if(t_handler) t_list.pop_back();
+					t_context.m_stack.push_back(t_child.get());
+					t_context.m_criticalItem = nullptr;
+					if(t_handler) t_handler->on_group_begin(*t_child);
+					t_open.push_back(std::move(t_child));
+				}
+				continue;
+			case Step::Close:
+				t_context.m_stack.pop_back();
+				if(t_open.empty()) return lastError;
+				if(t_handler)
+				{
+					t_handler->on_group_end(*t_open.back());
+					p_flow.recycle(std::move(t_open.back()));
+				}
+				t_open.pop_back();
+				t_filter.close();
+				break;
+			case Step::Stop:
+				if(t_open.empty()) return lastError;
+				//unwinds one group at a time, each one stopping on lastError until the top does
+				t_open.pop_back();
+				t_filter.close();
+				break;
+			default:
+				t_filter.trim(t_list, t_from, t_context);
+				break;
+		}
+		if(t_handler && (lastError == Error::None || lastError == Error::Control_EndOfStream))
+		{
+			p_flow.deliver(t_open.empty() ? p_top : *t_open.back());
 		}
 	}
 	while(true);
 }
 
+template<typename Decoder>
+void load(root& p_root, stream_decoder& p_decoder, Flag p_flags, [[maybe_unused]] uint16_t p_detected_version, _Warning_Def& p_warn, const load_options& p_options)
+{
+	ReaderFlow<Decoder> t_flow(static_cast<Decoder&>(p_decoder), p_warn);
+
+	t_flow.m_handler		= p_options.handler;
+	t_flow.m_arena			= p_options.arena;
+	t_flow.m_symbols		= p_options.symbols;
+
+	t_flow.m_skipSpaces		= (p_flags & Flag::DisableSpacers) != Flag{};
+	t_flow.m_skipComments	= (p_flags & Flag::DisableComments) != Flag{};
+	t_flow.m_utf8			= (p_flags & Flag::Utf8Text) != Flag{};
+	t_flow.m_decoder.use_span_index((p_flags & Flag::IndexedSpans) != Flag{});
+
+	_p::Danger_Action::publicError(*p_warn._error_context).m_criticalItem = nullptr;
+
+	ReadItems(t_flow, p_root, true, static_cast<Error>(t_flow.m_decoder.get_char().error_code()), p_options);
+
+	if(p_options.handler)
+	{
+		//whatever is left was never reported, the error context can not point to it either
+		p_root.clear();
+		_p::Danger_Action::publicError(*p_warn._error_context).m_stack.clear();
+		_p::Danger_Action::publicError(*p_warn._error_context).m_criticalItem = nullptr;
+	}
+}
+
+template<typename Decoder>
+void expand(group& p_group, stream_decoder& p_decoder, Flag p_flags, _Warning_Def& p_warn, uint64_t p_source, const std::shared_ptr<std::pmr::memory_resource>& p_arena, _p::symbol_table* p_symbols)
+{
+	ReaderFlow<Decoder> t_flow(static_cast<Decoder&>(p_decoder), p_warn);
+
+	t_flow.m_arena			= p_arena;
+	t_flow.m_symbols		= p_symbols;
+
+	t_flow.m_skipSpaces		= (p_flags & Flag::DisableSpacers) != Flag{};
+	t_flow.m_skipComments	= (p_flags & Flag::DisableComments) != Flag{};
+	t_flow.m_utf8			= (p_flags & Flag::Utf8Text) != Flag{};
+	t_flow.m_decoder.use_span_index((p_flags & Flag::IndexedSpans) != Flag{});
+
+	_p::deferred_body& t_body = _p::Danger_Action::deferred(p_group);
+	const stream_decoder::mark_t t_mark{t_body.offset, t_body.count, t_body.line, t_body.column};
+	//the body is read now, as far as it goes
+	t_body = {};
+
+	_p::_Error_Context& t_context = _p::Danger_Action::publicError(*p_warn._error_context);
+	t_context.m_stack.push_back(&p_group);
+	t_context.m_criticalItem = nullptr;
+
+	load_options t_options;
+	t_options.defer		= p_source;
+	t_options.arena		= p_arena;
+	t_options.symbols	= p_symbols;
+	Error lastError = static_cast<Error>(t_flow.m_decoder.resume(t_mark));
+	lastError = ReadItems(t_flow, p_group, false, lastError, t_options);
+
+	//reported as the top of the document would
+	if(lastError == Error::None || lastError == Error::Control_EndOfStream)
+	{
+		t_context.clear();
+	}
+	else
+	{
+		t_context.SetPlainError(lastError);
+	}
+}
+
+template void load<ENCODER_P::Stream_ANSI_Decoder>		(root&, stream_decoder&, Flag, uint16_t, _Warning_Def&, const load_options&);
+template void load<ENCODER_P::Stream_UTF8_Decoder>		(root&, stream_decoder&, Flag, uint16_t, _Warning_Def&, const load_options&);
+template void load<ENCODER_P::Stream_UTF8_Decoder_s>	(root&, stream_decoder&, Flag, uint16_t, _Warning_Def&, const load_options&);
+template void load<ENCODER_P::Stream_UTF16LE_Decoder>	(root&, stream_decoder&, Flag, uint16_t, _Warning_Def&, const load_options&);
+template void load<ENCODER_P::Stream_UTF16BE_Decoder>	(root&, stream_decoder&, Flag, uint16_t, _Warning_Def&, const load_options&);
+template void load<ENCODER_P::Stream_UCS4LE_Decoder>	(root&, stream_decoder&, Flag, uint16_t, _Warning_Def&, const load_options&);
+template void load<ENCODER_P::Stream_UCS4LE_Decoder_s>	(root&, stream_decoder&, Flag, uint16_t, _Warning_Def&, const load_options&);
+template void load<ENCODER_P::Stream_UCS4BE_Decoder>	(root&, stream_decoder&, Flag, uint16_t, _Warning_Def&, const load_options&);
+template void load<ENCODER_P::Stream_UCS4BE_Decoder_s>	(root&, stream_decoder&, Flag, uint16_t, _Warning_Def&, const load_options&);
+
+template void expand<ENCODER_P::Stream_ANSI_Decoder>		(group&, stream_decoder&, Flag, _Warning_Def&, uint64_t, const std::shared_ptr<std::pmr::memory_resource>&, _p::symbol_table*);
+template void expand<ENCODER_P::Stream_UTF8_Decoder>		(group&, stream_decoder&, Flag, _Warning_Def&, uint64_t, const std::shared_ptr<std::pmr::memory_resource>&, _p::symbol_table*);
+template void expand<ENCODER_P::Stream_UTF8_Decoder_s>		(group&, stream_decoder&, Flag, _Warning_Def&, uint64_t, const std::shared_ptr<std::pmr::memory_resource>&, _p::symbol_table*);
+template void expand<ENCODER_P::Stream_UTF16LE_Decoder>		(group&, stream_decoder&, Flag, _Warning_Def&, uint64_t, const std::shared_ptr<std::pmr::memory_resource>&, _p::symbol_table*);
+template void expand<ENCODER_P::Stream_UTF16BE_Decoder>		(group&, stream_decoder&, Flag, _Warning_Def&, uint64_t, const std::shared_ptr<std::pmr::memory_resource>&, _p::symbol_table*);
+template void expand<ENCODER_P::Stream_UCS4LE_Decoder>		(group&, stream_decoder&, Flag, _Warning_Def&, uint64_t, const std::shared_ptr<std::pmr::memory_resource>&, _p::symbol_table*);
+template void expand<ENCODER_P::Stream_UCS4LE_Decoder_s>	(group&, stream_decoder&, Flag, _Warning_Def&, uint64_t, const std::shared_ptr<std::pmr::memory_resource>&, _p::symbol_table*);
+template void expand<ENCODER_P::Stream_UCS4BE_Decoder>		(group&, stream_decoder&, Flag, _Warning_Def&, uint64_t, const std::shared_ptr<std::pmr::memory_resource>&, _p::symbol_table*);
+template void expand<ENCODER_P::Stream_UCS4BE_Decoder_s>	(group&, stream_decoder&, Flag, _Warning_Def&, uint64_t, const std::shared_ptr<std::pmr::memory_resource>&, _p::symbol_table*);
+
+//======== ======== ======== ======== Cursor ======== ======== ======== ========
+
+template<typename Decoder>
+class cursor_t final: public cursor
+{
+public:
+	cursor_t(std::unique_ptr<stream_decoder> p_decoder, Flag p_flags, const _Warning_Def& p_warn)
+		: m_decoder(std::move(p_decoder))
+		, m_warn(p_warn)
+		, m_flow(static_cast<Decoder&>(*m_decoder), m_warn)
+	{
+		m_flow.m_skipSpaces		= (p_flags & Flag::DisableSpacers) != Flag{};
+		m_flow.m_skipComments	= (p_flags & Flag::DisableComments) != Flag{};
+		m_flow.m_decoder.use_span_index((p_flags & Flag::IndexedSpans) != Flag{});
+	}
+
+	bool next() override;
+	bool skip_group() override;
+
+private:
+	bool set_current(const itemProxy<item>& p_item);
+	bool apply(Step p_step);
+
+	std::unique_ptr<stream_decoder>	m_decoder;
+	_Warning_Def					m_warn;
+	ReaderFlow<Decoder>				m_flow;
+	ItemList						m_list;				//items read by the last step
+	uintptr_t						m_index = 0;		//position of the current item in m_list
+	std::vector<itemProxy<group>>	m_open;				//groups whose body is being read
+	itemProxy<group>				m_closed;			//the group just closed, while it is current
+	Error							m_lastError = Error::None;
+	bool							m_started	= false;
+	bool							m_bodyless	= false;	//the current group ended in its header, its end comes next
+};
+
+template<typename Decoder>
+bool cursor_t<Decoder>::set_current(const itemProxy<item>& p_item)
+{
+	m_item	= p_item.get();
+	m_depth	= m_open.size();
+	switch(p_item->type())
+	{
+		case ItemType::group:
+			m_kind		= reader::token::group_begin;
+			m_bodyless	= true;
+			break;
+		case ItemType::key_value:
+			m_kind = reader::token::key_value;
+			break;
+		case ItemType::singlet:
+			m_kind = reader::token::singlet;
+			break;
+		case ItemType::comment:
+			m_kind = reader::token::comment;
+			break;
+		default:
+			m_kind = reader::token::spacer;
+			break;
+	}
+	return true;
+}
+
+template<typename Decoder>
+bool cursor_t<Decoder>::apply(Step p_step)
+{
+	_p::_Error_Context& t_context = _p::Danger_Action::publicError(*m_warn._error_context);
+	switch(p_step)
+	{
+		case Step::Open:
+			m_open.push_back(std::static_pointer_cast<group>(m_list.back()));
+			m_list.pop_back();
+			t_context.m_stack.push_back(m_open.back().get());
+			t_context.m_criticalItem = nullptr;
+			m_kind	= reader::token::group_begin;
+			m_item	= m_open.back().get();
+			m_depth	= m_open.size() - 1;
+			return true;
+		case Step::Close:
+			t_context.m_stack.pop_back();
+			m_closed = std::move(m_open.back());
+			m_open.pop_back();
+			m_kind	= reader::token::group_end;
+			m_item	= m_closed.get();
+			m_depth	= m_open.size();
+			return true;
+		case Step::Stop:
+			//an error inside a group ends the document just as it would at the top
+			if(!m_open.empty()) t_context.SetPlainError(m_lastError);
+			m_kind	= reader::token::end;
+			m_item	= nullptr;
+			m_depth	= 0;
+			return false;
+		default:
+			break;
+	}
+	return true;
+}
+
+template<typename Decoder>
+bool cursor_t<Decoder>::next()
+{
+	if(m_kind == reader::token::end) return false;
+
+	if(m_bodyless)
+	{
+		m_bodyless	= false;
+		m_kind		= reader::token::group_end;
+		return true;
+	}
+
+	if(++m_index < m_list.size()) return set_current(m_list[m_index]);
+
+	//the items read before are no longer current, they are made again for the next ones
+	m_flow.recycle(m_list);
+	m_index = 0;
+	if(m_closed) m_flow.recycle(std::move(m_closed));
+
+	if(!m_started)
+	{
+		m_started = true;
+		m_lastError = static_cast<Error>(m_flow.m_decoder.get_char().error_code());
+		_p::Danger_Action::publicError(*m_warn._error_context).m_criticalItem = nullptr;
+	}
+
+	do
+	{
+		Step t_step = m_open.empty() ? StepRoot(m_flow, m_list, m_lastError) : StepGroup(m_flow, m_list, m_lastError);
+		if(t_step != Step::Continue) return apply(t_step);
+
+		if(m_list.empty()) continue;
+		if(m_lastError == Error::None || m_lastError == Error::Control_EndOfStream) return set_current(m_list.front());
+		//the items are incomplete, and reading stops on the next step
+		m_flow.recycle(m_list);
+	} while(true);
+}
+
+template<typename Decoder>
+bool cursor_t<Decoder>::skip_group()
+{
+	if(m_kind != reader::token::group_begin) return false;
+	if(m_bodyless) return next();
+
+	m_flow.recycle(m_list);
+	m_index = 0;
+	return apply(SkipGroup(m_flow, m_lastError, false));
+}
+
+template<typename Decoder>
+std::unique_ptr<cursor> make_cursor(std::unique_ptr<stream_decoder> p_decoder, Flag p_flags, const _Warning_Def& p_warn)
+{
+	return std::make_unique<cursor_t<Decoder>>(std::move(p_decoder), p_flags, p_warn);
+}
+
+template std::unique_ptr<cursor> make_cursor<ENCODER_P::Stream_ANSI_Decoder>		(std::unique_ptr<stream_decoder>, Flag, const _Warning_Def&);
+template std::unique_ptr<cursor> make_cursor<ENCODER_P::Stream_UTF8_Decoder>		(std::unique_ptr<stream_decoder>, Flag, const _Warning_Def&);
+template std::unique_ptr<cursor> make_cursor<ENCODER_P::Stream_UTF8_Decoder_s>	(std::unique_ptr<stream_decoder>, Flag, const _Warning_Def&);
+template std::unique_ptr<cursor> make_cursor<ENCODER_P::Stream_UTF16LE_Decoder>	(std::unique_ptr<stream_decoder>, Flag, const _Warning_Def&);
+template std::unique_ptr<cursor> make_cursor<ENCODER_P::Stream_UTF16BE_Decoder>	(std::unique_ptr<stream_decoder>, Flag, const _Warning_Def&);
+template std::unique_ptr<cursor> make_cursor<ENCODER_P::Stream_UCS4LE_Decoder>	(std::unique_ptr<stream_decoder>, Flag, const _Warning_Def&);
+template std::unique_ptr<cursor> make_cursor<ENCODER_P::Stream_UCS4LE_Decoder_s>	(std::unique_ptr<stream_decoder>, Flag, const _Warning_Def&);
+template std::unique_ptr<cursor> make_cursor<ENCODER_P::Stream_UCS4BE_Decoder>	(std::unique_ptr<stream_decoder>, Flag, const _Warning_Def&);
+template std::unique_ptr<cursor> make_cursor<ENCODER_P::Stream_UCS4BE_Decoder_s>	(std::unique_ptr<stream_decoder>, Flag, const _Warning_Def&);
+
 
 //======== ======== ======== ======== Writting ======== ======== ======== ======== 
 
 struct WriterFlow;
 
-using WriterList = bool (*)(WriterFlow&, const ItemList&, uint8_t);
+//a list of items being written, and where to resume it once the group it stepped into is closed
+struct WriterFrame
+{
+	WriterFrame(const ItemList& p_list, const group* p_group, uint8_t p_level):
+		m_group(p_group),
+		m_it(p_list.cbegin()),
+		m_end(p_list.cend()),
+		m_level(p_level)
+	{
+	}
+	const group*				m_group;		//nullptr for the root
+	const group*				m_child		= nullptr;	//set when the step returns Step::Open
+	ItemList::const_iterator	m_it;
+	ItemList::const_iterator	m_end;
+	uint64_t					m_lastLine		= 0;
+	uint8_t						m_level;
+	bool						m_hasItem		= false;
+	bool						m_lastRelevant	= false;
+};
+
+//writes p_frame until a group is opened (Step::Open), the list ends (Step::Close) or writing fails (Step::Stop)
+using WriterList = Step (*)(WriterFlow&, WriterFrame&);
 
 struct WriterFlow
 {
@@ -1965,8 +2666,32 @@ struct WriterFlow
 	_Warning_Def&	m_warnDef;
 	WriterList		m_listWriter;
 	bool			m_autoQuote;
+	std::u32string	m_name;		//text of items kept as UTF-8, see NameText
+	std::u32string	m_value;
 };
 
+//the text of an item as written, items kept as UTF-8 are decoded into the flow first
+static inline std::u32string_view NameText(WriterFlow& p_flow, const _p::NamedItem& p_item)
+{
+	if(!p_item.utf8()) return p_item.view_name();
+	_p::decode_item_text(p_item.view_name_u8(), p_flow.m_name);
+	return p_flow.m_name;
+}
+
+static inline std::u32string_view ValueText(WriterFlow& p_flow, const keyedValue& p_key)
+{
+	if(!p_key.value_utf8()) return p_key.view_value();
+	_p::decode_item_text(p_key.view_value_u8(), p_flow.m_value);
+	return p_flow.m_value;
+}
+
+static inline std::u32string_view CommentText(WriterFlow& p_flow, const comment& p_comment)
+{
+	if(!p_comment.utf8()) return p_comment.view();
+	_p::decode_item_text(p_comment.view_u8(), p_flow.m_value);
+	return p_flow.m_value;
+}
+
 static inline constexpr bool CharNeedsEscape(char32_t p_char)
 {
 	if(p_char < 36)
@@ -2265,7 +2990,7 @@ static inline bool WriteAutoTabulation(WriterFlow& p_flow, uint8_t p_level)
 
 static inline bool WriteComment(WriterFlow& p_flow, const comment& p_comment)
 {
-	std::u32string_view str = p_comment.str();
+	std::u32string_view str = CommentText(p_flow, p_comment);
 	size_t pos = str.find(U'\n');
 	if(pos != std::u32string_view::npos)
 	{
@@ -2299,28 +3024,20 @@ static inline bool WriteComment(WriterFlow& p_flow, const comment& p_comment)
 }
 
 
-static bool WriteGroupDefault(WriterFlow& p_flow, const group& p_group, uint8_t p_level)
+//the body and the closing of a group are written by save, once its header is out
+static bool WriteGroupDefault(WriterFlow& p_flow, const group& p_group, uint8_t /*p_level*/)
 {
 	_p::Danger_Action::publicError(*p_flow.m_warnDef._error_context).m_criticalItem = &p_group;
 
 	if(	!WriteControl(p_flow, u8'<')	|| //open group
 		!WriteSpacing(p_flow, p_group.m_preSpace) ||
-		!WriteNameOpional(p_flow, p_group.view_name(), p_group.quotation_mode()) ||
+		!WriteNameOpional(p_flow, NameText(p_flow, p_group), p_group.quotation_mode()) ||
 		!WriteSpacing(p_flow, p_group.m_postSpace) ||
 		!WriteControl(p_flow, u8':') //close header
 		) return false;
 
 	_p::Danger_Action::publicError(*p_flow.m_warnDef._error_context).m_stack.push_back(&p_group);
-
-	//write body
-	if(p_level < MAX_LEVEL) ++p_level;
-	if(!p_flow.m_listWriter(p_flow, p_group, p_level)) return false;
-
-	_p::Danger_Action::publicError(*p_flow.m_warnDef._error_context).m_stack.pop_back();
-	_p::Danger_Action::publicError(*p_flow.m_warnDef._error_context).m_criticalItem = &p_group;
-
-	//close object
-	return WriteControl(p_flow, u8'>');
+	return true;
 }
 
 static bool WriteGroupAutoSpace(WriterFlow& p_flow, const group& p_group, uint8_t p_level)
@@ -2329,38 +3046,29 @@ static bool WriteGroupAutoSpace(WriterFlow& p_flow, const group& p_group, uint8_
 
 	if(	!WriteAutoTabulation(p_flow, p_level) ||
 		!WriteControl(p_flow, u8'<') || 	//open group
-		!WriteNameOpional(p_flow, p_group.view_name(), p_group.quotation_mode()) ||
+		!WriteNameOpional(p_flow, NameText(p_flow, p_group), p_group.quotation_mode()) ||
 		!WriteControl(p_flow, u8':') //close header
 		) return false;
 
 	_p::Danger_Action::publicError(*p_flow.m_warnDef._error_context).m_stack.push_back(&p_group);
-
-	//write body
-	if(p_level < MAX_LEVEL) ++p_level;
-	if(!p_flow.m_listWriter(p_flow, p_group, p_level)) return false;
-
-	_p::Danger_Action::publicError(*p_flow.m_warnDef._error_context).m_stack.pop_back();
-	_p::Danger_Action::publicError(*p_flow.m_warnDef._error_context).m_criticalItem = &p_group;
-
-	//close group
-	return WriteControl(p_flow, u8'>');
+	return true;
 }
 
-static bool WriteGroupNoSpace(WriterFlow& p_flow, const group& p_group, uint8_t p_level)
+static bool WriteGroupNoSpace(WriterFlow& p_flow, const group& p_group, uint8_t /*p_level*/)
 {
 	_p::Danger_Action::publicError(*p_flow.m_warnDef._error_context).m_criticalItem = &p_group;
 
 	if(	!WriteControl(p_flow, u8'<') || //open group
-		!WriteNameOpional(p_flow, p_group.view_name(), p_group.quotation_mode()) ||
+		!WriteNameOpional(p_flow, NameText(p_flow, p_group), p_group.quotation_mode()) ||
 		!WriteControl(p_flow, u8':') //close header
 		) return false;
 
 	_p::Danger_Action::publicError(*p_flow.m_warnDef._error_context).m_stack.push_back(&p_group);
+	return true;
+}
 
-	//write body
-	if(p_level < MAX_LEVEL) ++p_level;
-	if(!p_flow.m_listWriter(p_flow, p_group, p_level)) return false;
-	
+static bool WriteGroupEnd(WriterFlow& p_flow, const group& p_group)
+{
 	_p::Danger_Action::publicError(*p_flow.m_warnDef._error_context).m_stack.pop_back();
 	_p::Danger_Action::publicError(*p_flow.m_warnDef._error_context).m_criticalItem = &p_group;
 
@@ -2375,17 +3083,17 @@ static bool WriteKeyValueDefault(WriterFlow& p_flow, const keyedValue& p_key, ui
 	//Key name
 	if(p_flow.m_autoQuote)
 	{
-		if(!WriteNameAuto(p_flow, p_key.name())) return false;
+		if(!WriteNameAuto(p_flow, NameText(p_flow, p_key))) return false;
 	}
 	else
 	{
-		if(!WriteNamePrefered(p_flow, p_key.name(), p_key.quotation_mode())) return false;
+		if(!WriteNamePrefered(p_flow, NameText(p_flow, p_key), p_key.quotation_mode())) return false;
 	}
 
 	if(	!WriteSpacing(p_flow, p_key.m_preSpace) ||
 		!WriteControl(p_flow, u8'=') ||
 		!WriteSpacing(p_flow, p_key.m_midSpace) ||
-		!WriteNameOpional(p_flow, p_key.view_value(), p_key.value_quotation_mode()) ||
+		!WriteNameOpional(p_flow, ValueText(p_flow, p_key), p_key.value_quotation_mode()) ||
 		!WriteSpacing(p_flow, p_key.m_postSpace)
 		) return false;
 
@@ -2402,31 +3110,32 @@ static bool WriteKeyValueAutoSpace(WriterFlow& p_flow, const keyedValue& p_key,
 	//Key name
 	if(p_flow.m_autoQuote)
 	{
-		if(!WriteNameAuto(p_flow, p_key.name())) return false;
+		if(!WriteNameAuto(p_flow, NameText(p_flow, p_key))) return false;
 	}
 	else
 	{
-		if(!WriteNamePrefered(p_flow, p_key.name(), p_key.quotation_mode())) return false;
+		if(!WriteNamePrefered(p_flow, NameText(p_flow, p_key), p_key.quotation_mode())) return false;
 	}
 	
 	//pre-spacing and sign 
 	if(!WriteControl(p_flow, u8' ') ||
 		!WriteControl(p_flow, u8'=')) return false;
 
+	const std::u32string_view t_value = ValueText(p_flow, p_key);
 	if(p_flow.m_autoQuote)
 	{
-		if(!p_key.value().empty())
+		if(!t_value.empty())
 		{
 			if(	!WriteControl(p_flow, u8' ') ||
-				!WriteNameAuto(p_flow, p_key.view_value())
+				!WriteNameAuto(p_flow, t_value)
 				) return false;
 		}
 	}
 	else
-	{	if(!p_key.value().empty() || p_key.value_quotation_mode() != QuotationMode::standard)
+	{	if(!t_value.empty() || p_key.value_quotation_mode() != QuotationMode::standard)
 		{
 			if(	!WriteControl(p_flow, u8' ') ||
-				!WriteNamePrefered(p_flow, p_key.view_value(), p_key.value_quotation_mode())
+				!WriteNamePrefered(p_flow, t_value, p_key.value_quotation_mode())
 				) return false;
 		}
 	}
@@ -2442,15 +3151,15 @@ static bool WriteKeyValueNoSpace(WriterFlow& p_flow, const keyedValue& p_key, ui
 	//Key name
 	if(p_flow.m_autoQuote)
 	{
-		if(!WriteNameAuto(p_flow, p_key.view_name())) return false;
+		if(!WriteNameAuto(p_flow, NameText(p_flow, p_key))) return false;
 	}
 	else
 	{
-		if(!WriteNamePrefered(p_flow, p_key.view_name(), p_key.quotation_mode())) return false;
+		if(!WriteNamePrefered(p_flow, NameText(p_flow, p_key), p_key.quotation_mode())) return false;
 	}
 
 	if(	!WriteControl(p_flow, u8'=') ||
-		!WriteNameOpional(p_flow, p_key.view_value(), p_key.value_quotation_mode())
+		!WriteNameOpional(p_flow, ValueText(p_flow, p_key), p_key.value_quotation_mode())
 		) return false;
 
 	//close Key
@@ -2464,11 +3173,11 @@ static bool WriteSingletDefault(WriterFlow& p_flow, const singlet& p_singlet, ui
 	//Key name
 	if(p_flow.m_autoQuote)
 	{
-		if(!WriteNameAuto(p_flow, p_singlet.name())) return false;
+		if(!WriteNameAuto(p_flow, NameText(p_flow, p_singlet))) return false;
 	}
 	else
 	{
-		if(!WriteNamePrefered(p_flow, p_singlet.name(), p_singlet.quotation_mode())) return false;
+		if(!WriteNamePrefered(p_flow, NameText(p_flow, p_singlet), p_singlet.quotation_mode())) return false;
 	}
 
 	if(!WriteSpacing(p_flow, p_singlet.m_postSpace)) return false;
@@ -2486,11 +3195,11 @@ static bool WriteSingletAutoSpace(WriterFlow& p_flow, const singlet& p_singlet,
 	//singlet name
 	if(p_flow.m_autoQuote)
 	{
-		if(!WriteNameAuto(p_flow, p_singlet.name())) return false;
+		if(!WriteNameAuto(p_flow, NameText(p_flow, p_singlet))) return false;
 	}
 	else
 	{
-		if(!WriteNamePrefered(p_flow, p_singlet.name(), p_singlet.quotation_mode())) return false;
+		if(!WriteNamePrefered(p_flow, NameText(p_flow, p_singlet), p_singlet.quotation_mode())) return false;
 	}
 
 	//close Key
@@ -2504,11 +3213,11 @@ static bool WriteSingletNoSpace(WriterFlow& p_flow, const singlet& p_singlet, ui
 	//value singlet
 	if(p_flow.m_autoQuote)
 	{
-		if(!WriteNameAuto(p_flow, p_singlet.view_name())) return false;
+		if(!WriteNameAuto(p_flow, NameText(p_flow, p_singlet))) return false;
 	}
 	else
 	{
-		if(!WriteNamePrefered(p_flow, p_singlet.view_name(), p_singlet.quotation_mode())) return false;
+		if(!WriteNamePrefered(p_flow, NameText(p_flow, p_singlet), p_singlet.quotation_mode())) return false;
 	}
 
 	//close singlet
@@ -2562,21 +3271,22 @@ static bool WriteCommentNoSpace(WriterFlow& p_flow, const comment& p_comment)
 	return WriteComment(p_flow, p_comment) && WriteControl(p_flow, u8'\n');
 }
 
-static bool WriteListAll(WriterFlow& p_flow, const ItemList& p_list, uint8_t p_level)
+static Step WriteListAll(WriterFlow& p_flow, WriterFrame& p_frame)
 {
-	ItemList::const_iterator it, it_end, it_next;
-	for(it = p_list.cbegin(), it_end = p_list.cend(); it != it_end; ++it)
+	ItemList::const_iterator& it = p_frame.m_it;
+	ItemList::const_iterator it_end = p_frame.m_end, it_next;
+	for(; it != it_end; ++it)
 	{
 		switch((*it)->type())
 		{
 			case ItemType::group:
-				if(!WriteGroupDefault(p_flow, *static_cast<const group*>(it->get()), p_level)) return false;
-				break;
+				p_frame.m_child = static_cast<const group*>((it++)->get());
+				return WriteGroupDefault(p_flow, *p_frame.m_child, p_frame.m_level) ? Step::Open : Step::Stop;
 			case ItemType::singlet:
-				if(!WriteSingletDefault(p_flow, *static_cast<const singlet*>(it->get()), p_level)) return false;
+				if(!WriteSingletDefault(p_flow, *static_cast<const singlet*>(it->get()), p_frame.m_level)) return Step::Stop;
 				break;
 			case ItemType::key_value:
-				if(!WriteKeyValueDefault(p_flow, *static_cast<const keyedValue*>(it->get()), p_level)) return false;
+				if(!WriteKeyValueDefault(p_flow, *static_cast<const keyedValue*>(it->get()), p_frame.m_level)) return Step::Stop;
 				break;
 			case ItemType::spacer:
 				{
@@ -2584,13 +3294,13 @@ static bool WriteListAll(WriterFlow& p_flow, const ItemList& p_list, uint8_t p_l
 					++it_next;
 					if(it_next != it_end && (*it_next)->type() == ItemType::spacer)
 					{
-						if(!WriteSpacerNewLineOnly(p_flow, *static_cast<const spacer*>(it->get()))) return false;
+						if(!WriteSpacerNewLineOnly(p_flow, *static_cast<const spacer*>(it->get()))) return Step::Stop;
 					}
-					else if(!WriteSpacer(p_flow, *static_cast<const spacer*>(it->get()))) return false;
+					else if(!WriteSpacer(p_flow, *static_cast<const spacer*>(it->get()))) return Step::Stop;
 				}
 				break;
 			case ItemType::comment:
-				if(!WriteCommentNoSpace(p_flow, *static_cast<const comment*>(it->get()))) return false;
+				if(!WriteCommentNoSpace(p_flow, *static_cast<const comment*>(it->get()))) return Step::Stop;
 				break;
 			default:
 				_p::Danger_Action::publicError(*p_flow.m_warnDef._error_context).m_criticalItem = it->get();
@@ -2605,41 +3315,43 @@ static bool WriteListAll(WriterFlow& p_flow, const ItemList& p_list, uint8_t p_l
 						break;
 					case warningBehaviour::Abort:
 					default:
-						return false;
+						return Step::Stop;
 				}
 				break;
 		}
 	}
-	return true;
+	return Step::Close;
 }
 
-static bool WriteListAutoSpace(WriterFlow& p_flow, const ItemList& p_list, uint8_t p_level)
+static Step WriteListAutoSpace(WriterFlow& p_flow, WriterFrame& p_frame)
 {
-	uint64_t t_lastLine = 0;	// initialized because otherwise generates warning 4701
-	bool b_hasitem		= false;
-	bool b_lastRelevant	= false;
+	uint64_t& t_lastLine	= p_frame.m_lastLine;
+	bool& b_hasitem			= p_frame.m_hasItem;
+	bool& b_lastRelevant	= p_frame.m_lastRelevant;
+	const uint8_t p_level	= p_frame.m_level;
 
-	for(const itemProxy<item>& tproxy : p_list)
+	for(ItemList::const_iterator& it = p_frame.m_it; it != p_frame.m_end; ++it)
 	{
+		const itemProxy<item>& tproxy = *it;
 		switch(tproxy->type())
 		{
 			case ItemType::group:
 				b_hasitem		= true;
 				b_lastRelevant	= true;
 				t_lastLine		= tproxy->line();
-				if(!WriteGroupAutoSpace(p_flow, *static_cast<const group*>(tproxy.get()), p_level)) return false;
-				break;
+				p_frame.m_child = static_cast<const group*>((it++)->get());
+				return WriteGroupAutoSpace(p_flow, *p_frame.m_child, p_level) ? Step::Open : Step::Stop;
 			case ItemType::singlet:
 				b_hasitem		= true;
 				b_lastRelevant	= true;
 				t_lastLine		= tproxy->line();
-				if(!WriteSingletAutoSpace(p_flow, *static_cast<const singlet*>(tproxy.get()), p_level)) return false;
+				if(!WriteSingletAutoSpace(p_flow, *static_cast<const singlet*>(tproxy.get()), p_level)) return Step::Stop;
 				break;
 			case ItemType::key_value:
 				b_hasitem		= true;
 				b_lastRelevant	= true;
 				t_lastLine		= tproxy->line();
-				if(!WriteKeyValueAutoSpace(p_flow, *static_cast<const keyedValue*>(tproxy.get()), p_level)) return false;
+				if(!WriteKeyValueAutoSpace(p_flow, *static_cast<const keyedValue*>(tproxy.get()), p_level)) return Step::Stop;
 				break;
 			case ItemType::spacer:
 				if(static_cast<const spacer*>(tproxy.get())->num_lines()) b_lastRelevant = false;
@@ -2649,23 +3361,23 @@ static bool WriteListAutoSpace(WriterFlow& p_flow, const ItemList& p_list, uint8
 					//inline comment?
 					if(b_lastRelevant && tproxy->line() == t_lastLine)
 					{
-						if(!WriteControl(p_flow, u8' ')) return false;
+						if(!WriteControl(p_flow, u8' ')) return Step::Stop;
 					}
 					else
 					{
 						//new line commnt
-						if(!WriteControl(p_flow, u8'\n')) return false;
+						if(!WriteControl(p_flow, u8'\n')) return Step::Stop;
 
 						//add tabs
 						for(uint8_t itl = 0; itl < p_level; ++itl)
 						{
-							if(!WriteControl(p_flow, u8'\t')) return false;
+							if(!WriteControl(p_flow, u8'\t')) return Step::Stop;
 						}
 
 					}
 					b_lastRelevant	= false;
 					b_hasitem		= true;
-					if(!WriteCommentAutoSpace(p_flow, *static_cast<const comment*>(tproxy.get()), p_level)) return false;
+					if(!WriteCommentAutoSpace(p_flow, *static_cast<const comment*>(tproxy.get()), p_level)) return Step::Stop;
 				}
 				break;
 			default:
@@ -2681,7 +3393,7 @@ static bool WriteListAutoSpace(WriterFlow& p_flow, const ItemList& p_list, uint8
 						break;
 					case warningBehaviour::Abort:
 					default:
-						return false;
+						return Step::Stop;
 				}
 				break;
 		}
@@ -2689,37 +3401,38 @@ static bool WriteListAutoSpace(WriterFlow& p_flow, const ItemList& p_list, uint8
 
 	if(b_hasitem)
 	{
-		if(!WriteControl(p_flow, u8'\n')) return false;
+		if(!WriteControl(p_flow, u8'\n')) return Step::Stop;
 
 		//add tabs
 		for(uint8_t i = 1; i < p_level; ++i)
 		{
-			if(!WriteControl(p_flow, u8'\t')) return false;
+			if(!WriteControl(p_flow, u8'\t')) return Step::Stop;
 		}
 	}
 
-	return true;
+	return Step::Close;
 }
 
-static bool WriteListNoSpace(WriterFlow& p_flow, const ItemList& p_list, uint8_t p_level)
+static Step WriteListNoSpace(WriterFlow& p_flow, WriterFrame& p_frame)
 {
-	for(const itemProxy<item>& tproxy : p_list)
+	for(ItemList::const_iterator& it = p_frame.m_it; it != p_frame.m_end; ++it)
 	{
+		const itemProxy<item>& tproxy = *it;
 		switch(tproxy->type())
 		{
 			case ItemType::group:
-				if(!WriteGroupNoSpace(p_flow, *static_cast<const group*>(tproxy.get()), p_level)) return false;
-				break;
+				p_frame.m_child = static_cast<const group*>((it++)->get());
+				return WriteGroupNoSpace(p_flow, *p_frame.m_child, p_frame.m_level) ? Step::Open : Step::Stop;
 			case ItemType::singlet:
-				if(!WriteSingletNoSpace(p_flow, *static_cast<const singlet*>(tproxy.get()), p_level)) return false;
+				if(!WriteSingletNoSpace(p_flow, *static_cast<const singlet*>(tproxy.get()), p_frame.m_level)) return Step::Stop;
 				break;
 			case ItemType::key_value:
-				if(!WriteKeyValueNoSpace(p_flow, *static_cast<const keyedValue*>(tproxy.get()), p_level)) return false;
+				if(!WriteKeyValueNoSpace(p_flow, *static_cast<const keyedValue*>(tproxy.get()), p_frame.m_level)) return Step::Stop;
 				break;
 			case ItemType::spacer:
 				break;
 			case ItemType::comment:
-				if(!WriteCommentNoSpace(p_flow, *static_cast<const comment*>(tproxy.get()))) return false;
+				if(!WriteCommentNoSpace(p_flow, *static_cast<const comment*>(tproxy.get()))) return Step::Stop;
 				break;
 			default:
 				_p::Danger_Action::publicError(*p_flow.m_warnDef._error_context).m_criticalItem = tproxy.get();
@@ -2734,29 +3447,30 @@ static bool WriteListNoSpace(WriterFlow& p_flow, const ItemList& p_list, uint8_t
 						break;
 					case warningBehaviour::Abort:
 					default:
-						return false;
+						return Step::Stop;
 				}
 				break;
 		}
 	}
-	return true;
+	return Step::Close;
 }
 
-static bool WriteListNoComment(WriterFlow& p_flow, const ItemList& p_list, uint8_t p_level)
+static Step WriteListNoComment(WriterFlow& p_flow, WriterFrame& p_frame)
 {
-	ItemList::const_iterator it , it_end, it_next;
-	for(it = p_list.cbegin(), it_end = p_list.cend(); it != it_end; ++it)
+	ItemList::const_iterator& it = p_frame.m_it;
+	ItemList::const_iterator it_end = p_frame.m_end, it_next;
+	for(; it != it_end; ++it)
 	{
 		switch((*it)->type())
 		{
 			case ItemType::group:
-				if(!WriteGroupDefault(p_flow, *static_cast<const group*>(it->get()), p_level)) return false;
-				break;
+				p_frame.m_child = static_cast<const group*>((it++)->get());
+				return WriteGroupDefault(p_flow, *p_frame.m_child, p_frame.m_level) ? Step::Open : Step::Stop;
 			case ItemType::singlet:
-				if(!WriteSingletDefault(p_flow, *static_cast<const singlet*>(it->get()), p_level)) return false;
+				if(!WriteSingletDefault(p_flow, *static_cast<const singlet*>(it->get()), p_frame.m_level)) return Step::Stop;
 				break;
 			case ItemType::key_value:
-				if(!WriteKeyValueDefault(p_flow, *static_cast<const keyedValue*>(it->get()), p_level)) return false;
+				if(!WriteKeyValueDefault(p_flow, *static_cast<const keyedValue*>(it->get()), p_frame.m_level)) return Step::Stop;
 				break;
 			case ItemType::spacer:
 				it_next = it;
@@ -2765,9 +3479,9 @@ static bool WriteListNoComment(WriterFlow& p_flow, const ItemList& p_list, uint8
 
 				if(it_next != it_end && (*it_next)->type() == ItemType::spacer)
 				{
-					if(!WriteSpacerNewLineOnly(p_flow, *static_cast<const spacer*>(it->get()))) return false;
+					if(!WriteSpacerNewLineOnly(p_flow, *static_cast<const spacer*>(it->get()))) return Step::Stop;
 				}
-				else if(!WriteSpacer(p_flow, *static_cast<const spacer*>(it->get()))) return false;
+				else if(!WriteSpacer(p_flow, *static_cast<const spacer*>(it->get()))) return Step::Stop;
 
 				break;
 			case ItemType::comment:
@@ -2785,31 +3499,32 @@ static bool WriteListNoComment(WriterFlow& p_flow, const ItemList& p_list, uint8
 						break;
 					case warningBehaviour::Abort:
 					default:
-						return false;
+						return Step::Stop;
 				}
 				break;
 		}
 	}
-	return true;
+	return Step::Close;
 }
 
-static bool WriteListAutoNoComment(WriterFlow& p_flow, const ItemList& p_list, uint8_t p_level)
+static Step WriteListAutoNoComment(WriterFlow& p_flow, WriterFrame& p_frame)
 {
-	bool b_hasitem = false;
-	for(const itemProxy<item>& tproxy : p_list)
+	bool& b_hasitem = p_frame.m_hasItem;
+	for(ItemList::const_iterator& it = p_frame.m_it; it != p_frame.m_end; ++it)
 	{
+		const itemProxy<item>& tproxy = *it;
 		switch(tproxy->type())
 		{
 			case ItemType::group:
 				b_hasitem = true;
-				if(!WriteGroupAutoSpace(p_flow, *static_cast<const group*>(tproxy.get()), p_level)) return false;
-				break;
+				p_frame.m_child = static_cast<const group*>((it++)->get());
+				return WriteGroupAutoSpace(p_flow, *p_frame.m_child, p_frame.m_level) ? Step::Open : Step::Stop;
 			case ItemType::singlet:
-				if(!WriteSingletAutoSpace(p_flow, *static_cast<const singlet*>(tproxy.get()), p_level)) return false;
+				if(!WriteSingletAutoSpace(p_flow, *static_cast<const singlet*>(tproxy.get()), p_frame.m_level)) return Step::Stop;
 				break;
 			case ItemType::key_value:
 				b_hasitem = true;
-				if(!WriteKeyValueAutoSpace(p_flow, *static_cast<const keyedValue*>(tproxy.get()), p_level)) return false;
+				if(!WriteKeyValueAutoSpace(p_flow, *static_cast<const keyedValue*>(tproxy.get()), p_frame.m_level)) return Step::Stop;
 				break;
 			case ItemType::spacer:
 			case ItemType::comment:
@@ -2827,7 +3542,7 @@ static bool WriteListAutoNoComment(WriterFlow& p_flow, const ItemList& p_list, u
 						break;
 					case warningBehaviour::Abort:
 					default:
-						return false;
+						return Step::Stop;
 				}
 				break;
 		}
@@ -2836,30 +3551,31 @@ static bool WriteListAutoNoComment(WriterFlow& p_flow, const ItemList& p_list, u
 	if(b_hasitem)
 	{
 		//new line
-		if(!WriteControl(p_flow, u8'\n')) return false;
+		if(!WriteControl(p_flow, u8'\n')) return Step::Stop;
 		//add tabs
-		for(uint8_t i = 1; i < p_level; ++i)
+		for(uint8_t i = 1; i < p_frame.m_level; ++i)
 		{
-			if(!WriteControl(p_flow, u8'\t')) return false;
+			if(!WriteControl(p_flow, u8'\t')) return Step::Stop;
 		}
 	}
-	return true;
+	return Step::Close;
 }
 
-static bool WriteListCompact(WriterFlow& p_flow, const ItemList& p_list, uint8_t p_level)
+static Step WriteListCompact(WriterFlow& p_flow, WriterFrame& p_frame)
 {
-	for(const itemProxy<item>& tproxy : p_list)
+	for(ItemList::const_iterator& it = p_frame.m_it; it != p_frame.m_end; ++it)
 	{
+		const itemProxy<item>& tproxy = *it;
 		switch(tproxy->type())
 		{
 			case ItemType::group:
-				if(!WriteGroupNoSpace(p_flow, *static_cast<const group*>(tproxy.get()), p_level)) return false;
-				break;
+				p_frame.m_child = static_cast<const group*>((it++)->get());
+				return WriteGroupNoSpace(p_flow, *p_frame.m_child, p_frame.m_level) ? Step::Open : Step::Stop;
 			case ItemType::singlet:
-				if(!WriteSingletNoSpace(p_flow, *static_cast<const singlet*>(tproxy.get()), p_level)) return false;
+				if(!WriteSingletNoSpace(p_flow, *static_cast<const singlet*>(tproxy.get()), p_frame.m_level)) return Step::Stop;
 				break;
 			case ItemType::key_value:
-				if(!WriteKeyValueNoSpace(p_flow, *static_cast<const keyedValue*>(tproxy.get()), p_level)) return false;
+				if(!WriteKeyValueNoSpace(p_flow, *static_cast<const keyedValue*>(tproxy.get()), p_frame.m_level)) return Step::Stop;
 				break;
 			case ItemType::spacer:
 			case ItemType::comment:
@@ -2877,12 +3593,12 @@ static bool WriteListCompact(WriterFlow& p_flow, const ItemList& p_list, uint8_t
 						break;
 					case warningBehaviour::Abort:
 					default:
-						return false;
+						return Step::Stop;
 				}
 				break;
 		}
 	}
-	return true;
+	return Step::Close;
 }
 
 void save(root& p_root, stream_encoder& p_encoder, Flag p_flags, [[maybe_unused]] uint16_t p_requested_version, _Warning_Def& p_warn)
@@ -2927,10 +3643,38 @@ void save(root& p_root, stream_encoder& p_encoder, Flag p_flags, [[maybe_unused]
 		}
 	}
 
-	if(t_flow.m_listWriter(t_flow, p_root, 0))
+	//lists being written, innermost last
+	//kept on the heap so that nesting is not bounded by the thread's stack
+	std::vector<WriterFrame> t_stack;
+	t_stack.emplace_back(p_root, nullptr, uint8_t{0});
+
+	do
 	{
-		_p::Danger_Action::publicError(*p_warn._error_context).SetPlainError(Error::None);
+		WriterFrame& t_frame = t_stack.back();
+		switch(t_flow.m_listWriter(t_flow, t_frame))
+		{
+			case Step::Open:
+				{
+					const group& t_child = *t_frame.m_child;
+					uint8_t t_level = t_frame.m_level;
+					if(t_level < MAX_LEVEL) ++t_level;
+					t_stack.emplace_back(t_child, &t_child, t_level);
+				}
+				break;
+			case Step::Close:
+				{
+					const group* t_group = t_frame.m_group;
+					t_stack.pop_back();
+					if(t_group && !WriteGroupEnd(t_flow, *t_group)) return;
+				}
+				break;
+			default:
+				return;
+		}
 	}
+	while(!t_stack.empty());
+
+	_p::Danger_Action::publicError(*p_warn._error_context).SetPlainError(Error::None);
 }
 
 }	//namespace scef::format::v1
@@ -27,10 +27,54 @@
 
 #pragma once
 
+#include <memory>
+#include <memory_resource>
+
 #include "scef_format.hpp"
 
 namespace scef::format::v1
 {
-void load(root& p_root, stream_decoder& p_decoder, Flag p_flags, uint16_t p_detected_version, _Warning_Def& p_warn);
+//what load does besides building the tree
+struct load_options
+{
+	event_handler*								handler		= nullptr;	//items are reported to it as they are read, and the root is only used as scratch
+	const path_filter*							filter		= nullptr;	//only the items it selects are kept
+	uint64_t									defer		= 0;		//if set, group bodies are only scanned and marked as deferred from this source
+	std::shared_ptr<std::pmr::memory_resource>	arena;					//the arena items are made from, the heap if not set
+	_p::symbol_table*							symbols		= nullptr;	//where names are interned, if they are
+};
+
+//Decoder is the concrete type of p_decoder, the reader is compiled for each of them so that decoding is not a virtual call.
+//Instantiated for every decoder in ENCODER_P.
+template<typename Decoder>
+void load(root& p_root, stream_decoder& p_decoder, Flag p_flags, uint16_t p_detected_version, _Warning_Def& p_warn, const load_options& p_options);
+using load_f = void (*)(root&, stream_decoder&, Flag, uint16_t, _Warning_Def&, const load_options&);
+
+//Reads the body of a group deferred by load, groups in it are deferred again from p_source.
+//Items are made from p_arena, or the heap if null. Names are interned in p_symbols if set.
+template<typename Decoder>
+void expand(group& p_group, stream_decoder& p_decoder, Flag p_flags, _Warning_Def& p_warn, uint64_t p_source, const std::shared_ptr<std::pmr::memory_resource>& p_arena, _p::symbol_table* p_symbols);
+using expand_f = void (*)(group&, stream_decoder&, Flag, _Warning_Def&, uint64_t, const std::shared_ptr<std::pmr::memory_resource>&, _p::symbol_table*);
+
+//Reads a document one item at a time on behalf of scef::reader, instantiated like load
+class cursor
+{
+public:
+	virtual ~cursor() = default;
+
+	//false once there is nothing else to read, the error context tells how it ended
+	virtual bool next() = 0;
+	//when at the start of a group, moves to its end without building what is in between
+	virtual bool skip_group() = 0;
+
+	reader::token	m_kind	= reader::token::none;
+	const item*		m_item	= nullptr;
+	uintptr_t		m_depth	= 0;
+};
+
+template<typename Decoder>
+std::unique_ptr<cursor> make_cursor(std::unique_ptr<stream_decoder> p_decoder, Flag p_flags, const _Warning_Def& p_warn);
+using make_cursor_f = std::unique_ptr<cursor> (*)(std::unique_ptr<stream_decoder>, Flag, const _Warning_Def&);
+
 void save(root& p_root, stream_encoder& p_encoder, Flag p_flags, uint16_t p_requested_version, _Warning_Def& p_warn);
 }	//namespace scef::format::v1
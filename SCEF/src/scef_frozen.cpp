@@ -0,0 +1,670 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+
+#include <SCEF/scef_frozen.hpp>
+
+#include <cstring>
+#include <utility>
+
+#include <CoreLib/core_file.hpp>
+
+#include "scef_danger_act_p.hpp"
+
+
+namespace scef
+{
+
+static uint32_t hash_text(std::u32string_view p_text)
+{
+	uint32_t t_hash = 0x811C9DC5;
+	for(const char32_t t_char : p_text)
+	{
+		t_hash = (t_hash ^ static_cast<uint32_t>(t_char)) * 0x01000193;
+	}
+	return t_hash;
+}
+
+//"SCFB" in the first bytes of the image, reads swapped when written on a machine of the other byte order
+static constexpr uint32_t image_magic			= 0x42464353;
+static constexpr uint32_t image_magic_swapped	= 0x53434642;
+
+static inline uint32_t hash_child(frozen_document::node p_parent, std::u32string_view p_name)
+{
+	return hash_text(p_name) ^ (p_parent * 0x9E3779B1);
+}
+
+//======== ======== class frozen_document::builder
+//Records the items in the order they are read, with the node of their parent,
+//and lays them out so that siblings are consecutive once all have been read
+class frozen_document::builder final: public event_handler
+{
+public:
+	builder()
+	{
+		m_types	.push_back(ItemType::root);
+		m_names	.push_back(text{});
+		m_values.push_back(text{});
+		m_parents.push_back(root_node);
+		m_open	.push_back(root_node);
+	}
+
+	void on_group_begin(const group& p_group) override
+	{
+		m_open.push_back(add(ItemType::group, name_of(p_group), text{}));
+	}
+
+	void on_group_end(const group&) override
+	{
+		m_open.pop_back();
+	}
+
+	void on_key_value(const keyedValue& p_key) override
+	{
+		const text t_name = name_of(p_key);
+		add(ItemType::key_value, t_name, value_of(p_key));
+	}
+
+	void on_singlet(const singlet& p_singlet) override
+	{
+		add(ItemType::singlet, name_of(p_singlet), text{});
+	}
+
+	void add_list(const ItemList& p_items)
+	{
+		struct level
+		{
+			const ItemList*	list;
+			uintptr_t		pos;
+		};
+
+		std::vector<level> t_stack{level{&p_items, 0}};
+		while(!t_stack.empty())
+		{
+			level& t_level = t_stack.back();
+			if(t_level.pos == t_level.list->size())
+			{
+				t_stack.pop_back();
+				if(!t_stack.empty()) m_open.pop_back();
+				continue;
+			}
+
+			const item& t_item = *(*t_level.list)[t_level.pos++];
+			switch(t_item.type())
+			{
+			case ItemType::group:
+				{
+					const group& t_group = static_cast<const group&>(t_item);
+					on_group_begin(t_group);
+					t_stack.push_back(level{&t_group, 0});
+				}
+				break;
+			case ItemType::singlet:
+				on_singlet(static_cast<const singlet&>(t_item));
+				break;
+			case ItemType::key_value:
+				on_key_value(static_cast<const keyedValue&>(t_item));
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	Error finish(frozen_document& p_out)
+	{
+		if(m_too_large)
+		{
+			return Error::TooLarge;
+		}
+
+		const uintptr_t t_size = m_types.size();
+
+		//children of each node, in the order they were read
+		std::vector<node> t_start(t_size + 1, 0);
+		for(uintptr_t i = 1; i < t_size; ++i) ++t_start[m_parents[i] + 1];
+		for(uintptr_t i = 1; i <= t_size; ++i) t_start[i] += t_start[i - 1];
+
+		std::vector<node> t_children(t_size);
+		{
+			std::vector<node> t_fill(t_start.begin(), t_start.end() - 1);
+			for(uintptr_t i = 1; i < t_size; ++i) t_children[t_fill[m_parents[i]]++] = static_cast<node>(i);
+		}
+
+		//breadth first, every node's children are put after all the nodes that come before it
+		std::vector<node> t_order;
+		t_order.reserve(t_size);
+		t_order.push_back(root_node);
+
+		std::vector<ItemType>	t_types		(t_size);
+		std::vector<text>		t_names		(t_size);
+		std::vector<text>		t_values	(t_size);
+		std::vector<range>		t_ranges	(t_size);
+
+		for(uintptr_t i = 0; i < t_size; ++i)
+		{
+			const node t_old = t_order[i];
+			t_types	[i] = m_types	[t_old];
+			t_names	[i] = m_names	[t_old];
+			t_values[i] = m_values	[t_old];
+			t_ranges[i] = range{static_cast<node>(t_order.size()), t_start[t_old + 1] - t_start[t_old]};
+			t_order.insert(t_order.end(), t_children.begin() + t_start[t_old], t_children.begin() + t_start[t_old + 1]);
+		}
+
+		uintptr_t t_capacity = 16;
+		while(t_capacity < t_size * 2) t_capacity *= 2;
+		std::vector<slot> t_slots(t_capacity, slot{0, 0});
+		const uintptr_t t_mask = t_capacity - 1;
+
+		//nodes that come first are found first, as their slots come first when probing from the same start
+		for(uintptr_t t_parent = 0; t_parent < t_size; ++t_parent)
+		{
+			const range t_range = t_ranges[t_parent];
+			for(node t_node = t_range.first; t_node < t_range.first + t_range.count; ++t_node)
+			{
+				const text t_name = t_names[t_node];
+				const uint32_t t_hash = hash_child(static_cast<node>(t_parent), std::u32string_view{m_blob}.substr(t_name.offset, t_name.size));
+				uintptr_t t_slot = t_hash & t_mask;
+				while(t_slots[t_slot].pos) t_slot = (t_slot + 1) & t_mask;
+				t_slots[t_slot] = slot{t_hash, t_node + 1};
+			}
+		}
+
+		const header t_header
+		{
+			.magic		= image_magic,
+			.version	= __SCEF_BINARY_VERSION,
+			.reserved	= 0,
+			.nodes		= static_cast<uint32_t>(t_size),
+			.slots		= static_cast<uint32_t>(t_capacity),
+			.blob		= static_cast<uint32_t>(m_blob.size()),
+			.padding	= 0,
+		};
+
+		std::vector<uint64_t> t_image((image_size(t_header) + 7) / 8);
+		char8_t* t_pos = reinterpret_cast<char8_t*>(t_image.data());
+		const auto t_write = [&t_pos](const void* p_data, uintptr_t p_size)
+			{
+				if(p_size) memcpy(t_pos, p_data, p_size);
+				t_pos += p_size;
+			};
+
+		t_write(&t_header,			sizeof(header));
+		t_write(t_names	.data(),	t_size * sizeof(text));
+		t_write(t_values.data(),	t_size * sizeof(text));
+		t_write(t_ranges.data(),	t_size * sizeof(range));
+		t_write(t_slots	.data(),	t_capacity * sizeof(slot));
+		t_write(m_blob	.data(),	m_blob.size() * sizeof(char32_t));
+		t_write(t_types	.data(),	t_size * sizeof(ItemType));
+
+		p_out.detach();
+		p_out.m_image = std::move(t_image);
+		p_out.attach(reinterpret_cast<const char8_t*>(p_out.m_image.data()));
+		return Error::None;
+	}
+
+private:
+	//once past a limit nothing more is kept, the groups still open and close against the root
+	node add(ItemType p_type, text p_name, text p_value)
+	{
+		if(m_too_large || m_types.size() == max_nodes)
+		{
+			m_too_large = true;
+			return root_node;
+		}
+		const node t_node = static_cast<node>(m_types.size());
+		m_types	.push_back(p_type);
+		m_names	.push_back(p_name);
+		m_values.push_back(p_value);
+		m_parents.push_back(m_open.back());
+		return t_node;
+	}
+
+	text name_of(const _p::NamedItem& p_item)
+	{
+		if(p_item.utf8())
+		{
+			_p::decode_item_text(p_item.view_name_u8(), m_scratch);
+			return store(m_scratch);
+		}
+		return store(p_item.view_name());
+	}
+
+	text value_of(const keyedValue& p_key)
+	{
+		if(p_key.value_utf8())
+		{
+			_p::decode_item_text(p_key.view_value_u8(), m_scratch);
+			return append(m_scratch);
+		}
+		return append(p_key.view_value());
+	}
+
+	//names repeat across groups of the same kind and are stored once, values are mostly unique and are not looked up
+	text store(std::u32string_view p_text)
+	{
+		if(p_text.empty()) return text{};
+
+		if(m_stored_count * 2 >= m_stored.size()) grow();
+
+		const uint32_t t_hash = hash_text(p_text);
+		uintptr_t t_slot = t_hash & m_stored_mask;
+		for(; m_stored[t_slot].second.size; t_slot = (t_slot + 1) & m_stored_mask)
+		{
+			const text t_text = m_stored[t_slot].second;
+			if(m_stored[t_slot].first == t_hash && std::u32string_view{m_blob}.substr(t_text.offset, t_text.size) == p_text) return t_text;
+		}
+
+		const text t_text = append(p_text);
+		if(m_too_large) return text{};
+		m_stored[t_slot] = {t_hash, t_text};
+		++m_stored_count;
+		return t_text;
+	}
+
+	text append(std::u32string_view p_text)
+	{
+		if(p_text.empty()) return text{};
+		if(m_too_large || p_text.size() > max_text - m_blob.size())
+		{
+			m_too_large = true;
+			return text{};
+		}
+		const text t_text{static_cast<uint32_t>(m_blob.size()), static_cast<uint32_t>(p_text.size())};
+		m_blob.append(p_text);
+		return t_text;
+	}
+
+	void grow()
+	{
+		std::vector<std::pair<uint32_t, text>> t_old = std::move(m_stored);
+		m_stored.assign(t_old.empty() ? 256 : t_old.size() * 2, {0, text{}});
+		m_stored_mask = m_stored.size() - 1;
+		for(const std::pair<uint32_t, text>& t_entry : t_old)
+		{
+			if(!t_entry.second.size) continue;
+			uintptr_t t_slot = t_entry.first & m_stored_mask;
+			while(m_stored[t_slot].second.size) t_slot = (t_slot + 1) & m_stored_mask;
+			m_stored[t_slot] = t_entry;
+		}
+	}
+
+	std::vector<ItemType>	m_types;
+	std::vector<text>		m_names;
+	std::vector<text>		m_values;
+	std::vector<node>		m_parents;
+	std::vector<node>		m_open;		//groups being read, the root first
+	std::u32string			m_blob;
+	std::vector<std::pair<uint32_t, text>> m_stored;	//hash of the text, empty for an empty slot
+	uintptr_t				m_stored_mask	= 0;
+	uintptr_t				m_stored_count	= 0;
+	std::u32string			m_scratch;
+	bool					m_too_large = false;
+};
+
+//======== ======== class frozen_document
+frozen_document::frozen_document()
+{
+	builder{}.finish(*this);
+}
+
+frozen_document::frozen_document(const ItemList& p_items)
+{
+	builder t_builder;
+	t_builder.add_list(p_items);
+	if(const Error t_error = t_builder.finish(*this); t_error != Error::None)
+	{
+		fail(t_error);
+	}
+}
+
+frozen_document::frozen_document(const frozen_document& p_other)
+	: m_last_error{p_other.m_last_error}
+{
+	const std::span<const char8_t> t_image = p_other.image();
+	if(t_image.empty())
+	{
+		return;
+	}
+	m_image.resize((t_image.size() + 7) / 8);
+	memcpy(m_image.data(), t_image.data(), t_image.size());
+	attach(reinterpret_cast<const char8_t*>(m_image.data()));
+}
+
+frozen_document::frozen_document(frozen_document&& p_other) noexcept
+	: m_types		{p_other.m_types}
+	, m_names		{p_other.m_names}
+	, m_values		{p_other.m_values}
+	, m_children	{p_other.m_children}
+	, m_slots		{p_other.m_slots}
+	, m_blob		{p_other.m_blob}
+	, m_size		{p_other.m_size}
+	, m_mask		{p_other.m_mask}
+	, m_image		{std::move(p_other.m_image)}
+	, m_mapped		{std::move(p_other.m_mapped)}
+	, m_last_error	{p_other.m_last_error}
+{
+	p_other.detach();
+}
+
+frozen_document::~frozen_document() = default;
+
+frozen_document& frozen_document::operator = (const frozen_document& p_other)
+{
+	if(this != &p_other)
+	{
+		*this = frozen_document{p_other};
+	}
+	return *this;
+}
+
+frozen_document& frozen_document::operator = (frozen_document&& p_other) noexcept
+{
+	if(this != &p_other)
+	{
+		m_types		= p_other.m_types;
+		m_names		= p_other.m_names;
+		m_values	= p_other.m_values;
+		m_children	= p_other.m_children;
+		m_slots		= p_other.m_slots;
+		m_blob		= p_other.m_blob;
+		m_size		= p_other.m_size;
+		m_mask		= p_other.m_mask;
+		m_image		= std::move(p_other.m_image);
+		m_mapped	= std::move(p_other.m_mapped);
+		m_last_error = p_other.m_last_error;
+		p_other.detach();
+	}
+	return *this;
+}
+
+Error frozen_document::load(const std::filesystem::path& p_file, Flag p_flags, _warning_callback p_warning_callback, void* p_user_context)
+{
+	builder t_builder;
+	document t_document;
+	const Error t_error = t_document.load(p_file, t_builder, p_flags | Flag::DisableSpacers | Flag::DisableComments, p_warning_callback, p_user_context);
+	m_last_error = t_document.last_error();
+	if(t_error != Error::None)
+	{
+		builder{}.finish(*this);
+		return t_error;
+	}
+	if(const Error t_built = t_builder.finish(*this); t_built != Error::None)
+	{
+		return fail(t_built);
+	}
+	return Error::None;
+}
+
+Error frozen_document::load(base_istreamer& p_stream, Flag p_flags, _warning_callback p_warning_callback, void* p_user_context)
+{
+	builder t_builder;
+	document t_document;
+	const Error t_error = t_document.load(p_stream, t_builder, p_flags | Flag::DisableSpacers | Flag::DisableComments, p_warning_callback, p_user_context);
+	m_last_error = t_document.last_error();
+	if(t_error != Error::None)
+	{
+		builder{}.finish(*this);
+		return t_error;
+	}
+	if(const Error t_built = t_builder.finish(*this); t_built != Error::None)
+	{
+		return fail(t_built);
+	}
+	return Error::None;
+}
+
+Error frozen_document::load_binary(const std::filesystem::path& p_file)
+{
+	std::unique_ptr<mmap_istream> t_mapped = std::make_unique<mmap_istream>();
+	if(!t_mapped->open(p_file))
+	{
+		//not a regular file, or could not be mapped
+		core::file_read f_reader;
+		f_reader.open(p_file);
+		if(!f_reader.is_open())
+		{
+			return fail(Error::FileNotFound);
+		}
+		file_istream t_reader{f_reader};
+		return load_binary(t_reader);
+	}
+
+	const std::span<const char8_t> t_image = t_mapped->contiguous_view();
+	if(const Error t_error = check(t_image); t_error != Error::None)
+	{
+		return fail(t_error);
+	}
+
+	detach();
+	m_mapped = std::move(t_mapped);
+	attach(t_image.data());
+	if(!valid())
+	{
+		return fail(Error::BadFormat);
+	}
+	m_last_error.clear();
+	return Error::None;
+}
+
+Error frozen_document::load_binary(base_istreamer& p_stream)
+{
+	const uint64_t t_size = p_stream.remaining();
+	if(t_size < sizeof(header) || t_size > UINTPTR_MAX)
+	{
+		return fail(Error::BadFormat);
+	}
+
+	std::vector<uint64_t> t_image((static_cast<uintptr_t>(t_size) + 7) / 8);
+	if(p_stream.read(t_image.data(), static_cast<uintptr_t>(t_size)) != t_size)
+	{
+		return fail(Error::Unable2Read);
+	}
+
+	if(const Error t_error = check(std::span<const char8_t>{reinterpret_cast<const char8_t*>(t_image.data()), static_cast<uintptr_t>(t_size)}); t_error != Error::None)
+	{
+		return fail(t_error);
+	}
+
+	detach();
+	m_image = std::move(t_image);
+	attach(reinterpret_cast<const char8_t*>(m_image.data()));
+	if(!valid())
+	{
+		return fail(Error::BadFormat);
+	}
+	m_last_error.clear();
+	return Error::None;
+}
+
+Error frozen_document::save(const std::filesystem::path& p_file) const
+{
+	core::file_write f_writer;
+	f_writer.open(p_file, core::file_write::open_mode::create);
+	if(f_writer.is_open())
+	{
+		file_ostream t_writer{f_writer};
+		return save(t_writer);
+	}
+	return Error::Unable2Write;
+}
+
+Error frozen_document::save(base_ostreamer& p_stream) const
+{
+	const std::span<const char8_t> t_image = image();
+	if(p_stream.write(t_image.data(), t_image.size()) != stream_error::None)
+	{
+		return Error::Unable2Write;
+	}
+	return Error::None;
+}
+
+frozen_document::node frozen_document::find(node p_parent, ItemType p_type, std::u32string_view p_name) const
+{
+	const range t_children = m_children[p_parent];
+	const uint32_t t_hash = hash_child(p_parent, p_name);
+	for(uintptr_t t_slot = t_hash & m_mask; m_slots[t_slot].pos; t_slot = (t_slot + 1) & m_mask)
+	{
+		if(m_slots[t_slot].hash != t_hash) continue;
+		const node t_node = m_slots[t_slot].pos - 1;
+		if(t_node - t_children.first < t_children.count && m_types[t_node] == p_type && name(t_node) == p_name)
+		{
+			return t_node;
+		}
+	}
+	return npos;
+}
+
+uint64_t frozen_document::image_size(const header& p_header)
+{
+	return sizeof(header)
+		+ uint64_t{p_header.nodes}	* (sizeof(text) * 2 + sizeof(range) + sizeof(ItemType))
+		+ uint64_t{p_header.slots}	* sizeof(slot)
+		+ uint64_t{p_header.blob}	* sizeof(char32_t);
+}
+
+Error frozen_document::check(std::span<const char8_t> p_image)
+{
+	header t_header;
+	if(p_image.size() < sizeof(header))
+	{
+		return Error::BadFormat;
+	}
+	memcpy(&t_header, p_image.data(), sizeof(header));
+
+	if(t_header.magic != image_magic)
+	{
+		return t_header.magic == image_magic_swapped ? Error::BadEncoding : Error::BadFormat;
+	}
+	if(t_header.version != __SCEF_BINARY_VERSION)
+	{
+		return Error::UnsuportedVersion;
+	}
+	if(t_header.nodes == 0 || t_header.nodes > max_nodes || image_size(t_header) != p_image.size()
+		|| t_header.slots <= t_header.nodes || (t_header.slots & (t_header.slots - 1)) != 0)
+	{
+		return Error::BadFormat;
+	}
+	return Error::None;
+}
+
+//Anything that would make the accessors read outside of the image, or a walk over the children not end
+bool frozen_document::valid() const
+{
+	if(m_types[root_node] != ItemType::root)
+	{
+		return false;
+	}
+
+	const uint64_t t_blob = (reinterpret_cast<const char8_t*>(m_types) - reinterpret_cast<const char8_t*>(m_blob)) / sizeof(char32_t);
+	for(node i = 0; i < m_size; ++i)
+	{
+		if(i != root_node && m_types[i] != ItemType::group && m_types[i] != ItemType::singlet && m_types[i] != ItemType::key_value)
+		{
+			return false;
+		}
+
+		const text t_name	= m_names[i];
+		const text t_value	= m_values[i];
+		if(uint64_t{t_name.offset} + t_name.size > t_blob || uint64_t{t_value.offset} + t_value.size > t_blob)
+		{
+			return false;
+		}
+
+		//children come after their parent
+		const range t_range = m_children[i];
+		if(t_range.count && (t_range.first <= i || uint64_t{t_range.first} + t_range.count > m_size))
+		{
+			return false;
+		}
+	}
+
+	//find stops at the first empty slot
+	bool t_empty = false;
+	for(uintptr_t i = 0; i <= m_mask; ++i)
+	{
+		if(m_slots[i].pos > m_size)
+		{
+			return false;
+		}
+		t_empty = t_empty || m_slots[i].pos == 0;
+	}
+	return t_empty;
+}
+
+std::span<const char8_t> frozen_document::image() const
+{
+	if(m_size == 0)
+	{
+		return {};
+	}
+	header t_header;
+	const char8_t* const t_image = reinterpret_cast<const char8_t*>(m_names) - sizeof(header);
+	memcpy(&t_header, t_image, sizeof(header));
+	return {t_image, static_cast<uintptr_t>(image_size(t_header))};
+}
+
+void frozen_document::attach(const char8_t* p_image)
+{
+	header t_header;
+	memcpy(&t_header, p_image, sizeof(header));
+
+	const char8_t* t_pos = p_image + sizeof(header);
+	m_names		= reinterpret_cast<const text*>		(t_pos); t_pos += t_header.nodes * sizeof(text);
+	m_values	= reinterpret_cast<const text*>		(t_pos); t_pos += t_header.nodes * sizeof(text);
+	m_children	= reinterpret_cast<const range*>	(t_pos); t_pos += t_header.nodes * sizeof(range);
+	m_slots		= reinterpret_cast<const slot*>		(t_pos); t_pos += uintptr_t{t_header.slots} * sizeof(slot);
+	m_blob		= reinterpret_cast<const char32_t*>	(t_pos); t_pos += uintptr_t{t_header.blob} * sizeof(char32_t);
+	m_types		= reinterpret_cast<const ItemType*>	(t_pos);
+	m_size		= t_header.nodes;
+	m_mask		= t_header.slots - 1;
+}
+
+void frozen_document::detach()
+{
+	m_types		= nullptr;
+	m_names		= nullptr;
+	m_values	= nullptr;
+	m_children	= nullptr;
+	m_slots		= nullptr;
+	m_blob		= nullptr;
+	m_size		= 0;
+	m_mask		= 0;
+	m_image.clear();
+	m_mapped.reset();
+}
+
+//Leaves only the root
+Error frozen_document::fail(Error p_error)
+{
+	m_last_error.clear();
+	_p::Danger_Action::publicError(m_last_error).SetPlainError(p_error);
+	builder{}.finish(*this);
+	return p_error;
+}
+
+} //namespace scef
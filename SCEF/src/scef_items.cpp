@@ -27,6 +27,10 @@
 
 #include <SCEF/scef_items.hpp>
 
+#include <new>
+
+#include "scef_symbols_p.hpp"
+
 
 namespace scef
 {
@@ -39,7 +43,27 @@ _t_list_iterator::_t_list_iterator(const _list_iterator& p_node, const _list_ite
 	, _end	(p_end)
 	, _mask	(p_mask)
 {
-	while(_node != p_end && ((*_node)->type() & p_mask) == ItemType{})
+	skip();
+}
+
+_t_list_iterator::_t_list_iterator(const _list_iterator& p_end, ItemType p_mask, const ptrdiff_t* p_next)
+	: _node	(p_end + *p_next)
+	, _end	(p_end)
+	, _mask	(p_mask)
+	, _next	(*p_next ? p_next + 1 : p_next)
+{
+	skip();
+}
+
+//an item found through the index may have been replaced in place since, if it no longer matches go back to looking at every item
+void _t_list_iterator::skip()
+{
+	if(_next && (_node == _end || ((*_node)->type() & _mask) != ItemType{}))
+	{
+		return;
+	}
+	_next = nullptr;
+	while(_node != _end && ((*_node)->type() & _mask) == ItemType{})
 	{
 		++_node;
 	}
@@ -47,22 +71,23 @@ _t_list_iterator::_t_list_iterator(const _list_iterator& p_node, const _list_ite
 
 _t_list_iterator& _t_list_iterator::operator ++ () //++i
 {
-	++_node;
-	while(_node != _end && ((*_node)->type() & _mask) == ItemType{})
+	if(_next)
+	{
+		_node = _end + *_next;
+		if(*_next) ++_next;
+	}
+	else
 	{
 		++_node;
 	}
+	skip();
 	return *this;
 }
 
 _t_list_iterator _t_list_iterator::operator ++ (int) //i++
 {
 	_t_list_iterator t_otr = *this;
-	++_node;
-	while(_node != _end && ((*_node)->type() & _mask) == ItemType{})
-	{
-		++_node;
-	}
+	++*this;
 	return t_otr;
 }
 
@@ -70,10 +95,8 @@ _t_list_iterator _t_list_iterator::operator ++ (int) //i++
 void _t_list_iterator::reSetMask(ItemType p_mask)
 {
 	_mask = p_mask;
-	while(_node != _end && ((*_node)->type() & p_mask) == ItemType{})
-	{
-		++_node;
-	}
+	_next = nullptr;
+	skip();
 }
 
 //======== ======== class _t_list_const_iterator
@@ -81,6 +104,7 @@ _t_list_const_iterator::_t_list_const_iterator(const _t_list_iterator& p_other)
 	: _node	(p_other._node)
 	, _end	(p_other._end)
 	, _mask	(p_other._mask)
+	, _next	(p_other._next)
 {
 }
 
@@ -89,6 +113,7 @@ _t_list_const_iterator& _t_list_const_iterator::operator = (const _t_list_iterat
 	_node = p_other._node;
 	_end = p_other._end;
 	_mask = p_other._mask;
+	_next = p_other._next;
 	return *this;
 }
 
@@ -97,7 +122,26 @@ _t_list_const_iterator::_t_list_const_iterator(const _list_const_iterator& p_nod
 	, _end	(p_end)
 	, _mask	(p_mask)
 {
-	while(_node != p_end && ((*_node)->type() & p_mask) == ItemType{})
+	skip();
+}
+
+_t_list_const_iterator::_t_list_const_iterator(const _list_const_iterator& p_end, ItemType p_mask, const ptrdiff_t* p_next)
+	: _node	(p_end + *p_next)
+	, _end	(p_end)
+	, _mask	(p_mask)
+	, _next	(*p_next ? p_next + 1 : p_next)
+{
+	skip();
+}
+
+void _t_list_const_iterator::skip()
+{
+	if(_next && (_node == _end || ((*_node)->type() & _mask) != ItemType{}))
+	{
+		return;
+	}
+	_next = nullptr;
+	while(_node != _end && ((*_node)->type() & _mask) == ItemType{})
 	{
 		++_node;
 	}
@@ -105,32 +149,31 @@ _t_list_const_iterator::_t_list_const_iterator(const _list_const_iterator& p_nod
 
 _t_list_const_iterator& _t_list_const_iterator::operator ++ () //++i
 {
-	++_node;
-	while(_node != _end && ((*_node)->type() & _mask) == ItemType{})
+	if(_next)
+	{
+		_node = _end + *_next;
+		if(*_next) ++_next;
+	}
+	else
 	{
 		++_node;
 	}
+	skip();
 	return *this;
 }
 
 _t_list_const_iterator _t_list_const_iterator::operator ++ (int) //i++
 {
 	_t_list_const_iterator t_otr = *this;
-	++_node;
-	while(_node != _end && ((*_node)->type() & _mask) == ItemType{})
-	{
-		++_node;
-	}
+	++*this;
 	return t_otr;
 }
 
 void _t_list_const_iterator::reSetMask(ItemType p_mask)
 {
 	_mask = p_mask;
-	while(_node != _end && ((*_node)->type() & p_mask) == ItemType{})
-	{
-		++_node;
-	}
+	_next = nullptr;
+	skip();
 }
 
 //======== ======== class lineSpace
@@ -175,109 +218,678 @@ void multiLineSpace::append_spacing(uint64_t p_lines, const std::u8string& p_spa
 	}
 }
 
+//======== ======== item text
+//0xFE leads the 7 byte form used past 0x7FFFFFFF, it carries no bits of its own
+template<typename String>
+static void encode_text(std::u32string_view p_text, String& p_out)
+{
+	p_out.clear();
+	p_out.reserve(p_text.size());
+	for(const char32_t t_char : p_text)
+	{
+		const uint32_t t_val = static_cast<uint32_t>(t_char);
+		if(t_val < 0x80)
+		{
+			p_out.push_back(static_cast<char8_t>(t_val));
+			continue;
+		}
+
+		uint8_t t_extra;
+		uint32_t t_lead;
+		if		(t_val < 0x800)			{ t_extra = 1; t_lead = 0xC0 | (t_val >>  6); }
+		else if	(t_val < 0x10000)		{ t_extra = 2; t_lead = 0xE0 | (t_val >> 12); }
+		else if	(t_val < 0x200000)		{ t_extra = 3; t_lead = 0xF0 | (t_val >> 18); }
+		else if	(t_val < 0x4000000)		{ t_extra = 4; t_lead = 0xF8 | (t_val >> 24); }
+		else if	(t_val < 0x80000000)	{ t_extra = 5; t_lead = 0xFC | (t_val >> 30); }
+		else							{ t_extra = 6; t_lead = 0xFE; }
+
+		p_out.push_back(static_cast<char8_t>(t_lead));
+		while(t_extra--)
+		{
+			p_out.push_back(static_cast<char8_t>(0x80 | ((static_cast<uint64_t>(t_val) >> (6 * t_extra)) & 0x3F)));
+		}
+	}
+}
+
+static char32_t next_item_char(const char8_t*& p_it, const char8_t* p_end)
+{
+	const uint8_t t_lead = *(p_it++);
+	if(t_lead < 0x80) return t_lead;
+
+	uint8_t t_extra;
+	uint32_t t_val;
+	if		(t_lead < 0xC0) return 0xFFFD; //stray continuation byte
+	else if	(t_lead < 0xE0) { t_extra = 1; t_val = t_lead & 0x1F; }
+	else if	(t_lead < 0xF0) { t_extra = 2; t_val = t_lead & 0x0F; }
+	else if	(t_lead < 0xF8) { t_extra = 3; t_val = t_lead & 0x07; }
+	else if	(t_lead < 0xFC) { t_extra = 4; t_val = t_lead & 0x03; }
+	else if	(t_lead < 0xFE) { t_extra = 5; t_val = t_lead & 0x01; }
+	else if	(t_lead == 0xFE) { t_extra = 6; t_val = 0; }
+	else return 0xFFFD;
+
+	for(; t_extra; --t_extra)
+	{
+		if(p_it == p_end || (*p_it & 0xC0) != 0x80) return 0xFFFD;
+		t_val = (t_val << 6) | (*(p_it++) & 0x3F);
+	}
+	return static_cast<char32_t>(t_val);
+}
+
+template<typename String>
+static void decode_text(std::u8string_view p_text, String& p_out)
+{
+	p_out.clear();
+	p_out.reserve(p_text.size());
+	const char8_t* it = p_text.data();
+	const char8_t* const it_end = it + p_text.size();
+	while(it != it_end)
+	{
+		p_out.push_back(next_item_char(it, it_end));
+	}
+}
+
+void encode_item_text(std::u32string_view p_text, std::u8string&		p_out) { encode_text(p_text, p_out); }
+void encode_item_text(std::u32string_view p_text, std::pmr::u8string&	p_out) { encode_text(p_text, p_out); }
+void decode_item_text(std::u8string_view p_text, std::u32string&		p_out) { decode_text(p_text, p_out); }
+void decode_item_text(std::u8string_view p_text, std::pmr::u32string&	p_out) { decode_text(p_text, p_out); }
+
+bool equal_item_text(std::u8string_view p_utf8, std::u32string_view p_utf32)
+{
+	//a code point never takes fewer bytes than it takes char32_t
+	if(p_utf8.size() < p_utf32.size()) return false;
+
+	const char8_t* it = p_utf8.data();
+	const char8_t* const it_end = it + p_utf8.size();
+	for(const char32_t t_char : p_utf32)
+	{
+		if(it == it_end || next_item_char(it, it_end) != t_char) return false;
+	}
+	return it == it_end;
+}
+
+//======== ======== class item_text
+void item_text::convert(bool p_utf8, bool p_to_utf8)
+{
+	if(p_utf8 == p_to_utf8) return;
+
+	if(p_to_utf8)
+	{
+		std::pmr::u8string t_text{u32.get_allocator()};
+		encode_item_text(u32, t_text);
+		u32.~basic_string();
+		new (&u8) std::pmr::u8string{std::move(t_text)};
+	}
+	else
+	{
+		std::pmr::u32string t_text{u8.get_allocator()};
+		decode_item_text(u8, t_text);
+		u8.~basic_string();
+		new (&u32) std::pmr::u32string{std::move(t_text)};
+	}
+}
+
+//======== ======== class NamedItem
+NamedItem& NamedItem::operator = (const NamedItem& p_other)
+{
+	if(this == &p_other) return *this;
+	if(_indexed) renamed();
+	_quotation_mode = p_other._quotation_mode;
+
+	if(p_other._interned)
+	{
+		p_other._name.sym->acquire();
+		if(_interned) _name.sym->release();
+		else _name.destroy(_utf8);
+		_name.sym = p_other._name.sym;
+	}
+	else if(p_other._utf8)
+	{
+		std::pmr::u8string t_text{p_other._name.u8, _resource};
+		if(_interned) _name.sym->release();
+		else _name.destroy(_utf8);
+		new (&_name.u8) std::pmr::u8string{std::move(t_text)};
+	}
+	else
+	{
+		std::pmr::u32string t_text{p_other._name.u32, _resource};
+		if(_interned) _name.sym->release();
+		else _name.destroy(_utf8);
+		new (&_name.u32) std::pmr::u32string{std::move(t_text)};
+	}
+	_utf8 = p_other._utf8;
+	_interned = p_other._interned;
+	return *this;
+}
+
+void NamedItem::convert_name(bool p_utf8)
+{
+	if(_interned)
+	{
+		if(!p_utf8) return;
+		release_symbol(true);
+	}
+	_name.convert(_utf8, p_utf8);
+	_utf8 = p_utf8;
+}
+
+//interned names are only ever UTF-32
+void NamedItem::release_symbol(bool p_keep)
+{
+	const symbol_entry* const t_entry = _name.sym;
+	new (&_name.u32) std::pmr::u32string{_resource};
+	_interned = false;
+	if(p_keep) _name.u32 = t_entry->name;
+	t_entry->release();
+}
+
+void NamedItem::set_name(symbol p_symbol)
+{
+	if(_indexed) renamed();
+	if(!p_symbol)
+	{
+		clear_name();
+	}
+	else if(_utf8)
+	{
+		_name.assign(true, p_symbol.view());
+	}
+	else
+	{
+		if(_interned) _name.sym->release();
+		else _name.destroy(false);
+		//the reference of p_symbol goes to the item
+		_name.sym = std::exchange(p_symbol.m_entry, nullptr);
+		_interned = true;
+	}
+}
+
 } //namespace _p
 
 
 //======== ======== class ItemList
 
-itemProxy<group> ItemList::find_group_by_name(std::u32string_view p_name)
+static inline bool match_name(const _p::NamedItem& p_item, std::u32string_view p_name)
+{
+	if(p_item.utf8()) return _p::equal_item_text(p_item.view_name_u8(), p_name);
+	return p_item.view_name() == p_name;
+}
+
+static inline bool match_name(const _p::NamedItem& p_item, std::u8string_view p_name)
+{
+	if(p_item.utf8()) return p_item.view_name_u8() == p_name;
+	return _p::equal_item_text(p_name, p_item.view_name());
+}
+
+//symbols of the same table are the same name only if they are the same symbol
+static inline bool match_name(const _p::NamedItem& p_item, const symbol& p_name)
+{
+	const _p::symbol_entry* t_entry = p_item.name_entry();
+	if(t_entry && t_entry->table == p_name.entry()->table) return t_entry == p_name.entry();
+	return match_name(p_item, p_name.view());
+}
+
+template<typename T>
+static inline const _p::NamedItem* named_item(const item& p_item)
+{
+	return static_cast<const T*>(&p_item);
+}
+
+//the item's name, or nullptr if the item has none
+static inline const _p::NamedItem* name_of(const item& p_item)
 {
-	using type = group;
-	for(const itemProxy<item>& tobj: *this)
+	switch(p_item.type())
 	{
-		if(tobj->type() == type::static_type())
-		{
-			if(std::u32string_view{static_cast<type*>(tobj.get())->name()} == p_name)
-			{
-				return std::static_pointer_cast<type>(tobj);
-			}
-		}
+		case ItemType::group:		return named_item<group>(p_item);
+		case ItemType::singlet:		return named_item<singlet>(p_item);
+		case ItemType::key_value:	return named_item<keyedValue>(p_item);
+		default:
+			break;
 	}
-	return {};
+	return nullptr;
+}
+
+//FNV-1a over code points, so that both encodings of a name hash the same
+static uint32_t hash_name(std::u32string_view p_name)
+{
+	uint32_t t_hash = 0x811C9DC5;
+	for(const char32_t t_char : p_name)
+	{
+		t_hash = (t_hash ^ static_cast<uint32_t>(t_char)) * 0x01000193;
+	}
+	return t_hash;
+}
+
+static uint32_t hash_name(std::u8string_view p_name)
+{
+	uint32_t t_hash = 0x811C9DC5;
+	const char8_t* it = p_name.data();
+	const char8_t* const it_end = it + p_name.size();
+	while(it != it_end)
+	{
+		t_hash = (t_hash ^ static_cast<uint32_t>(_p::next_item_char(it, it_end))) * 0x01000193;
+	}
+	return t_hash;
+}
+
+static inline uint32_t hash_name(const symbol& p_name)
+{
+	return p_name.entry()->hash;
+}
+
+static inline uint32_t hash_name(const _p::NamedItem& p_item)
+{
+	if(const _p::symbol_entry* t_entry = p_item.name_entry()) return t_entry->hash;
+	return p_item.utf8() ? hash_name(p_item.view_name_u8()) : hash_name(p_item.view_name());
+}
+
+namespace _p
+{
+
+//bumped by renaming an item any list indexed, which makes every name index out of date
+static std::atomic<uint64_t> g_renames = 0;
+
+void NamedItem::renamed() const
+{
+	g_renames.fetch_add(1, std::memory_order_release);
 }
 
-itemProxy<singlet> ItemList::find_singlet_by_name(std::u32string_view p_name)
+//open addressing table from the hash of a name to where the item is in the list
+//it is a snapshot, taken for a list with a given buffer, size and count of changes, and is only used while the list still has them
+class name_index
 {
-	using type = singlet;
-	for(const itemProxy<item>& tobj: *this)
+public:
+	struct slot
+	{
+		uint32_t hash;
+		uint32_t pos;	//position in the list + 1, 0 for an empty slot
+	};
+
+	[[nodiscard]] inline bool current(const _p_item_list& p_list, uint64_t p_changes) const
+	{
+		return p_changes == m_changes && p_list.data() == m_data && p_list.size() == m_size
+			&& g_renames.load(std::memory_order_acquire) == m_renames;
+	}
+
+	void build(const _p_item_list& p_list, uint64_t p_changes)
+	{
+		//renames from here on are counted against this index
+		m_renames = g_renames.load(std::memory_order_acquire);
+		m_changes = p_changes;
+		m_data = p_list.data();
+		m_size = p_list.size();
+
+		uintptr_t t_capacity = 16;
+		while(t_capacity < m_size * 2) t_capacity *= 2;
+		m_slots.assign(t_capacity, slot{0, 0});
+		m_mask = t_capacity - 1;
+
+		for(uintptr_t i = 0; i < m_size; ++i)
+		{
+			const NamedItem* t_named = name_of(*p_list[i]);
+			if(!t_named) continue;
+			t_named->_indexed = true;
+			const uint32_t t_hash = hash_name(*t_named);
+			//items that come first are found first, as their slots come first when probing from the same start
+			uintptr_t t_slot = t_hash & m_mask;
+			while(m_slots[t_slot].pos) t_slot = (t_slot + 1) & m_mask;
+			m_slots[t_slot] = slot{t_hash, static_cast<uint32_t>(i + 1)};
+		}
+	}
+
+	template<typename T, typename Name>
+	[[nodiscard]] T* find(const _p_item_list& p_list, const Name& p_name) const
 	{
-		if(tobj->type() == singlet::static_type())
+		const uint32_t t_hash = hash_name(p_name);
+		for(uintptr_t t_slot = t_hash & m_mask; m_slots[t_slot].pos; t_slot = (t_slot + 1) & m_mask)
 		{
-			if(std::u32string_view{static_cast<type*>(tobj.get())->name()} == p_name)
+			if(m_slots[t_slot].hash != t_hash) continue;
+
+			item* const t_item = p_list[m_slots[t_slot].pos - 1].get();
+			if(t_item->type() == T::static_type() && match_name(*name_of(*t_item), p_name))
 			{
-				return std::static_pointer_cast<type>(tobj);
+				return static_cast<T*>(t_item);
 			}
 		}
+		return nullptr;
 	}
-	return {};
-}
 
-itemProxy<keyedValue> ItemList::find_key_by_name(std::u32string_view p_name)
+private:
+	const itemProxy<item>*	m_data = nullptr;
+	uintptr_t				m_size = 0;
+	uint64_t				m_changes = 0;
+	uint64_t				m_renames = 0;
+	uintptr_t				m_mask = 0;
+	std::vector<slot>		m_slots;
+};
+
+//where the items that match a mask are in the list, one array for each mask the list was indexed by
+//the arrays hold positions from the end of the list and end with 0, see _t_list_iterator::_next
+//it is a snapshot, taken for a list with a given buffer, size and count of changes, an item's type never changes so that is all it depends on
+class type_index
 {
-	using type = keyedValue;
-	for(const itemProxy<item>& tobj: *this)
+public:
+	[[nodiscard]] inline bool current(const _p_item_list& p_list, uint64_t p_changes) const
 	{
-		if(tobj->type() == type::static_type())
+		return p_changes == m_changes && p_list.data() == m_data && p_list.size() == m_size;
+	}
+
+	[[nodiscard]] const ptrdiff_t* find(ItemType p_mask) const
+	{
+		for(const entry& t_entry : m_entries)
 		{
-			if(std::u32string_view{static_cast<type*>(tobj.get())->name()} == p_name)
-			{
-				return std::static_pointer_cast<type>(tobj);
-			}
+			if(t_entry.mask == p_mask) return t_entry.next.data();
 		}
+		return nullptr;
 	}
-	return {};
-}
 
-itemProxy<const group> ItemList::find_group_by_name(std::u32string_view p_name) const
+	//arrays of other masks are kept as long as the index is current, as iterators may be using them
+	void build(const _p_item_list& p_list, uint64_t p_changes, ItemType p_mask)
+	{
+		if(!current(p_list, p_changes))
+		{
+			m_entries.clear();
+			m_changes = p_changes;
+			m_data = p_list.data();
+			m_size = p_list.size();
+		}
+
+		entry* t_entry = nullptr;
+		for(entry& t_other : m_entries)
+		{
+			if(t_other.mask == p_mask) t_entry = &t_other;
+		}
+		if(!t_entry)
+		{
+			t_entry = &m_entries.emplace_back();
+			t_entry->mask = p_mask;
+		}
+
+		//items put in place of others are picked up by building again
+		t_entry->next.clear();
+		const ptrdiff_t t_size = static_cast<ptrdiff_t>(m_size);
+		for(ptrdiff_t i = 0; i < t_size; ++i)
+		{
+			if((p_list[i]->type() & p_mask) != ItemType{}) t_entry->next.push_back(i - t_size);
+		}
+		t_entry->next.push_back(0);
+	}
+
+private:
+	struct entry
+	{
+		ItemType				mask;
+		std::vector<ptrdiff_t>	next;
+	};
+
+	std::vector<entry>			m_entries;
+	const itemProxy<item>*		m_data = nullptr;
+	uintptr_t					m_size = 0;
+	uint64_t					m_changes = 0;
+};
+
+} //namespace _p
+
+template<typename T, typename List, typename Name>
+static itemRef<T> scan_by_name(List& p_list, const Name& p_name)
 {
-	using type = const group;
-	for(const itemProxy<item>& tobj: *this)
+	for(const itemProxy<item>& tobj: p_list)
 	{
-		if(tobj->type() == type::static_type())
+		if(tobj->type() == T::static_type())
 		{
-			if(std::u32string_view{static_cast<type*>(tobj.get())->name()} == p_name)
+			T* t_item = static_cast<T*>(tobj.get());
+			if(match_name(*t_item, p_name))
 			{
-				return std::static_pointer_cast<type>(tobj);
+				return itemRef<T>{t_item};
 			}
 		}
 	}
 	return {};
 }
 
-itemProxy<const singlet> ItemList::find_singlet_by_name(std::u32string_view p_name) const
+//only ever reads the index, which is used while current, including to tell the name is not there
+template<typename T, typename Name>
+static itemRef<T> find_by_name(const ItemList& p_list, const _p::name_index* p_names, uint64_t p_changes, const Name& p_name)
+{
+	if constexpr(std::is_same_v<Name, symbol>)
+	{
+		if(!p_name) return {};
+	}
+	if(p_names && p_names->current(p_list, p_changes))
+	{
+		return itemRef<T>{p_names->find<T>(p_list, p_name)};
+	}
+	return scan_by_name<T>(p_list, p_name);
+}
+
+ItemList::ItemList() = default;
+ItemList::ItemList(const ItemList& p_other): _p::_p_item_list(p_other) {}
+ItemList::ItemList(ItemList&& p_other) noexcept = default;
+ItemList::~ItemList() = default;
+
+ItemList& ItemList::operator = (const ItemList& p_other)
+{
+	_p::_p_item_list::operator = (p_other);
+	m_names.reset();
+	m_types.reset();
+	return *this;
+}
+
+ItemList& ItemList::operator = (ItemList&& p_other) noexcept = default;
+
+void ItemList::index_names()
+{
+	if(size() >= UINT32_MAX)
+	{
+		m_names.reset();
+		return;
+	}
+	if(!m_names) m_names = std::make_unique<_p::name_index>();
+	m_names->build(*this, m_changes);
+}
+
+void ItemList::drop_name_index()
+{
+	m_names.reset();
+}
+
+void ItemList::index_types(ItemType p_type)
+{
+	if(!m_types) m_types = std::make_unique<_p::type_index>();
+	m_types->build(*this, m_changes, p_type);
+}
+
+void ItemList::drop_type_index()
+{
+	m_types.reset();
+}
+
+const ptrdiff_t* ItemList::indexed_types(ItemType p_type) const
+{
+	if(m_types && m_types->current(*this, m_changes)) return m_types->find(p_type);
+	return nullptr;
+}
+
+type_iterator ItemList::typed_begin(ItemType p_type)
+{
+	if(const ptrdiff_t* t_next = indexed_types(p_type))
+	{
+		return type_iterator{end(), p_type, t_next};
+	}
+	return type_iterator{begin(), end(), p_type};
+}
+
+const_type_iterator ItemList::typed_begin(ItemType p_type) const
+{
+	if(const ptrdiff_t* t_next = indexed_types(p_type))
+	{
+		return const_type_iterator{cend(), p_type, t_next};
+	}
+	return const_type_iterator{cbegin(), cend(), p_type};
+}
+
+itemRef<group>				ItemList::find_group_by_name	(std::u32string_view p_name)		{ return find_by_name<group>		(*this, m_names.get(), m_changes, p_name); }
+itemRef<singlet>			ItemList::find_singlet_by_name	(std::u32string_view p_name)		{ return find_by_name<singlet>		(*this, m_names.get(), m_changes, p_name); }
+itemRef<keyedValue>			ItemList::find_key_by_name		(std::u32string_view p_name)		{ return find_by_name<keyedValue>	(*this, m_names.get(), m_changes, p_name); }
+itemRef<const group>		ItemList::find_group_by_name	(std::u32string_view p_name) const	{ return find_by_name<const group>		(*this, m_names.get(), m_changes, p_name); }
+itemRef<const singlet>		ItemList::find_singlet_by_name	(std::u32string_view p_name) const	{ return find_by_name<const singlet>	(*this, m_names.get(), m_changes, p_name); }
+itemRef<const keyedValue>	ItemList::find_key_by_name		(std::u32string_view p_name) const	{ return find_by_name<const keyedValue>	(*this, m_names.get(), m_changes, p_name); }
+
+itemRef<group>				ItemList::find_group_by_name	(std::u8string_view p_name)			{ return find_by_name<group>		(*this, m_names.get(), m_changes, p_name); }
+itemRef<singlet>			ItemList::find_singlet_by_name	(std::u8string_view p_name)			{ return find_by_name<singlet>		(*this, m_names.get(), m_changes, p_name); }
+itemRef<keyedValue>			ItemList::find_key_by_name		(std::u8string_view p_name)			{ return find_by_name<keyedValue>	(*this, m_names.get(), m_changes, p_name); }
+itemRef<const group>		ItemList::find_group_by_name	(std::u8string_view p_name) const	{ return find_by_name<const group>		(*this, m_names.get(), m_changes, p_name); }
+itemRef<const singlet>		ItemList::find_singlet_by_name	(std::u8string_view p_name) const	{ return find_by_name<const singlet>	(*this, m_names.get(), m_changes, p_name); }
+itemRef<const keyedValue>	ItemList::find_key_by_name		(std::u8string_view p_name) const	{ return find_by_name<const keyedValue>	(*this, m_names.get(), m_changes, p_name); }
+
+itemRef<group>				ItemList::find_group_by_name	(symbol p_name)						{ return find_by_name<group>		(*this, m_names.get(), m_changes, p_name); }
+itemRef<singlet>			ItemList::find_singlet_by_name	(symbol p_name)						{ return find_by_name<singlet>		(*this, m_names.get(), m_changes, p_name); }
+itemRef<keyedValue>			ItemList::find_key_by_name		(symbol p_name)						{ return find_by_name<keyedValue>	(*this, m_names.get(), m_changes, p_name); }
+itemRef<const group>		ItemList::find_group_by_name	(symbol p_name) const				{ return find_by_name<const group>		(*this, m_names.get(), m_changes, p_name); }
+itemRef<const singlet>		ItemList::find_singlet_by_name	(symbol p_name) const				{ return find_by_name<const singlet>	(*this, m_names.get(), m_changes, p_name); }
+itemRef<const keyedValue>	ItemList::find_key_by_name		(symbol p_name) const				{ return find_by_name<const keyedValue>	(*this, m_names.get(), m_changes, p_name); }
+
+namespace _p
+{
+
+//======== ======== class symbol_entry
+void symbol_entry::acquire() const
+{
+	if(refs.fetch_add(1, std::memory_order_relaxed) == 0) table->acquire();
+}
+
+//the entry is not touched once its last reference is given back, the table may drop it at any point after
+void symbol_entry::release() const
+{
+	const symbol_table* const t_table = table;
+	if(refs.fetch_sub(1, std::memory_order_acq_rel) == 1) t_table->release();
+}
+
+//======== ======== class symbol_table
+symbol_table::shard::shard(std::pmr::memory_resource* p_resource)
+	: m_lookup(p_resource)
 {
-	using type = const singlet;
-	for(const itemProxy<item>& tobj: *this)
+}
+
+symbol_table::symbol_table(std::pmr::memory_resource* p_resource)
+	: m_resource(p_resource)
+{
+	for(uint32_t i = 0; i < (1u << shard_bits); ++i)
 	{
-		if(tobj->type() == type::static_type())
+		m_shards.emplace_back(p_resource);
+	}
+}
+
+//nothing refers to any of the entries by now
+symbol_table::~symbol_table()
+{
+	std::pmr::polymorphic_allocator<symbol_entry> t_alloc{m_resource};
+	for(shard& t_shard : m_shards)
+	{
+		for(const auto& t_pair : t_shard.m_lookup)
 		{
-			if(std::u32string_view{static_cast<type*>(tobj.get())->name()} == p_name)
-			{
-				return std::static_pointer_cast<type>(tobj);
-			}
+			t_alloc.delete_object(t_pair.second);
 		}
 	}
-	return {};
 }
 
-itemProxy<const keyedValue> ItemList::find_key_by_name(std::u32string_view p_name) const
+std::shared_ptr<symbol_table> symbol_table::make(std::pmr::memory_resource* p_resource)
+{
+	return std::shared_ptr<symbol_table>{new symbol_table(p_resource), [](symbol_table* p_table) { p_table->release(); }};
+}
+
+void symbol_table::acquire() const
+{
+	m_refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void symbol_table::release() const
+{
+	if(m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+}
+
+symbol symbol_table::intern(std::u32string_view p_name)
+{
+	const uint32_t t_hash = hash_name(p_name);
+	shard& t_shard = m_shards[t_hash >> (32 - shard_bits)];
+
+	//the reference is taken under the lock, so that sweep does not drop the entry first
+	std::lock_guard t_guard{t_shard.m_lock};
+	const auto it = t_shard.m_lookup.find(key{p_name, t_hash});
+	if(it != t_shard.m_lookup.end()) return symbol{it->second};
+
+	symbol_entry* const t_entry = std::pmr::polymorphic_allocator<symbol_entry>{m_resource}.new_object<symbol_entry>(this, t_hash, p_name);
+	t_shard.m_lookup.emplace(key{t_entry->name, t_hash}, t_entry);
+	return symbol{t_entry};
+}
+
+symbol symbol_table::find(std::u32string_view p_name) const
+{
+	const uint32_t t_hash = hash_name(p_name);
+	const shard& t_shard = m_shards[t_hash >> (32 - shard_bits)];
+
+	std::lock_guard t_guard{t_shard.m_lock};
+	const auto it = t_shard.m_lookup.find(key{p_name, t_hash});
+	return it == t_shard.m_lookup.end() ? symbol{} : symbol{it->second};
+}
+
+void symbol_table::sweep()
 {
-	using type = const keyedValue;
-	for(const itemProxy<item>& tobj: *this)
+	std::pmr::polymorphic_allocator<symbol_entry> t_alloc{m_resource};
+	for(shard& t_shard : m_shards)
 	{
-		if(tobj->type() == type::static_type())
+		std::lock_guard t_guard{t_shard.m_lock};
+		for(auto it = t_shard.m_lookup.begin(); it != t_shard.m_lookup.end();)
 		{
-			if(std::u32string_view{static_cast<type*>(tobj.get())->name()} == p_name)
+			if(it->second->refs.load(std::memory_order_acquire) != 0)
 			{
-				return std::static_pointer_cast<type>(tobj);
+				++it;
+				continue;
 			}
+			symbol_entry* const t_entry = it->second;
+			it = t_shard.m_lookup.erase(it);
+			t_alloc.delete_object(t_entry);
 		}
 	}
-	return {};
 }
 
+} //namespace _p
 
+//======== ======== class comment
+void comment::set_utf8(bool p_utf8)
+{
+	_text.convert(_utf8, p_utf8);
+	_utf8 = p_utf8;
+}
+
+//======== ======== class keyedValue
+void keyedValue::set_utf8(bool p_utf8)
+{
+	_value.convert(_value_utf8, p_utf8);
+	_value_utf8 = p_utf8;
+	convert_name(p_utf8);
+}
 
 item::~item() = default;
 
+group::~group()
+{
+	//groups that would be destroyed with this one give their children to t_pending first
+	_p::_p_item_list t_pending;
+	t_pending.swap(*this);
+	while(!t_pending.empty())
+	{
+		itemProxy<item> t_item = std::move(t_pending.back());
+		t_pending.pop_back();
+		if(t_item->type() == ItemType::group && t_item.use_count() == 1)
+		{
+			_p::_p_item_list& t_children = *static_cast<group*>(t_item.get());
+			for(itemProxy<item>& t_child : t_children)
+			{
+				t_pending.push_back(std::move(t_child));
+			}
+			t_children.clear();
+		}
+	}
+}
+
 } //namespace scef
@@ -29,11 +29,31 @@
 
 #include <cstring>
 
+#ifdef _WIN32
+#	ifndef NOMINMAX
+#		define NOMINMAX
+#	endif
+#	ifndef WIN32_LEAN_AND_MEAN
+#		define WIN32_LEAN_AND_MEAN
+#	endif
+#	include <Windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
 namespace scef
 {
 
 base_istreamer::~base_istreamer() = default;
 
+std::span<const char8_t> base_istreamer::contiguous_view() const
+{
+	return {};
+}
+
 base_ostreamer::~base_ostreamer() = default;
 
 
@@ -133,12 +153,134 @@ stream_error file_ostream::write(const void* p_buffer, uintptr_t p_size)
 	return stream_error::Unable2Read;
 }
 
+//======== ======== class: mmap_istream ======== ========
+//Note:
+//	1. Empty files can not be mapped, they are represented by a non-null address with size 0
+static const char8_t g_empty_map = 0;
+
+mmap_istream::~mmap_istream()
+{
+	close();
+}
+
+bool mmap_istream::open(const std::filesystem::path& p_file)
+{
+	close();
+
+#ifdef _WIN32
+	HANDLE t_file = CreateFileW(p_file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if(t_file == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER t_size;
+	if(!GetFileSizeEx(t_file, &t_size))
+	{
+		CloseHandle(t_file);
+		return false;
+	}
+
+	if(t_size.QuadPart == 0)
+	{
+		CloseHandle(t_file);
+		_first = _pivot = &g_empty_map;
+		_size = 0;
+		return true;
+	}
+
+	HANDLE t_map = CreateFileMappingW(t_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(t_file);
+	if(t_map == nullptr) return false;
+
+	void* t_view = MapViewOfFile(t_map, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(t_map);
+	if(t_view == nullptr) return false;
+
+	_size = static_cast<uint64_t>(t_size.QuadPart);
+#else
+	const int t_file = ::open(p_file.c_str(), O_RDONLY | O_CLOEXEC);
+	if(t_file < 0) return false;
+
+	struct stat t_stat;
+	if(fstat(t_file, &t_stat) != 0 || !S_ISREG(t_stat.st_mode))
+	{
+		::close(t_file);
+		return false;
+	}
+
+	if(t_stat.st_size == 0)
+	{
+		::close(t_file);
+		_first = _pivot = &g_empty_map;
+		_size = 0;
+		return true;
+	}
+
+	void* t_view = mmap(nullptr, static_cast<size_t>(t_stat.st_size), PROT_READ, MAP_PRIVATE, t_file, 0);
+	::close(t_file);
+	if(t_view == MAP_FAILED) return false;
+
+	madvise(t_view, static_cast<size_t>(t_stat.st_size), MADV_SEQUENTIAL);
+	_size = static_cast<uint64_t>(t_stat.st_size);
+#endif
+
+	_first = _pivot = reinterpret_cast<const char8_t*>(t_view);
+	return true;
+}
+
+void mmap_istream::close()
+{
+	if(_first != nullptr && _first != &g_empty_map)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(_first);
+#else
+		munmap(const_cast<char8_t*>(_first), static_cast<size_t>(_size));
+#endif
+	}
+	_first	= nullptr;
+	_pivot	= nullptr;
+	_size	= 0;
+}
+
+uintptr_t mmap_istream::read(void* p_buffer, uintptr_t p_size)
+{
+	uintptr_t rem = static_cast<uintptr_t>(remaining());
+	if(p_size < rem) rem = p_size;
+	memcpy(p_buffer, _pivot, rem);
+	_pivot += rem;
+	return rem;
+}
+
+stream_error mmap_istream::stat() const
+{
+	if(_first == nullptr) return stream_error::Unable2Read;
+	return pos() < _size ? stream_error::None : stream_error::Control_EndOfStream;
+}
+
+uint64_t mmap_istream::pos() const
+{
+	return static_cast<uint64_t>(_pivot - _first);
+}
+
+void mmap_istream::set_pos(uint64_t p_pos)
+{
+	if(p_pos <= _size)
+	{
+		_pivot = _first + p_pos;
+	}
+}
+
+std::span<const char8_t> mmap_istream::contiguous_view() const
+{
+	return {_pivot, static_cast<uintptr_t>(remaining())};
+}
+
 //======== ======== class: buffer_istream ======== ========
 buffer_istream::buffer_istream(const void* p_first, const void* p_last)
 	: _first{p_first}
 	, _last {p_last}
 	, _pivot{reinterpret_cast<const char8_t*>(p_first)}
 {
+	_size = reinterpret_cast<uintptr_t>(p_last) - reinterpret_cast<uintptr_t>(p_first);
 }
 
 buffer_istream::buffer_istream(const void* p_buff, uintptr_t p_size)
@@ -146,6 +288,7 @@ buffer_istream::buffer_istream(const void* p_buff, uintptr_t p_size)
 	, _last {reinterpret_cast<const char8_t*>(p_buff) + p_size}
 	, _pivot{reinterpret_cast<const char8_t*>(p_buff)}
 {
+	_size = p_size;
 }
 
 uintptr_t buffer_istream::read(void* p_buffer, uintptr_t p_size)
@@ -175,4 +318,9 @@ void buffer_istream::set_pos(uint64_t p_pos)
 	}
 }
 
+std::span<const char8_t> buffer_istream::contiguous_view() const
+{
+	return {_pivot, reinterpret_cast<const char8_t*>(_last)};
+}
+
 }	// namespace scef
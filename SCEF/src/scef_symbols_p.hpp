@@ -0,0 +1,101 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+#include <SCEF/scef_items.hpp>
+
+namespace scef::_p
+{
+
+///	\brief
+///		The names interned by a document loaded with Flag::InternNames, each one stored once for all the items that have it.
+///		The table lives for as long as the document that made it, or anything refers to one of its entries.
+///		Entries stay put for as long as they are referred to, and are dropped by \ref sweep after. Interning is thread safe
+class symbol_table
+{
+	friend struct symbol_entry;
+public:
+	[[nodiscard]] static std::shared_ptr<symbol_table> make(std::pmr::memory_resource* p_resource);
+
+	symbol_table(const symbol_table&) = delete;
+	symbol_table& operator = (const symbol_table&) = delete;
+
+	[[nodiscard]] symbol intern(std::u32string_view p_name);
+	[[nodiscard]] symbol find(std::u32string_view p_name) const;
+
+	///	\brief Drops the entries nothing refers to any more, so that loading again does not keep growing the table
+	void sweep();
+
+private:
+	explicit symbol_table(std::pmr::memory_resource* p_resource);
+	~symbol_table();
+
+	//held once by whoever made the table, and once for every entry that is referred to
+	void acquire() const;
+	void release() const;
+
+	struct key
+	{
+		std::u32string_view	name;
+		uint32_t			hash;
+
+		inline bool operator == (const key& p_other) const { return name == p_other.name; }
+	};
+
+	struct key_hash
+	{
+		inline std::size_t operator () (const key& p_key) const { return p_key.hash; }
+	};
+
+	//names are split by hash, so that threads loading in parallel rarely wait on each other
+	struct shard
+	{
+		explicit shard(std::pmr::memory_resource* p_resource);
+
+		mutable std::mutex	m_lock;
+		std::pmr::unordered_map<key, symbol_entry*, key_hash>	m_lookup;	//owns the entries
+	};
+
+	static constexpr uint32_t shard_bits = 4;
+
+	mutable std::atomic<uintptr_t>	m_refs = 1;
+	std::pmr::memory_resource*		m_resource;
+	std::deque<shard>				m_shards;
+};
+
+} //namespace scef::_p
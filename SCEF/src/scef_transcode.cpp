@@ -0,0 +1,836 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#include "scef_transcode.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <CoreLib/string/core_string_encoding.hpp>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#	define SCEF_TRANSCODE_X64
+#	include <immintrin.h>
+#	ifdef _MSC_VER
+#		include <intrin.h>
+#		define SCEF_TARGET_AVX2
+#	else
+#		define SCEF_TARGET_AVX2 __attribute__((target("avx2")))
+#	endif
+#endif
+
+namespace scef::ENCODER_P
+{
+
+namespace
+{
+
+using widen_f		= uintptr_t (*)(const char8_t*, uintptr_t, char32_t*);
+using narrow_f	= uintptr_t (*)(const char32_t*, uintptr_t, char8_t*);
+using copy32_f	= uintptr_t (*)(const char8_t*, uintptr_t, char8_t*);
+using index_f	= void (*)(const char32_t*, uintptr_t, uint64_t*);
+
+//======== ======== scalar ======== ========
+template<bool t_ascii_only>
+uintptr_t widen_scalar(const char8_t* p_in, uintptr_t p_size, char32_t* p_out)
+{
+	uintptr_t it = 0;
+	for(; it < p_size; ++it)
+	{
+		if constexpr(t_ascii_only)
+		{
+			if(p_in[it] & 0x80) break;
+		}
+		p_out[it] = p_in[it];
+	}
+	return it;
+}
+
+uintptr_t narrow_ascii_scalar(const char32_t* p_in, uintptr_t p_size, char8_t* p_out)
+{
+	uintptr_t it = 0;
+	for(; it < p_size; ++it)
+	{
+		if(p_in[it] > 0x7F) break;
+		p_out[it] = static_cast<char8_t>(p_in[it]);
+	}
+	return it;
+}
+
+template<bool t_big>
+inline char16_t load_UTF16(const char8_t* p_in)
+{
+	if constexpr(t_big)	return static_cast<char16_t>((char16_t{p_in[0]} << 8) | p_in[1]);
+	else				return static_cast<char16_t>((char16_t{p_in[1]} << 8) | p_in[0]);
+}
+
+template<bool t_big>
+inline void store_UTF16(char8_t* p_out, char16_t p_unit)
+{
+	if constexpr(t_big)
+	{
+		p_out[0] = static_cast<char8_t>(p_unit >> 8);
+		p_out[1] = static_cast<char8_t>(p_unit);
+	}
+	else
+	{
+		p_out[0] = static_cast<char8_t>(p_unit);
+		p_out[1] = static_cast<char8_t>(p_unit >> 8);
+	}
+}
+
+//up to the first surrogate, sizes are in units
+template<bool t_big>
+uintptr_t widen16_scalar(const char8_t* p_in, uintptr_t p_size, char32_t* p_out)
+{
+	uintptr_t it = 0;
+	for(; it < p_size; ++it)
+	{
+		const char16_t unit = load_UTF16<t_big>(p_in + it * 2);
+		if((unit & 0xF800) == 0xD800) break;
+		p_out[it] = unit;
+	}
+	return it;
+}
+
+//up to the first character that is not below 0xD800, sizes are in units
+template<bool t_big>
+uintptr_t narrow16_scalar(const char32_t* p_in, uintptr_t p_size, char8_t* p_out)
+{
+	uintptr_t it = 0;
+	for(; it < p_size; ++it)
+	{
+		if(p_in[it] > 0xD7FF) break;
+		store_UTF16<t_big>(p_out + it * 2, static_cast<char16_t>(p_in[it]));
+	}
+	return it;
+}
+
+template<bool t_big>
+inline char32_t load_UCS4(const char8_t* p_in)
+{
+	if constexpr(t_big)
+	{
+		return (char32_t{p_in[0]} << 24) | (char32_t{p_in[1]} << 16) | (char32_t{p_in[2]} << 8) | char32_t{p_in[3]};
+	}
+	else
+	{
+		return (char32_t{p_in[3]} << 24) | (char32_t{p_in[2]} << 16) | (char32_t{p_in[1]} << 8) | char32_t{p_in[0]};
+	}
+}
+
+//Reads in the given byte order and writes in the host's, sizes are in characters.
+//Since swapping is its own inverse, this also converts from the host's byte order to the given one.
+//The strict version stops at the first character that is not below 0xD800.
+template<bool t_big, bool t_strict>
+uintptr_t copy32_scalar(const char8_t* p_in, uintptr_t p_size, char8_t* p_out)
+{
+	uintptr_t it = 0;
+	for(; it < p_size; ++it)
+	{
+		const char32_t r = load_UCS4<t_big>(p_in + it * 4);
+		if constexpr(t_strict)
+		{
+			if(r > 0xD7FF) break;
+		}
+		memcpy(p_out + it * 4, &r, 4);
+	}
+	return it;
+}
+
+//up to 64 characters
+inline uint64_t index_bits_scalar(const char32_t* p_in, uintptr_t p_size)
+{
+	uint64_t bits = 0;
+	for(uintptr_t it = 0; it < p_size; ++it)
+	{
+		if(is_structural(p_in[it])) bits |= uint64_t{1} << it;
+	}
+	return bits;
+}
+
+#ifndef SCEF_TRANSCODE_X64
+void index_scalar(const char32_t* p_in, uintptr_t p_size, uint64_t* p_out)
+{
+	for(uintptr_t word = 0; word * 64 < p_size; ++word)
+	{
+		p_out[word] = index_bits_scalar(p_in + word * 64, std::min<uintptr_t>(p_size - word * 64, 64));
+	}
+}
+#endif
+
+#ifdef SCEF_TRANSCODE_X64
+//======== ======== SSE2 ======== ========
+template<bool t_ascii_only>
+uintptr_t widen_sse2(const char8_t* p_in, uintptr_t p_size, char32_t* p_out)
+{
+	const __m128i zero = _mm_setzero_si128();
+	uintptr_t it = 0;
+	for(; p_size - it >= 16; it += 16)
+	{
+		const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_in + it));
+		if constexpr(t_ascii_only)
+		{
+			if(_mm_movemask_epi8(bytes)) break;
+		}
+		const __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+		const __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+		__m128i* const out = reinterpret_cast<__m128i*>(p_out + it);
+		_mm_storeu_si128(out,		_mm_unpacklo_epi16(lo, zero));
+		_mm_storeu_si128(out + 1,	_mm_unpackhi_epi16(lo, zero));
+		_mm_storeu_si128(out + 2,	_mm_unpacklo_epi16(hi, zero));
+		_mm_storeu_si128(out + 3,	_mm_unpackhi_epi16(hi, zero));
+	}
+	return it + widen_scalar<t_ascii_only>(p_in + it, p_size - it, p_out + it);
+}
+
+uintptr_t narrow_ascii_sse2(const char32_t* p_in, uintptr_t p_size, char8_t* p_out)
+{
+	const __m128i high = _mm_set1_epi32(~0x7F);
+	const __m128i zero = _mm_setzero_si128();
+	uintptr_t it = 0;
+	for(; p_size - it >= 16; it += 16)
+	{
+		const __m128i* const in = reinterpret_cast<const __m128i*>(p_in + it);
+		const __m128i c0 = _mm_loadu_si128(in);
+		const __m128i c1 = _mm_loadu_si128(in + 1);
+		const __m128i c2 = _mm_loadu_si128(in + 2);
+		const __m128i c3 = _mm_loadu_si128(in + 3);
+		const __m128i any = _mm_or_si128(_mm_or_si128(c0, c1), _mm_or_si128(c2, c3));
+		if(_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(any, high), zero)) != 0xFFFF) break;
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(p_out + it),
+			_mm_packus_epi16(_mm_packs_epi32(c0, c1), _mm_packs_epi32(c2, c3)));
+	}
+	return it + narrow_ascii_scalar(p_in + it, p_size - it, p_out + it);
+}
+
+template<bool t_big>
+uintptr_t widen16_sse2(const char8_t* p_in, uintptr_t p_size, char32_t* p_out)
+{
+	const __m128i zero		= _mm_setzero_si128();
+	const __m128i mask		= _mm_set1_epi16(static_cast<short>(0xF800));
+	const __m128i surrogate	= _mm_set1_epi16(static_cast<short>(0xD800));
+	uintptr_t it = 0;
+	for(; p_size - it >= 8; it += 8)
+	{
+		__m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_in + it * 2));
+		if constexpr(t_big)
+		{
+			units = _mm_or_si128(_mm_slli_epi16(units, 8), _mm_srli_epi16(units, 8));
+		}
+		if(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, mask), surrogate))) break;
+		__m128i* const out = reinterpret_cast<__m128i*>(p_out + it);
+		_mm_storeu_si128(out,		_mm_unpacklo_epi16(units, zero));
+		_mm_storeu_si128(out + 1,	_mm_unpackhi_epi16(units, zero));
+	}
+	return it + widen16_scalar<t_big>(p_in + it * 2, p_size - it, p_out + it);
+}
+
+template<bool t_big>
+uintptr_t narrow16_sse2(const char32_t* p_in, uintptr_t p_size, char8_t* p_out)
+{
+	//SSE2 only has signed comparisons, biasing both sides makes them unsigned
+	const __m128i bias	= _mm_set1_epi32(static_cast<int>(0x80000000u));
+	const __m128i limit	= _mm_set1_epi32(static_cast<int>(0x8000D800u));
+	uintptr_t it = 0;
+	for(; p_size - it >= 8; it += 8)
+	{
+		const __m128i* const in = reinterpret_cast<const __m128i*>(p_in + it);
+		const __m128i c0 = _mm_loadu_si128(in);
+		const __m128i c1 = _mm_loadu_si128(in + 1);
+		const __m128i fits = _mm_and_si128(
+			_mm_cmplt_epi32(_mm_xor_si128(c0, bias), limit),
+			_mm_cmplt_epi32(_mm_xor_si128(c1, bias), limit));
+		if(_mm_movemask_epi8(fits) != 0xFFFF) break;
+		//sign extending the low half keeps the signed saturation of the pack from changing anything
+		__m128i units = _mm_packs_epi32(
+			_mm_srai_epi32(_mm_slli_epi32(c0, 16), 16),
+			_mm_srai_epi32(_mm_slli_epi32(c1, 16), 16));
+		if constexpr(t_big)
+		{
+			units = _mm_or_si128(_mm_slli_epi16(units, 8), _mm_srli_epi16(units, 8));
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(p_out + it * 2), units);
+	}
+	return it + narrow16_scalar<t_big>(p_in + it, p_size - it, p_out + it * 2);
+}
+
+template<bool t_big, bool t_strict>
+uintptr_t copy32_sse2(const char8_t* p_in, uintptr_t p_size, char8_t* p_out)
+{
+	const __m128i bias	= _mm_set1_epi32(static_cast<int>(0x80000000u));
+	const __m128i limit	= _mm_set1_epi32(static_cast<int>(0x8000D800u));
+	uintptr_t it = 0;
+	for(; p_size - it >= 8; it += 8)
+	{
+		const __m128i* const in = reinterpret_cast<const __m128i*>(p_in + it * 4);
+		__m128i c0 = _mm_loadu_si128(in);
+		__m128i c1 = _mm_loadu_si128(in + 1);
+		if constexpr(t_big)
+		{
+			//swap the 16 bit halves, then the bytes within them
+			c0 = _mm_shufflelo_epi16(_mm_shufflehi_epi16(c0, 0xB1), 0xB1);
+			c1 = _mm_shufflelo_epi16(_mm_shufflehi_epi16(c1, 0xB1), 0xB1);
+			c0 = _mm_or_si128(_mm_slli_epi16(c0, 8), _mm_srli_epi16(c0, 8));
+			c1 = _mm_or_si128(_mm_slli_epi16(c1, 8), _mm_srli_epi16(c1, 8));
+		}
+		if constexpr(t_strict)
+		{
+			const __m128i fits = _mm_and_si128(
+				_mm_cmplt_epi32(_mm_xor_si128(c0, bias), limit),
+				_mm_cmplt_epi32(_mm_xor_si128(c1, bias), limit));
+			if(_mm_movemask_epi8(fits) != 0xFFFF) break;
+		}
+		__m128i* const out = reinterpret_cast<__m128i*>(p_out + it * 4);
+		_mm_storeu_si128(out,		c0);
+		_mm_storeu_si128(out + 1,	c1);
+	}
+	return it + copy32_scalar<t_big, t_strict>(p_in + it * 4, p_size - it, p_out + it * 4);
+}
+
+//Bytes marked the same way is_structural marks the characters they were narrowed from.
+//Narrowing saturates, so characters above 0xFF become 0xFF and are not marked, and those that do not fit a signed 32 bit
+//integer become 0 and are marked.
+inline __m128i structural_bytes_sse2(__m128i p_bytes)
+{
+	__m128i hit = _mm_cmpeq_epi8(_mm_min_epu8(p_bytes, _mm_set1_epi8(' ')), p_bytes);
+	for(const char t_char : {'\"', '#', '\'', ',', ':', ';', '<', '=', '>', '^'})
+	{
+		hit = _mm_or_si128(hit, _mm_cmpeq_epi8(p_bytes, _mm_set1_epi8(t_char)));
+	}
+	return hit;
+}
+
+inline uint64_t index16_sse2(const char32_t* p_in)
+{
+	const __m128i* const in = reinterpret_cast<const __m128i*>(p_in);
+	const __m128i bytes = _mm_packus_epi16(
+		_mm_packs_epi32(_mm_loadu_si128(in),		_mm_loadu_si128(in + 1)),
+		_mm_packs_epi32(_mm_loadu_si128(in + 2),	_mm_loadu_si128(in + 3)));
+	return static_cast<uint16_t>(_mm_movemask_epi8(structural_bytes_sse2(bytes)));
+}
+
+void index_sse2(const char32_t* p_in, uintptr_t p_size, uint64_t* p_out)
+{
+	uintptr_t word = 0;
+	for(; p_size - word * 64 >= 64; ++word)
+	{
+		const char32_t* const in = p_in + word * 64;
+		p_out[word] = index16_sse2(in) | (index16_sse2(in + 16) << 16) | (index16_sse2(in + 32) << 32) | (index16_sse2(in + 48) << 48);
+	}
+	if(word * 64 < p_size)
+	{
+		p_out[word] = index_bits_scalar(p_in + word * 64, p_size - word * 64);
+	}
+}
+
+//======== ======== AVX2 ======== ========
+template<bool t_ascii_only>
+SCEF_TARGET_AVX2 uintptr_t widen_avx2(const char8_t* p_in, uintptr_t p_size, char32_t* p_out)
+{
+	uintptr_t it = 0;
+	for(; p_size - it >= 32; it += 32)
+	{
+		const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_in + it));
+		if constexpr(t_ascii_only)
+		{
+			if(_mm256_movemask_epi8(bytes)) break;
+		}
+		const __m128i lo = _mm256_castsi256_si128(bytes);
+		const __m128i hi = _mm256_extracti128_si256(bytes, 1);
+		__m256i* const out = reinterpret_cast<__m256i*>(p_out + it);
+		_mm256_storeu_si256(out,		_mm256_cvtepu8_epi32(lo));
+		_mm256_storeu_si256(out + 1,	_mm256_cvtepu8_epi32(_mm_srli_si128(lo, 8)));
+		_mm256_storeu_si256(out + 2,	_mm256_cvtepu8_epi32(hi));
+		_mm256_storeu_si256(out + 3,	_mm256_cvtepu8_epi32(_mm_srli_si128(hi, 8)));
+	}
+	return it + widen_sse2<t_ascii_only>(p_in + it, p_size - it, p_out + it);
+}
+
+SCEF_TARGET_AVX2 uintptr_t narrow_ascii_avx2(const char32_t* p_in, uintptr_t p_size, char8_t* p_out)
+{
+	const __m256i high	= _mm256_set1_epi32(~0x7F);
+	//undoes the lane interleaving of the packs
+	const __m256i order	= _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	uintptr_t it = 0;
+	for(; p_size - it >= 32; it += 32)
+	{
+		const __m256i* const in = reinterpret_cast<const __m256i*>(p_in + it);
+		const __m256i c0 = _mm256_loadu_si256(in);
+		const __m256i c1 = _mm256_loadu_si256(in + 1);
+		const __m256i c2 = _mm256_loadu_si256(in + 2);
+		const __m256i c3 = _mm256_loadu_si256(in + 3);
+		const __m256i any = _mm256_or_si256(_mm256_or_si256(c0, c1), _mm256_or_si256(c2, c3));
+		if(!_mm256_testz_si256(any, high)) break;
+		const __m256i bytes = _mm256_packus_epi16(_mm256_packs_epi32(c0, c1), _mm256_packs_epi32(c2, c3));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(p_out + it), _mm256_permutevar8x32_epi32(bytes, order));
+	}
+	return it + narrow_ascii_sse2(p_in + it, p_size - it, p_out + it);
+}
+
+template<bool t_big>
+SCEF_TARGET_AVX2 uintptr_t widen16_avx2(const char8_t* p_in, uintptr_t p_size, char32_t* p_out)
+{
+	const __m256i mask		= _mm256_set1_epi16(static_cast<short>(0xF800));
+	const __m256i surrogate	= _mm256_set1_epi16(static_cast<short>(0xD800));
+	uintptr_t it = 0;
+	for(; p_size - it >= 16; it += 16)
+	{
+		__m256i units = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_in + it * 2));
+		if constexpr(t_big)
+		{
+			units = _mm256_or_si256(_mm256_slli_epi16(units, 8), _mm256_srli_epi16(units, 8));
+		}
+		if(_mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_and_si256(units, mask), surrogate))) break;
+		__m256i* const out = reinterpret_cast<__m256i*>(p_out + it);
+		_mm256_storeu_si256(out,		_mm256_cvtepu16_epi32(_mm256_castsi256_si128(units)));
+		_mm256_storeu_si256(out + 1,	_mm256_cvtepu16_epi32(_mm256_extracti128_si256(units, 1)));
+	}
+	return it + widen16_sse2<t_big>(p_in + it * 2, p_size - it, p_out + it);
+}
+
+template<bool t_big>
+SCEF_TARGET_AVX2 uintptr_t narrow16_avx2(const char32_t* p_in, uintptr_t p_size, char8_t* p_out)
+{
+	const __m256i top = _mm256_set1_epi32(0xD7FF);
+	uintptr_t it = 0;
+	for(; p_size - it >= 16; it += 16)
+	{
+		const __m256i* const in = reinterpret_cast<const __m256i*>(p_in + it);
+		const __m256i c0 = _mm256_loadu_si256(in);
+		const __m256i c1 = _mm256_loadu_si256(in + 1);
+		const __m256i fits = _mm256_and_si256(
+			_mm256_cmpeq_epi32(_mm256_min_epu32(c0, top), c0),
+			_mm256_cmpeq_epi32(_mm256_min_epu32(c1, top), c1));
+		if(_mm256_movemask_epi8(fits) != -1) break;
+		//the pack interleaves the lanes
+		__m256i units = _mm256_permute4x64_epi64(_mm256_packus_epi32(c0, c1), 0xD8);
+		if constexpr(t_big)
+		{
+			units = _mm256_or_si256(_mm256_slli_epi16(units, 8), _mm256_srli_epi16(units, 8));
+		}
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(p_out + it * 2), units);
+	}
+	return it + narrow16_sse2<t_big>(p_in + it, p_size - it, p_out + it * 2);
+}
+
+template<bool t_big, bool t_strict>
+SCEF_TARGET_AVX2 uintptr_t copy32_avx2(const char8_t* p_in, uintptr_t p_size, char8_t* p_out)
+{
+	const __m256i top		= _mm256_set1_epi32(0xD7FF);
+	const __m256i reverse	= _mm256_setr_epi8(
+		3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+		3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	uintptr_t it = 0;
+	for(; p_size - it >= 16; it += 16)
+	{
+		const __m256i* const in = reinterpret_cast<const __m256i*>(p_in + it * 4);
+		__m256i c0 = _mm256_loadu_si256(in);
+		__m256i c1 = _mm256_loadu_si256(in + 1);
+		if constexpr(t_big)
+		{
+			c0 = _mm256_shuffle_epi8(c0, reverse);
+			c1 = _mm256_shuffle_epi8(c1, reverse);
+		}
+		if constexpr(t_strict)
+		{
+			const __m256i fits = _mm256_and_si256(
+				_mm256_cmpeq_epi32(_mm256_min_epu32(c0, top), c0),
+				_mm256_cmpeq_epi32(_mm256_min_epu32(c1, top), c1));
+			if(_mm256_movemask_epi8(fits) != -1) break;
+		}
+		__m256i* const out = reinterpret_cast<__m256i*>(p_out + it * 4);
+		_mm256_storeu_si256(out,		c0);
+		_mm256_storeu_si256(out + 1,	c1);
+	}
+	return it + copy32_sse2<t_big, t_strict>(p_in + it * 4, p_size - it, p_out + it * 4);
+}
+
+SCEF_TARGET_AVX2 inline uint64_t index32_avx2(const char32_t* p_in)
+{
+	const __m256i* const in = reinterpret_cast<const __m256i*>(p_in);
+	//packing works within 128 bit lanes, the permutation puts the characters back in order
+	const __m256i packed = _mm256_packus_epi16(
+		_mm256_packs_epi32(_mm256_loadu_si256(in),		_mm256_loadu_si256(in + 1)),
+		_mm256_packs_epi32(_mm256_loadu_si256(in + 2),	_mm256_loadu_si256(in + 3)));
+	const __m256i bytes = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+
+	__m256i hit = _mm256_cmpeq_epi8(_mm256_min_epu8(bytes, _mm256_set1_epi8(' ')), bytes);
+	for(const char t_char : {'\"', '#', '\'', ',', ':', ';', '<', '=', '>', '^'})
+	{
+		hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(t_char)));
+	}
+	return static_cast<uint32_t>(_mm256_movemask_epi8(hit));
+}
+
+SCEF_TARGET_AVX2 void index_avx2(const char32_t* p_in, uintptr_t p_size, uint64_t* p_out)
+{
+	uintptr_t word = 0;
+	for(; p_size - word * 64 >= 64; ++word)
+	{
+		const char32_t* const in = p_in + word * 64;
+		p_out[word] = index32_avx2(in) | (index32_avx2(in + 32) << 32);
+	}
+	if(word * 64 < p_size)
+	{
+		p_out[word] = index_bits_scalar(p_in + word * 64, p_size - word * 64);
+	}
+}
+
+bool has_avx2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if(info[0] < 7) return false;
+	__cpuid(info, 1);
+	//OSXSAVE and AVX
+	if((info[2] & 0x18000000) != 0x18000000) return false;
+	//OS saves the YMM registers
+	if((_xgetbv(0) & 0x06) != 0x06) return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & 0x20) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif //SCEF_TRANSCODE_X64
+
+//======== ======== dispatch ======== ========
+struct kernels
+{
+	widen_f		widen;
+	widen_f		widen_ascii;
+	narrow_f	narrow_ascii;
+	widen_f		widen16_le;
+	widen_f		widen16_be;
+	narrow_f	narrow16_le;
+	narrow_f	narrow16_be;
+	copy32_f	copy32_le;
+	copy32_f	copy32_be;
+	copy32_f	copy32_le_s;
+	copy32_f	copy32_be_s;
+	index_f		index;
+};
+
+kernels pick_kernels()
+{
+#ifdef SCEF_TRANSCODE_X64
+	if(has_avx2())
+	{
+		return
+		{
+			widen_avx2<false>, widen_avx2<true>, narrow_ascii_avx2,
+			widen16_avx2<false>, widen16_avx2<true>, narrow16_avx2<false>, narrow16_avx2<true>,
+			copy32_avx2<false, false>, copy32_avx2<true, false>, copy32_avx2<false, true>, copy32_avx2<true, true>,
+			index_avx2
+		};
+	}
+	return
+	{
+		widen_sse2<false>, widen_sse2<true>, narrow_ascii_sse2,
+		widen16_sse2<false>, widen16_sse2<true>, narrow16_sse2<false>, narrow16_sse2<true>,
+		copy32_sse2<false, false>, copy32_sse2<true, false>, copy32_sse2<false, true>, copy32_sse2<true, true>,
+		index_sse2
+	};
+#else
+	return
+	{
+		widen_scalar<false>, widen_scalar<true>, narrow_ascii_scalar,
+		widen16_scalar<false>, widen16_scalar<true>, narrow16_scalar<false>, narrow16_scalar<true>,
+		copy32_scalar<false, false>, copy32_scalar<true, false>, copy32_scalar<false, true>, copy32_scalar<true, true>,
+		index_scalar
+	};
+#endif
+}
+
+const kernels& active_kernels()
+{
+	static const kernels t_kernels = pick_kernels();
+	return t_kernels;
+}
+
+template<bool t_big>
+transcode_result UTF16_to_UCS4(const char8_t* p_in, uintptr_t p_in_size, char32_t* p_out, uintptr_t p_out_size, widen_f p_widen)
+{
+	const uintptr_t in_units = p_in_size / 2;
+	uintptr_t in_it		= 0;
+	uintptr_t out_it	= 0;
+
+	while(in_it < in_units && out_it < p_out_size)
+	{
+		const uintptr_t run = p_widen(p_in + in_it * 2, std::min(in_units - in_it, p_out_size - out_it), p_out + out_it);
+		in_it	+= run;
+		out_it	+= run;
+		if(in_it == in_units || out_it == p_out_size) break;
+
+		//only a surrogate can stop the run
+		if(in_units - in_it < 2) break;
+		const char16_t r	= load_UTF16<t_big>(p_in + in_it * 2);
+		const char16_t r1	= load_UTF16<t_big>(p_in + in_it * 2 + 2);
+		if((r & 0xFC00) != 0xD800 || (r1 & 0xFC00) != 0xDC00) break;
+		p_out[out_it++] = (((char32_t{r} & 0x03FF) << 10) | (char32_t{r1} & 0x03FF)) + 0x10000;
+		in_it += 2;
+	}
+
+	return {in_it * 2, out_it};
+}
+
+template<bool t_big>
+transcode_result UCS4_to_UTF16(const char32_t* p_in, uintptr_t p_in_size, char8_t* p_out, uintptr_t p_out_size, narrow_f p_narrow)
+{
+	const uintptr_t out_units = p_out_size / 2;
+	uintptr_t in_it		= 0;
+	uintptr_t out_it	= 0;
+
+	while(in_it < p_in_size && out_it < out_units)
+	{
+		const uintptr_t run = p_narrow(p_in + in_it, std::min(p_in_size - in_it, out_units - out_it), p_out + out_it * 2);
+		in_it	+= run;
+		out_it	+= run;
+		if(in_it == p_in_size || out_it == out_units) break;
+
+		const char32_t r = p_in[in_it];
+		if(r < 0x10000)
+		{
+			if(r < 0xE000) break; //surrogate
+			store_UTF16<t_big>(p_out + out_it * 2, static_cast<char16_t>(r));
+			++out_it;
+		}
+		else
+		{
+			if(r > 0x10FFFF || out_units - out_it < 2) break;
+			const char32_t t = r - 0x10000;
+			store_UTF16<t_big>(p_out + out_it * 2,		static_cast<char16_t>(0xD800 | (t >> 10)));
+			store_UTF16<t_big>(p_out + out_it * 2 + 2,	static_cast<char16_t>(0xDC00 | (t & 0x03FF)));
+			out_it += 2;
+		}
+		++in_it;
+	}
+
+	return {in_it, out_it * 2};
+}
+
+template<bool t_big>
+transcode_result UCS4_to_UCS4_s(const char8_t* p_in, uintptr_t p_in_size, char32_t* p_out, uintptr_t p_out_size, copy32_f p_copy)
+{
+	const uintptr_t in_units = p_in_size / 4;
+	uintptr_t it = 0;
+	const uintptr_t size = std::min(in_units, p_out_size);
+
+	while(it < size)
+	{
+		it += p_copy(p_in + it * 4, size - it, reinterpret_cast<char8_t*>(p_out + it));
+		if(it == size) break;
+
+		//only gets here for what needs a full check
+		const char32_t r = load_UCS4<t_big>(p_in + it * 4);
+		if(!core::UNICODE_Compliant(r)) break;
+		p_out[it++] = r;
+	}
+
+	return {it * 4, it};
+}
+
+} //namespace
+
+transcode_result ANSI_to_UCS4(const char8_t* p_in, uintptr_t p_in_size, char32_t* p_out, uintptr_t p_out_size)
+{
+	const uintptr_t count = active_kernels().widen(p_in, std::min(p_in_size, p_out_size), p_out);
+	return {count, count};
+}
+
+transcode_result UTF8_to_UCS4(const char8_t* p_in, uintptr_t p_in_size, char32_t* p_out, uintptr_t p_out_size)
+{
+	const widen_f widen_ascii = active_kernels().widen_ascii;
+
+	const char8_t*			pivot	= p_in;
+	const char8_t* const	in_end	= p_in + p_in_size;
+	char32_t*				out		= p_out;
+	char32_t* const			out_end	= p_out + p_out_size;
+
+	while(pivot != in_end && out != out_end)
+	{
+		const uintptr_t run = widen_ascii(pivot, std::min<uintptr_t>(in_end - pivot, out_end - out), out);
+		pivot	+= run;
+		out		+= run;
+		if(pivot == in_end || out == out_end) break;
+
+		const char8_t	r		= *pivot;
+		const uintptr_t	left	= static_cast<uintptr_t>(in_end - pivot);
+		if((r & 0xE0) == 0xC0) //level 1
+		{
+			if(left < 2) break;
+			const char8_t r1 = pivot[1];
+			if((r1 & 0xC0) != 0x80 || (r & 0x1F) < 0x02) break;
+			*(out++) =
+				((char32_t{r} & 0x1F) << 6) |
+				( char32_t{r1} & 0x3F);
+			pivot += 2;
+		}
+		else if((r & 0xF0) == 0xE0) //level 2
+		{
+			if(left < 3) break;
+			const char8_t r1 = pivot[1];
+			const char8_t r2 = pivot[2];
+			if(((r1 & 0xC0) != 0x80) || ((r2 & 0xC0) != 0x80)) break;
+			if((r & 0x0F) == 0 && (r1 & 0x3F) < 0x20) break;
+			*(out++) =
+				((char32_t{r} & 0x0F) << 12) |
+				((char32_t{r1} & 0x3F) << 6) |
+				( char32_t{r2} & 0x3F);
+			pivot += 3;
+		}
+		else if((r & 0xF8) == 0xF0) //level 3
+		{
+			if(left < 4) break;
+			const char8_t r1 = pivot[1];
+			const char8_t r2 = pivot[2];
+			const char8_t r3 = pivot[3];
+			if(((r1 & 0xC0) != 0x80) || ((r2 & 0xC0) != 0x80) || ((r3 & 0xC0) != 0x80)) break;
+			if((r & 0x07) == 0 && (r1 & 0x3F) < 0x10) break;
+			*(out++) =
+				((char32_t{r} & 0x07) << 18) |
+				((char32_t{r1} & 0x3F) << 12) |
+				((char32_t{r2} & 0x3F) << 6) |
+				( char32_t{r3} & 0x3F);
+			pivot += 4;
+		}
+		else break;
+	}
+
+	return {static_cast<uintptr_t>(pivot - p_in), static_cast<uintptr_t>(out - p_out)};
+}
+
+transcode_result UCS4_to_UTF8(const char32_t* p_in, uintptr_t p_in_size, char8_t* p_out, uintptr_t p_out_size)
+{
+	const narrow_f narrow_ascii = active_kernels().narrow_ascii;
+
+	const char32_t*			pivot	= p_in;
+	const char32_t* const	in_end	= p_in + p_in_size;
+	char8_t*				out		= p_out;
+	char8_t* const			out_end	= p_out + p_out_size;
+
+	while(pivot != in_end && out != out_end)
+	{
+		const uintptr_t run = narrow_ascii(pivot, std::min<uintptr_t>(in_end - pivot, out_end - out), out);
+		pivot	+= run;
+		out		+= run;
+		if(pivot == in_end || out == out_end) break;
+
+		const char32_t	r		= *pivot;
+		const uintptr_t	room	= static_cast<uintptr_t>(out_end - out);
+		if(r < 0x800)
+		{
+			if(room < 2) break;
+			out[0] = static_cast<char8_t>(0xC0 | (r >> 6));
+			out[1] = static_cast<char8_t>(0x80 | (r & 0x3F));
+			out += 2;
+		}
+		else if(r < 0x10000)
+		{
+			if(room < 3 || (r > 0xD7FF && r < 0xE000)) break;
+			out[0] = static_cast<char8_t>(0xE0 | (r >> 12));
+			out[1] = static_cast<char8_t>(0x80 | ((r >> 6) & 0x3F));
+			out[2] = static_cast<char8_t>(0x80 | (r & 0x3F));
+			out += 3;
+		}
+		else
+		{
+			if(room < 4 || r > 0x10FFFF) break;
+			out[0] = static_cast<char8_t>(0xF0 | (r >> 18));
+			out[1] = static_cast<char8_t>(0x80 | ((r >> 12) & 0x3F));
+			out[2] = static_cast<char8_t>(0x80 | ((r >> 6) & 0x3F));
+			out[3] = static_cast<char8_t>(0x80 | (r & 0x3F));
+			out += 4;
+		}
+		++pivot;
+	}
+
+	return {static_cast<uintptr_t>(pivot - p_in), static_cast<uintptr_t>(out - p_out)};
+}
+
+transcode_result UTF16LE_to_UCS4(const char8_t* p_in, uintptr_t p_in_size, char32_t* p_out, uintptr_t p_out_size)
+{
+	return UTF16_to_UCS4<false>(p_in, p_in_size, p_out, p_out_size, active_kernels().widen16_le);
+}
+
+transcode_result UTF16BE_to_UCS4(const char8_t* p_in, uintptr_t p_in_size, char32_t* p_out, uintptr_t p_out_size)
+{
+	return UTF16_to_UCS4<true>(p_in, p_in_size, p_out, p_out_size, active_kernels().widen16_be);
+}
+
+transcode_result UCS4_to_UTF16LE(const char32_t* p_in, uintptr_t p_in_size, char8_t* p_out, uintptr_t p_out_size)
+{
+	return UCS4_to_UTF16<false>(p_in, p_in_size, p_out, p_out_size, active_kernels().narrow16_le);
+}
+
+transcode_result UCS4_to_UTF16BE(const char32_t* p_in, uintptr_t p_in_size, char8_t* p_out, uintptr_t p_out_size)
+{
+	return UCS4_to_UTF16<true>(p_in, p_in_size, p_out, p_out_size, active_kernels().narrow16_be);
+}
+
+transcode_result UCS4LE_to_UCS4(const char8_t* p_in, uintptr_t p_in_size, char32_t* p_out, uintptr_t p_out_size)
+{
+	const uintptr_t count = active_kernels().copy32_le(p_in, std::min(p_in_size / 4, p_out_size), reinterpret_cast<char8_t*>(p_out));
+	return {count * 4, count};
+}
+
+transcode_result UCS4BE_to_UCS4(const char8_t* p_in, uintptr_t p_in_size, char32_t* p_out, uintptr_t p_out_size)
+{
+	const uintptr_t count = active_kernels().copy32_be(p_in, std::min(p_in_size / 4, p_out_size), reinterpret_cast<char8_t*>(p_out));
+	return {count * 4, count};
+}
+
+transcode_result UCS4LE_to_UCS4_s(const char8_t* p_in, uintptr_t p_in_size, char32_t* p_out, uintptr_t p_out_size)
+{
+	return UCS4_to_UCS4_s<false>(p_in, p_in_size, p_out, p_out_size, active_kernels().copy32_le_s);
+}
+
+transcode_result UCS4BE_to_UCS4_s(const char8_t* p_in, uintptr_t p_in_size, char32_t* p_out, uintptr_t p_out_size)
+{
+	return UCS4_to_UCS4_s<true>(p_in, p_in_size, p_out, p_out_size, active_kernels().copy32_be_s);
+}
+
+transcode_result UCS4_to_UCS4LE(const char32_t* p_in, uintptr_t p_in_size, char8_t* p_out, uintptr_t p_out_size)
+{
+	const uintptr_t count = active_kernels().copy32_le(reinterpret_cast<const char8_t*>(p_in), std::min(p_in_size, p_out_size / 4), p_out);
+	return {count, count * 4};
+}
+
+transcode_result UCS4_to_UCS4BE(const char32_t* p_in, uintptr_t p_in_size, char8_t* p_out, uintptr_t p_out_size)
+{
+	const uintptr_t count = active_kernels().copy32_be(reinterpret_cast<const char8_t*>(p_in), std::min(p_in_size, p_out_size / 4), p_out);
+	return {count, count * 4};
+}
+
+void structural_index(const char32_t* p_in, uintptr_t p_size, uint64_t* p_out)
+{
+	active_kernels().index(p_in, p_size, p_out);
+}
+
+} //namespace scef::ENCODER_P
@@ -0,0 +1,104 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#pragma once
+
+#include <cstdint>
+
+namespace scef::ENCODER_P
+{
+
+struct transcode_result
+{
+	uintptr_t consumed;	//input units
+	uintptr_t produced;	//output units
+};
+
+// Bulk conversions used by the decoders and encoders to skip the per character path
+// Note:
+//	1. They stop at the first sequence they can not fully handle (invalid, or cut short by the end of the input),
+//		leaving it to the per character path, which handles errors and lax encodings.
+//	2. On x64 an SSE2 or AVX2 implementation is selected at run time, a scalar one is used otherwise.
+
+// Widens every byte
+[[nodiscard]] transcode_result ANSI_to_UCS4(const char8_t* p_in, uintptr_t p_in_size, char32_t* p_out, uintptr_t p_out_size);
+
+// Only accepts sequences in their shortest form, up to 4 bytes long
+[[nodiscard]] transcode_result UTF8_to_UCS4(const char8_t* p_in, uintptr_t p_in_size, char32_t* p_out, uintptr_t p_out_size);
+
+// Only accepts Unicode scalar values (no surrogates, nothing past 0x10FFFF)
+// Also stops if the next character does not fit in the output
+[[nodiscard]] transcode_result UCS4_to_UTF8(const char32_t* p_in, uintptr_t p_in_size, char8_t* p_out, uintptr_t p_out_size);
+
+// Input is in bytes, surrogates are only accepted as a well formed pair
+[[nodiscard]] transcode_result UTF16LE_to_UCS4(const char8_t* p_in, uintptr_t p_in_size, char32_t* p_out, uintptr_t p_out_size);
+[[nodiscard]] transcode_result UTF16BE_to_UCS4(const char8_t* p_in, uintptr_t p_in_size, char32_t* p_out, uintptr_t p_out_size);
+
+// Output is in bytes, only accepts Unicode scalar values
+// Also stops if the next character does not fit in the output
+[[nodiscard]] transcode_result UCS4_to_UTF16LE(const char32_t* p_in, uintptr_t p_in_size, char8_t* p_out, uintptr_t p_out_size);
+[[nodiscard]] transcode_result UCS4_to_UTF16BE(const char32_t* p_in, uintptr_t p_in_size, char8_t* p_out, uintptr_t p_out_size);
+
+// Input is in bytes, takes any value
+[[nodiscard]] transcode_result UCS4LE_to_UCS4(const char8_t* p_in, uintptr_t p_in_size, char32_t* p_out, uintptr_t p_out_size);
+[[nodiscard]] transcode_result UCS4BE_to_UCS4(const char8_t* p_in, uintptr_t p_in_size, char32_t* p_out, uintptr_t p_out_size);
+
+// Input is in bytes, only accepts what core::UNICODE_Compliant does
+[[nodiscard]] transcode_result UCS4LE_to_UCS4_s(const char8_t* p_in, uintptr_t p_in_size, char32_t* p_out, uintptr_t p_out_size);
+[[nodiscard]] transcode_result UCS4BE_to_UCS4_s(const char8_t* p_in, uintptr_t p_in_size, char32_t* p_out, uintptr_t p_out_size);
+
+// Output is in bytes, takes any value
+[[nodiscard]] transcode_result UCS4_to_UCS4LE(const char32_t* p_in, uintptr_t p_in_size, char8_t* p_out, uintptr_t p_out_size);
+[[nodiscard]] transcode_result UCS4_to_UCS4BE(const char32_t* p_in, uintptr_t p_in_size, char8_t* p_out, uintptr_t p_out_size);
+
+// Characters the structural index marks: controls, space, and the punctuation the v1 grammar acts on.
+// Every other character, including all above 0x7F, is plain text to the grammar.
+[[nodiscard]] constexpr bool is_structural(char32_t p_char)
+{
+	switch(p_char)
+	{
+		case '\"':
+		case '#':
+		case '\'':
+		case ',':
+		case ':':
+		case ';':
+		case '<':
+		case '=':
+		case '>':
+		case '^':
+			return true;
+		default:
+			return p_char <= ' ';
+	}
+}
+
+// Sets bit i of p_out[i / 64] if p_in[i] may be structural, p_out must hold (p_size + 63) / 64 words.
+// A marked character still has to be checked, one that is not marked is never structural.
+void structural_index(const char32_t* p_in, uintptr_t p_size, uint64_t* p_out);
+
+} //namespace scef::ENCODER_P
@@ -28,9 +28,13 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
+#include <sstream>
 
 #include <SCEF/SCEF.hpp>
+#include <SCEF/scef_frozen.hpp>
 
 #include <CoreLib/core_type.hpp>
 
@@ -173,7 +177,7 @@ TEST(SCEF, load_sample1)
 				EXPECT_EQ(tsinglet.line(), 10_ui64);
 				EXPECT_EQ(tsinglet.column(), 3_ui64);
 
-				const std::u32string& text = tsinglet.name();
+				std::u32string_view text = tsinglet.name();
 				ASSERT_EQ(text.size(), 5_uip);
 				EXPECT_EQ(text[0], U'\n');
 				EXPECT_EQ(text[1], U'^');
@@ -185,3 +189,940 @@ TEST(SCEF, load_sample1)
 	}
 
 }
+
+TEST(SCEF, load_sample1_events)
+{
+	//records every event as a letter, and the names of what was reported
+	class recorder: public scef::event_handler
+	{
+	public:
+		void on_group_begin	(const scef::group& p_group)		override { trace.push_back(U'<'); names.emplace_back(p_group.name()); }
+		void on_group_end	(const scef::group& p_group)		override { trace.push_back(U'>'); names.emplace_back(p_group.name()); }
+		void on_key_value	(const scef::keyedValue& p_key)		override { trace.push_back(U'k'); names.emplace_back(p_key.name()).append(U"=").append(p_key.value()); }
+		void on_singlet		(const scef::singlet& p_singlet)	override { trace.push_back(U'v'); names.emplace_back(p_singlet.name()); }
+		void on_comment		(const scef::comment&)				override { trace.push_back(U'#'); }
+		void on_spacer		(const scef::spacer&)				override { trace.push_back(U' '); }
+
+		std::u32string trace;
+		std::vector<std::u32string> names;
+	};
+
+	scef::document doc;
+	recorder events;
+
+	scef::Error ret = doc.load(getAppPath().parent_path() / "sampleFile1.scef", events, scef::Flag::ForceHeader);
+
+	ASSERT_EQ(ret, scef::Error::None);
+	EXPECT_TRUE(doc.root().empty());
+	EXPECT_EQ(doc.prop().version, uint16_t{1});
+
+	EXPECT_EQ(events.trace, U" < v k < k v v > #>");
+	ASSERT_EQ(events.names.size(), 9_uip);
+	EXPECT_EQ(events.names[0], U"Sample");
+	EXPECT_EQ(events.names[1], U"value");
+	EXPECT_EQ(events.names[2], U"key=value");
+	EXPECT_EQ(events.names[3], U"Nested With Escape");
+	EXPECT_EQ(events.names[4], U"Escape Key=Escape Value");
+	EXPECT_EQ(events.names[5], U"Escape value");
+	EXPECT_EQ(events.names[7], U"Nested With Escape");
+	EXPECT_EQ(events.names[8], U"Sample");
+
+	//the same file without spacing or comments
+	events.trace.clear();
+	events.names.clear();
+	ret = doc.load(getAppPath().parent_path() / "sampleFile1.scef", events, scef::Flag::ForceHeader | scef::Flag::DisableSpacers | scef::Flag::DisableComments);
+
+	ASSERT_EQ(ret, scef::Error::None);
+	EXPECT_EQ(events.trace, U"<vk<kvv>>");
+}
+
+TEST(SCEF, read_sample1)
+{
+	scef::reader doc;
+
+	scef::Error ret = doc.open(getAppPath().parent_path() / "sampleFile1.scef", scef::Flag::ForceHeader | scef::Flag::DisableSpacers | scef::Flag::DisableComments);
+	ASSERT_EQ(ret, scef::Error::None);
+	EXPECT_EQ(doc.prop().version, uint16_t{1});
+
+	ASSERT_TRUE(doc.next());
+	ASSERT_EQ(doc.kind(), scef::reader::token::group_begin);
+	EXPECT_EQ(doc.name(), U"Sample");
+	EXPECT_EQ(doc.depth(), 0_uip);
+
+	ASSERT_TRUE(doc.next());
+	ASSERT_EQ(doc.kind(), scef::reader::token::singlet);
+	EXPECT_EQ(doc.name(), U"value");
+	EXPECT_EQ(doc.depth(), 1_uip);
+
+	ASSERT_TRUE(doc.next());
+	ASSERT_EQ(doc.kind(), scef::reader::token::key_value);
+	EXPECT_EQ(doc.name(), U"key");
+	EXPECT_EQ(doc.value(), U"value");
+
+	//the nested group is skipped without reading its children
+	ASSERT_TRUE(doc.next());
+	ASSERT_EQ(doc.kind(), scef::reader::token::group_begin);
+	EXPECT_EQ(doc.name(), U"Nested With Escape");
+	ASSERT_TRUE(doc.skip_group());
+	ASSERT_EQ(doc.kind(), scef::reader::token::group_end);
+	EXPECT_EQ(doc.name(), U"Nested With Escape");
+
+	ASSERT_TRUE(doc.next());
+	ASSERT_EQ(doc.kind(), scef::reader::token::group_end);
+	EXPECT_EQ(doc.name(), U"Sample");
+
+	EXPECT_FALSE(doc.next());
+	EXPECT_EQ(doc.kind(), scef::reader::token::end);
+	EXPECT_EQ(doc.last_error().error_code(), scef::Error::None);
+}
+
+TEST(SCEF, deep_nesting)
+{
+	//well past what a recursive reader or writer could take on a small thread stack
+	constexpr uintptr_t depth = 100000;
+
+	scef::document doc;
+	scef::ItemList* t_list = &doc.root();
+	for(uintptr_t i = 0; i < depth; ++i)
+	{
+		scef::itemProxy<scef::group> t_group = scef::group::make();
+		t_group->set_name(U"g");
+		t_list->push_back(t_group);
+		t_list = t_group.get();
+	}
+	scef::itemProxy<scef::singlet> t_leaf = scef::singlet::make();
+	t_leaf->set_name(U"leaf");
+	t_list->push_back(t_leaf);
+
+	std::stringstream t_data;
+	scef::std_ostream t_out{t_data};
+	ASSERT_EQ(doc.save(t_out, scef::Flag::DisableSpacers, 1, scef::Encoding::ANSI), scef::Error::None);
+
+	scef::document loaded;
+	scef::std_istream t_in{t_data};
+	ASSERT_EQ(loaded.load(t_in, scef::Flag::ForceHeader | scef::Flag::DisableSpacers), scef::Error::None);
+
+	uintptr_t t_depth = 0;
+	const scef::ItemList* t_read = &loaded.root();
+	while(t_read->size() == 1 && (*t_read)[0]->type() == scef::ItemType::group)
+	{
+		t_read = static_cast<const scef::group*>((*t_read)[0].get());
+		++t_depth;
+	}
+	EXPECT_EQ(t_depth, depth);
+	ASSERT_EQ(t_read->size(), 1_uip);
+	EXPECT_EQ((*t_read)[0]->type(), scef::ItemType::singlet);
+}
+
+//hands out at most a few bytes per read, so that every sequence ends up split between reads
+//the 4 bytes the encoding is detected from are still read whole, as document::load expects
+class trickle_istream: public scef::base_istreamer
+{
+public:
+	trickle_istream(std::string_view p_data)
+		: m_data{p_data}
+	{
+		_size = p_data.size();
+	}
+
+	uintptr_t read(void* p_buffer, uintptr_t p_size) override
+	{
+		const uintptr_t t_count = std::min<uintptr_t>({p_size, m_data.size() - m_pos, p_size <= 4 ? p_size : 1 + m_reads++ % 7});
+		memcpy(p_buffer, m_data.data() + m_pos, t_count);
+		m_pos += t_count;
+		return t_count;
+	}
+
+	scef::stream_error stat() const override { return m_pos < m_data.size() ? scef::stream_error::None : scef::stream_error::Control_EndOfStream; }
+	uint64_t pos() const override { return m_pos; }
+	void set_pos(uint64_t p_pos) override { if(p_pos <= m_data.size()) m_pos = p_pos; }
+
+private:
+	std::string_view	m_data;
+	uintptr_t			m_pos = 0;
+	uintptr_t			m_reads = 0;
+};
+
+//values mix characters of every UTF-8 and UTF-16 length, each at a shifting offset
+//ANSI can only take the first 256 codepoints
+static std::u32string round_trip_value(uintptr_t p_index, scef::Encoding p_encoding)
+{
+	static constexpr char32_t wide[] = {U'é', U'中', U'\U0001F600'};
+	std::u32string t_value = U"v";
+	for(uintptr_t i = 0; i < p_index % 13; ++i)
+	{
+		t_value.push_back(static_cast<char32_t>(U'a' + (p_index + i) % 26));
+		t_value.push_back(p_encoding == scef::Encoding::ANSI ? U'é' : wide[(p_index + i) % 3]);
+	}
+	return t_value;
+}
+
+static std::u32string round_trip_name(uintptr_t p_index)
+{
+	const std::string t_digits = std::to_string(p_index);
+	return U"k" + std::u32string(t_digits.begin(), t_digits.end());
+}
+
+static void make_round_trip(scef::document& p_doc, uintptr_t p_keys, scef::Encoding p_encoding)
+{
+	scef::itemProxy<scef::group> t_group = scef::group::make();
+	t_group->set_name(U"data");
+	p_doc.root().push_back(t_group);
+	for(uintptr_t i = 0; i < p_keys; ++i)
+	{
+		scef::itemProxy<scef::keyedValue> t_key = scef::keyedValue::make();
+		t_key->set_name(round_trip_name(i));
+		t_key->set_value(round_trip_value(i, p_encoding));
+		t_group->push_back(t_key);
+	}
+}
+
+//number of keys that did not come back as they were written
+static uintptr_t check_round_trip(const scef::document& p_doc, uintptr_t p_keys, scef::Encoding p_encoding)
+{
+	scef::itemRef<const scef::group> t_group = p_doc.root().find_group_by_name(U"data");
+	if(!t_group) return p_keys;
+
+	uintptr_t t_index = 0;
+	uintptr_t t_bad = 0;
+	for(scef::itemRef<const scef::item> t_item : t_group->proxyList(scef::ItemType::key_value))
+	{
+		const scef::keyedValue& t_key = static_cast<const scef::keyedValue&>(*t_item);
+		if(t_key.view_name() != round_trip_name(t_index) || t_key.view_value() != round_trip_value(t_index, p_encoding)) ++t_bad;
+		++t_index;
+	}
+	return t_bad + (t_index > p_keys ? t_index - p_keys : p_keys - t_index);
+}
+
+static constexpr scef::Encoding round_trip_encodings[] =
+{
+	scef::Encoding::ANSI,
+	scef::Encoding::UTF8,
+	scef::Encoding::UTF16_LE,
+	scef::Encoding::UTF16_BE,
+	scef::Encoding::UCS4_LE,
+	scef::Encoding::UCS4_BE,
+};
+
+TEST(SCEF, encoding_round_trip)
+{
+	//well past a block of the read and write buffers in every encoding
+	constexpr uintptr_t keys = 6000;
+
+	for(const scef::Encoding t_encoding : round_trip_encodings)
+	{
+		SCOPED_TRACE(static_cast<int>(t_encoding));
+
+		std::stringstream t_stream;
+		{
+			scef::document doc;
+			make_round_trip(doc, keys, t_encoding);
+			scef::std_ostream t_out{t_stream};
+			ASSERT_EQ(doc.save(t_out, scef::Flag::DisableSpacers, 1, t_encoding), scef::Error::None);
+		}
+		const std::string t_data = t_stream.str();
+		ASSERT_GT(t_data.size(), 0x10000_uip);
+
+		//read in place, through the read buffer, and a few bytes at a time
+		scef::document doc;
+		{
+			scef::buffer_istream t_in{t_data.data(), t_data.size()};
+			ASSERT_EQ(doc.load(t_in, scef::Flag::ForceHeader | scef::Flag::DisableSpacers), scef::Error::None);
+			EXPECT_EQ(check_round_trip(doc, keys, t_encoding), 0_uip);
+		}
+		{
+			std::stringstream t_copy{t_data};
+			scef::std_istream t_in{t_copy};
+			ASSERT_EQ(doc.load(t_in, scef::Flag::ForceHeader | scef::Flag::DisableSpacers), scef::Error::None);
+			EXPECT_EQ(check_round_trip(doc, keys, t_encoding), 0_uip);
+		}
+		{
+			trickle_istream t_in{t_data};
+			ASSERT_EQ(doc.load(t_in, scef::Flag::ForceHeader | scef::Flag::DisableSpacers), scef::Error::None);
+			EXPECT_EQ(check_round_trip(doc, keys, t_encoding), 0_uip);
+		}
+	}
+}
+
+TEST(SCEF, encoding_round_trip_file)
+{
+	//past the size from which document::load maps the file instead of reading it
+	constexpr uintptr_t keys = 60000;
+	const std::filesystem::path t_file = std::filesystem::temp_directory_path() / "scef_round_trip.scef";
+
+	for(const scef::Encoding t_encoding : round_trip_encodings)
+	{
+		SCOPED_TRACE(static_cast<int>(t_encoding));
+		{
+			scef::document doc;
+			make_round_trip(doc, keys, t_encoding);
+			ASSERT_EQ(doc.save(t_file, scef::Flag::DisableSpacers, 1, t_encoding), scef::Error::None);
+		}
+		ASSERT_GE(std::filesystem::file_size(t_file), 0x100000_uip);
+
+		scef::document doc;
+		ASSERT_EQ(doc.load(t_file, scef::Flag::ForceHeader | scef::Flag::DisableSpacers), scef::Error::None);
+		EXPECT_EQ(check_round_trip(doc, keys, t_encoding), 0_uip);
+	}
+	std::filesystem::remove(t_file);
+}
+
+TEST(SCEF, load_sample1_filtered)
+{
+	scef::document doc;
+
+	scef::Error ret = doc.load(getAppPath().parent_path() / "sampleFile1.scef", scef::path_filter{U"Sample/key", U"*/Nested With Escape"}, scef::Flag::ForceHeader);
+	ASSERT_EQ(ret, scef::Error::None);
+
+	scef::root& root = doc.root();
+	ASSERT_EQ(root.size(), 1_uip);
+	ASSERT_EQ(root[0]->type(), scef::ItemType::group);
+
+	const scef::group& sample = *static_cast<const scef::group*>(root[0].get());
+	EXPECT_EQ(sample.name(), U"Sample");
+	ASSERT_EQ(sample.size(), 2_uip);
+
+	ASSERT_EQ(sample[0]->type(), scef::ItemType::key_value);
+	EXPECT_EQ(static_cast<const scef::keyedValue*>(sample[0].get())->value(), U"value");
+
+	//selected groups are kept whole
+	ASSERT_EQ(sample[1]->type(), scef::ItemType::group);
+	const scef::group& nested = *static_cast<const scef::group*>(sample[1].get());
+	EXPECT_EQ(nested.name(), U"Nested With Escape");
+	EXPECT_EQ(nested.size(), 7_uip);
+
+	//nothing selected
+	ret = doc.load(getAppPath().parent_path() / "sampleFile1.scef", scef::path_filter{U"Network/IP"}, scef::Flag::ForceHeader);
+	ASSERT_EQ(ret, scef::Error::None);
+	EXPECT_TRUE(doc.root().empty());
+}
+
+TEST(SCEF, load_sample1_deferred)
+{
+	scef::document doc;
+
+	scef::Error ret = doc.load(getAppPath().parent_path() / "sampleFile1.scef", scef::Flag::ForceHeader | scef::Flag::DeferGroups);
+	ASSERT_EQ(ret, scef::Error::None);
+
+	const auto first_group = [](scef::ItemList& p_list) -> scef::group*
+	{
+		for(const auto& t_item : p_list)
+		{
+			if(t_item->type() == scef::ItemType::group) return static_cast<scef::group*>(t_item.get());
+		}
+		return nullptr;
+	};
+
+	scef::group* sample = first_group(doc.root());
+	ASSERT_NE(sample, nullptr);
+	EXPECT_EQ(sample->name(), U"Sample");
+	ASSERT_TRUE(sample->deferred());
+	EXPECT_TRUE(sample->empty());
+
+	ASSERT_EQ(doc.expand(*sample), scef::Error::None);
+	EXPECT_FALSE(sample->deferred());
+	EXPECT_EQ(sample->size(), 8_uip);
+
+	scef::group* nested = first_group(*sample);
+	ASSERT_NE(nested, nullptr);
+	EXPECT_EQ(nested->name(), U"Nested With Escape");
+	ASSERT_TRUE(nested->deferred());
+
+	ASSERT_EQ(doc.expand(*nested), scef::Error::None);
+	EXPECT_EQ(nested->size(), 7_uip);
+
+	//already read
+	EXPECT_EQ(doc.expand(*nested), scef::Error::None);
+	EXPECT_EQ(nested->size(), 7_uip);
+}
+
+TEST(SCEF, load_sample1_parallel)
+{
+	//from memory, so that the groups can be split between threads
+	std::stringstream t_expected;
+	{
+		scef::document doc;
+		ASSERT_EQ(doc.load(getAppPath().parent_path() / "sampleFile1.scef", scef::Flag::ForceHeader), scef::Error::None);
+		scef::std_ostream t_out{t_expected};
+		ASSERT_EQ(doc.save(t_out, scef::Flag::Default, 1, scef::Encoding::ANSI), scef::Error::None);
+	}
+	const std::string t_data = t_expected.str();
+
+	scef::document doc;
+	{
+		scef::buffer_istream t_in{t_data.data(), t_data.size()};
+		ASSERT_EQ(doc.load(t_in, scef::Flag::ForceHeader), scef::Error::None);
+	}
+
+	scef::document parallel;
+	{
+		scef::buffer_istream t_in{t_data.data(), t_data.size()};
+		ASSERT_EQ(parallel.load_parallel(t_in, scef::Flag::ForceHeader, 4), scef::Error::None);
+	}
+	ASSERT_EQ(parallel.root().size(), doc.root().size());
+
+	for(uintptr_t i = 0; i < doc.root().size(); ++i)
+	{
+		EXPECT_EQ(parallel.root()[i]->type(), doc.root()[i]->type());
+		EXPECT_EQ(parallel.root()[i]->line(), doc.root()[i]->line());
+		EXPECT_EQ(parallel.root()[i]->column(), doc.root()[i]->column());
+	}
+
+	std::stringstream t_sequential;
+	std::stringstream t_result;
+	{
+		scef::std_ostream t_out{t_sequential};
+		ASSERT_EQ(doc.save(t_out, scef::Flag::Default, 1, scef::Encoding::ANSI), scef::Error::None);
+	}
+	{
+		scef::std_ostream t_out{t_result};
+		ASSERT_EQ(parallel.save(t_out, scef::Flag::Default, 1, scef::Encoding::ANSI), scef::Error::None);
+	}
+	EXPECT_EQ(t_result.str(), t_sequential.str());
+}
+
+TEST(SCEF, skip_merged_danger_codepoints)
+{
+	//danger codepoints merged into a name are taken in by the reader, skipping a group has to do the same
+	const std::string_view t_source = "!SCEF:v=1\n<a: <'x'\x06: k\x01=v\x02; 'q'\x03;> z;>\nlast;\n";
+
+	const auto has_last = [](const scef::document& p_doc)
+		{
+			return p_doc.root().find_singlet_by_name(U"last") != nullptr;
+		};
+
+	scef::document doc;
+	{
+		scef::buffer_istream t_in{t_source.data(), t_source.size()};
+		ASSERT_EQ(doc.load(t_in, scef::Flag::Default), scef::Error::None);
+		EXPECT_TRUE(has_last(doc));
+	}
+	{
+		scef::buffer_istream t_in{t_source.data(), t_source.size()};
+		ASSERT_EQ(doc.load(t_in, scef::path_filter{U"last"}, scef::Flag::Default), scef::Error::None);
+		EXPECT_TRUE(has_last(doc));
+	}
+	{
+		scef::buffer_istream t_in{t_source.data(), t_source.size()};
+		ASSERT_EQ(doc.load_parallel(t_in, scef::Flag::Default, 2), scef::Error::None);
+		EXPECT_TRUE(has_last(doc));
+	}
+	{
+		scef::buffer_istream t_in{t_source.data(), t_source.size()};
+		ASSERT_EQ(doc.load(t_in, scef::Flag::DeferGroups), scef::Error::None);
+		EXPECT_TRUE(has_last(doc));
+		scef::itemRef<scef::group> t_group = doc.root().find_group_by_name(U"a");
+		ASSERT_TRUE(t_group);
+		ASSERT_EQ(doc.expand(*t_group), scef::Error::None);
+		EXPECT_TRUE(t_group->find_singlet_by_name(U"z"));
+	}
+
+	scef::reader t_reader;
+	scef::buffer_istream t_in{t_source.data(), t_source.size()};
+	ASSERT_EQ(t_reader.open(t_in, scef::Flag::DisableSpacers | scef::Flag::DisableComments), scef::Error::None);
+	ASSERT_TRUE(t_reader.next());
+	ASSERT_EQ(t_reader.kind(), scef::reader::token::group_begin);
+	ASSERT_TRUE(t_reader.skip_group());
+	ASSERT_TRUE(t_reader.next());
+	EXPECT_EQ(t_reader.name(), U"last");
+	EXPECT_EQ(t_reader.last_error().error_code(), scef::Error::None);
+
+	//not merged, they are still rejected
+	const std::string_view t_bad = "!SCEF:v=1\n<a: <x: k= \x06;> z;>\nlast;\n";
+	scef::buffer_istream t_bad_in{t_bad.data(), t_bad.size()};
+	EXPECT_EQ(doc.load(t_bad_in, scef::path_filter{U"last"}, scef::Flag::Default), scef::Error::BadFormat);
+}
+
+TEST(SCEF, load_sample1_indexed)
+{
+	scef::document doc;
+	ASSERT_EQ(doc.load(getAppPath().parent_path() / "sampleFile1.scef", scef::Flag::ForceHeader), scef::Error::None);
+
+	scef::document indexed;
+	ASSERT_EQ(indexed.load(getAppPath().parent_path() / "sampleFile1.scef", scef::Flag::ForceHeader | scef::Flag::IndexedSpans), scef::Error::None);
+	ASSERT_EQ(indexed.root().size(), doc.root().size());
+
+	for(uintptr_t i = 0; i < doc.root().size(); ++i)
+	{
+		EXPECT_EQ(indexed.root()[i]->type(), doc.root()[i]->type());
+		EXPECT_EQ(indexed.root()[i]->line(), doc.root()[i]->line());
+		EXPECT_EQ(indexed.root()[i]->column(), doc.root()[i]->column());
+	}
+
+	std::stringstream t_plain;
+	std::stringstream t_result;
+	{
+		scef::std_ostream t_out{t_plain};
+		ASSERT_EQ(doc.save(t_out, scef::Flag::Default, 1, scef::Encoding::ANSI), scef::Error::None);
+	}
+	{
+		scef::std_ostream t_out{t_result};
+		ASSERT_EQ(indexed.save(t_out, scef::Flag::Default, 1, scef::Encoding::ANSI), scef::Error::None);
+	}
+	EXPECT_EQ(t_result.str(), t_plain.str());
+}
+
+TEST(SCEF, load_sample1_arena)
+{
+	scef::document doc;
+	ASSERT_EQ(doc.load(getAppPath().parent_path() / "sampleFile1.scef", scef::Flag::ForceHeader), scef::Error::None);
+
+	std::stringstream t_expected;
+	{
+		scef::std_ostream t_out{t_expected};
+		ASSERT_EQ(doc.save(t_out, scef::Flag::Default, 1, scef::Encoding::ANSI), scef::Error::None);
+	}
+
+	scef::document arena{std::pmr::new_delete_resource()};
+	//loaded twice, the second load starts from a fresh arena
+	for(uint8_t i = 0; i < 2; ++i)
+	{
+		ASSERT_EQ(arena.load(getAppPath().parent_path() / "sampleFile1.scef", scef::Flag::ForceHeader), scef::Error::None);
+		ASSERT_EQ(arena.root().size(), doc.root().size());
+
+		std::stringstream t_result;
+		scef::std_ostream t_out{t_result};
+		ASSERT_EQ(arena.save(t_out, scef::Flag::Default, 1, scef::Encoding::ANSI), scef::Error::None);
+		EXPECT_EQ(t_result.str(), t_expected.str());
+	}
+
+	//items added by the user can come from the same arena
+	scef::itemProxy<scef::keyedValue> t_key = scef::keyedValue::make(arena.resource());
+	t_key->set_name(U"added");
+	t_key->set_value(U"value");
+	arena.root().push_back(t_key);
+	EXPECT_EQ(arena.root().find_key_by_name(U"added"), t_key);
+	t_key.reset();
+
+	//items kept past clear, or past the document, keep their arena
+	const auto first_group = [](const scef::ItemList& p_list)
+	{
+		return *std::find_if(p_list.begin(), p_list.end(), [](const scef::itemProxy<scef::item>& p_item) { return p_item->type() == scef::ItemType::group; });
+	};
+
+	scef::itemProxy<scef::item> t_kept = first_group(arena.root());
+	arena.clear();
+	EXPECT_TRUE(arena.root().empty());
+	EXPECT_EQ(static_cast<const scef::group&>(*t_kept).view_name(), U"Sample");
+	ASSERT_FALSE(static_cast<const scef::group&>(*t_kept).empty());
+
+	{
+		scef::document t_scoped{std::pmr::new_delete_resource()};
+		ASSERT_EQ(t_scoped.load(getAppPath().parent_path() / "sampleFile1.scef", scef::Flag::ForceHeader), scef::Error::None);
+		t_kept = first_group(t_scoped.root());
+	}
+	EXPECT_EQ(static_cast<const scef::group&>(*t_kept).view_name(), U"Sample");
+	t_kept.reset();
+}
+
+TEST(SCEF, load_sample1_utf8)
+{
+	scef::document doc;
+	ASSERT_EQ(doc.load(getAppPath().parent_path() / "sampleFile1.scef", scef::Flag::ForceHeader), scef::Error::None);
+
+	scef::document utf8;
+	ASSERT_EQ(utf8.load(getAppPath().parent_path() / "sampleFile1.scef", scef::Flag::ForceHeader | scef::Flag::Utf8Text), scef::Error::None);
+
+	for(scef::Flag t_flags : {scef::Flag::Default, scef::Flag::AutoSpacing})
+	{
+		std::stringstream t_expected;
+		std::stringstream t_result;
+		scef::std_ostream t_expectedOut{t_expected};
+		scef::std_ostream t_resultOut{t_result};
+		ASSERT_EQ(doc.save(t_expectedOut, t_flags, 1, scef::Encoding::UTF8), scef::Error::None);
+		ASSERT_EQ(utf8.save(t_resultOut, t_flags, 1, scef::Encoding::UTF8), scef::Error::None);
+		EXPECT_EQ(t_result.str(), t_expected.str());
+	}
+
+	scef::itemRef<scef::group> sample = utf8.root().find_group_by_name(u8"Sample");
+	ASSERT_TRUE(sample);
+	ASSERT_TRUE(sample->utf8());
+	EXPECT_EQ(utf8.root().find_group_by_name(U"Sample"), sample);
+	EXPECT_EQ(doc.root().find_group_by_name(u8"Sample"), doc.root().find_group_by_name(U"Sample"));
+
+	scef::itemRef<scef::keyedValue> key = sample->find_key_by_name(u8"key");
+	ASSERT_TRUE(key);
+	EXPECT_EQ(key->view_value_u8(), u8"value");
+
+	//reading never converts, the text can be decoded into a copy, and only set_utf8 changes the encoding kept
+	EXPECT_EQ(key->value_u32(), U"value");
+	EXPECT_EQ(key->name_u32(), U"key");
+	EXPECT_TRUE(key->utf8());
+	EXPECT_TRUE(key->value_utf8());
+	key->set_utf8(false);
+	EXPECT_EQ(key->value(), U"value");
+	EXPECT_EQ(key->name(), U"key");
+	EXPECT_EQ(key->name_u32(), U"key");
+	EXPECT_FALSE(key->value_utf8());
+	EXPECT_FALSE(key->utf8());
+
+	//copying a name copies the encoding it is kept in
+	scef::itemProxy<scef::singlet> t_copy = scef::singlet::make();
+	static_cast<scef::_p::NamedItem&>(*t_copy) = *sample;
+	EXPECT_TRUE(t_copy->utf8());
+	EXPECT_EQ(t_copy->view_name_u8(), u8"Sample");
+	static_cast<scef::_p::NamedItem&>(*t_copy) = *key;
+	EXPECT_FALSE(t_copy->utf8());
+	EXPECT_EQ(t_copy->view_name(), U"key");
+
+	//code points past Unicode survive the trip through UTF-8
+	scef::itemRef<scef::group> nested = sample->find_group_by_name(u8"Nested With Escape");
+	ASSERT_TRUE(nested);
+	std::u32string t_escapedName = U"\n^\u0023\u1234";
+	t_escapedName.push_back(static_cast<char32_t>(0x12345678));
+	scef::itemRef<scef::singlet> escaped = nested->find_singlet_by_name(t_escapedName);
+	ASSERT_TRUE(escaped);
+	escaped->set_utf8(false);
+	EXPECT_EQ(escaped->name(), t_escapedName);
+}
+
+TEST(SCEF, item_references)
+{
+	scef::document doc;
+	ASSERT_EQ(doc.load(getAppPath().parent_path() / "sampleFile1.scef", scef::Flag::ForceHeader), scef::Error::None);
+
+	scef::itemRef<scef::group> sample = doc.root().find_group_by_name(U"Sample");
+	ASSERT_TRUE(sample);
+	EXPECT_EQ(doc.root().find_group_by_name(U"none"), nullptr);
+
+	//neither lookups nor typed iteration take ownership
+	const scef::group& t_const = *sample;
+	uintptr_t t_count = 0;
+	for(scef::itemRef<const scef::item> t_item : t_const.proxyList(scef::ItemType::Mask_Basic))
+	{
+		if(t_item->type() == scef::ItemType::key_value)
+		{
+			EXPECT_EQ(t_const.find_key_by_name(static_cast<const scef::keyedValue&>(*t_item).name()), t_item);
+		}
+		++t_count;
+	}
+	EXPECT_EQ(t_count, 3_uip);
+
+	for(const scef::itemProxy<scef::item>& t_item : *sample)
+	{
+		EXPECT_EQ(t_item.use_count(), 1);
+	}
+
+	//ownership can be had back, and keeps the item past its list
+	scef::itemProxy<const scef::keyedValue> t_owner = t_const.find_key_by_name(U"key").lock();
+	ASSERT_TRUE(t_owner);
+	EXPECT_EQ(t_owner.use_count(), 2);
+	EXPECT_EQ(t_const.find_key_by_name(U"key"), t_owner);
+	EXPECT_EQ(scef::itemRef<scef::group>{}.lock(), nullptr);
+	doc.clear();
+	EXPECT_EQ(t_owner.use_count(), 1);
+	EXPECT_EQ(t_owner->view_value(), U"value");
+}
+
+TEST(SCEF, name_index)
+{
+	scef::document doc;
+	scef::ItemList& list = doc.root();
+
+	std::vector<scef::itemProxy<scef::keyedValue>> keys;
+	for(uint32_t i = 0; i < 100; ++i)
+	{
+		scef::itemProxy<scef::keyedValue> t_key = scef::keyedValue::make();
+		t_key->set_name(std::u32string(U"key") + static_cast<char32_t>(U'0' + i % 10) + static_cast<char32_t>(U'0' + i / 10));
+		list.push_back(t_key);
+		keys.push_back(std::move(t_key));
+	}
+	scef::itemProxy<scef::group> t_group = scef::group::make();
+	t_group->set_name(U"key00");
+	list.push_back(t_group);
+
+	const scef::ItemList& t_const = list;
+	list.index_names();
+	for(const scef::itemProxy<scef::keyedValue>& t_key : keys)
+	{
+		EXPECT_EQ(list.find_key_by_name(t_key->view_name()), t_key);
+	}
+	EXPECT_EQ(list.find_group_by_name(U"key00"), t_group);
+	EXPECT_EQ(list.find_singlet_by_name(U"key00"), nullptr);
+	EXPECT_EQ(list.find_key_by_name(u8"key42"), keys[24]);
+	EXPECT_EQ(t_const.find_key_by_name(U"key99"), keys[99]);
+	EXPECT_EQ(t_const.find_key_by_name(U"none"), nullptr);
+
+	//changes to the list are looked up item by item, and still find the first one of a name
+	scef::itemProxy<scef::keyedValue> t_again = scef::keyedValue::make();
+	t_again->set_name(U"key01");
+	list.push_back(t_again);
+	EXPECT_EQ(list.find_key_by_name(U"key01"), keys[10]);
+	list.erase(list.begin() + 10);
+	EXPECT_EQ(list.find_key_by_name(U"key01"), t_again);
+	list.index_names();
+	EXPECT_EQ(t_const.find_key_by_name(U"key01"), t_again);
+
+	//as are renamed items, also when they take the name of one after them
+	keys[0]->set_name(U"key99");
+	EXPECT_EQ(t_const.find_key_by_name(U"key00"), nullptr);
+	EXPECT_EQ(t_const.find_key_by_name(U"key99"), keys[0]);
+	list.index_names();
+	EXPECT_EQ(t_const.find_key_by_name(U"key99"), keys[0]);
+
+	//as are items added in place of others, with the list keeping its size and buffer
+	list.erase(list.begin());
+	scef::itemProxy<scef::keyedValue> t_new = scef::keyedValue::make();
+	t_new->set_name(U"new");
+	list.push_back(t_new);
+	EXPECT_EQ(t_const.find_key_by_name(U"new"), t_new);
+	EXPECT_EQ(t_const.find_key_by_name(U"key99"), keys[99]);
+
+	//items put in place of others through references are only seen once indexed again
+	list.index_names();
+	scef::itemProxy<scef::keyedValue> t_swapped = scef::keyedValue::make();
+	t_swapped->set_name(U"swapped");
+	list.front() = t_swapped;
+	list.index_names();
+	EXPECT_EQ(t_const.find_key_by_name(U"swapped"), t_swapped);
+	EXPECT_EQ(t_const.find_key_by_name(U"key10"), nullptr);
+}
+
+TEST(SCEF, type_index)
+{
+	scef::document doc;
+	scef::ItemList& list = doc.root();
+
+	//mostly spacers, as documents loaded with their spacing are
+	std::vector<scef::itemProxy<scef::item>> singlets;
+	for(uint32_t i = 0; i < 100; ++i)
+	{
+		list.push_back(scef::spacer::make());
+		list.push_back(scef::comment::make());
+		if(i % 10 == 0)
+		{
+			scef::itemProxy<scef::singlet> t_singlet = scef::singlet::make();
+			list.push_back(t_singlet);
+			singlets.push_back(std::move(t_singlet));
+		}
+	}
+
+	const auto collect = [](const auto& p_proxy)
+		{
+			std::vector<const scef::item*> t_out;
+			for(auto it = p_proxy.begin(); it != p_proxy.end(); ++it) t_out.push_back(&*(*it));
+			return t_out;
+		};
+	const auto expected = [&singlets]()
+		{
+			std::vector<const scef::item*> t_out;
+			for(const scef::itemProxy<scef::item>& t_item : singlets) t_out.push_back(t_item.get());
+			return t_out;
+		};
+
+	const scef::ItemList& t_const = list;
+	EXPECT_EQ(collect(t_const.proxyList(scef::ItemType::singlet)), expected());
+	list.index_types(scef::ItemType::singlet);
+	EXPECT_EQ(collect(list.proxyList(scef::ItemType::singlet)), expected());
+	EXPECT_EQ(collect(t_const.proxyList(scef::ItemType::singlet)), expected());
+	EXPECT_EQ(collect(list.proxyList(scef::ItemType::Mask_Irrelevant)).size(), 200_uip);
+
+	//adding or removing items is noticed, also when the list keeps its size and buffer
+	list.erase(list.begin() + 1);
+	list.push_back(scef::singlet::make());
+	singlets.push_back(list.back());
+	EXPECT_EQ(collect(list.proxyList(scef::ItemType::singlet)), expected());
+	list.index_types(scef::ItemType::singlet);
+	EXPECT_EQ(collect(t_const.proxyList(scef::ItemType::singlet)), expected());
+
+	//replacing them in place is not, items that no longer match are still skipped
+	list[1] = scef::spacer::make();
+	singlets.erase(singlets.begin());
+	EXPECT_EQ(collect(t_const.proxyList(scef::ItemType::singlet)), expected());
+	list[0] = scef::singlet::make();
+	singlets.insert(singlets.begin(), list[0]);
+	list.index_types(scef::ItemType::singlet);
+	EXPECT_EQ(collect(list.proxyList(scef::ItemType::singlet)), expected());
+	EXPECT_EQ(collect(t_const.proxyList(scef::ItemType::singlet)), expected());
+}
+
+TEST(SCEF, intern_names)
+{
+	const std::string_view t_source = "!SCEF:v=1\n<server: port = 1; enabled;>\n<server: port = 2; enabled;>\n";
+
+	scef::document doc;
+	{
+		scef::buffer_istream t_stream{t_source.data(), t_source.size()};
+		ASSERT_EQ(doc.load(t_stream, scef::Flag::InternNames), scef::Error::None);
+	}
+
+	const scef::symbol port = doc.find_symbol(U"port");
+	ASSERT_TRUE(port);
+	EXPECT_EQ(port.view(), U"port");
+	EXPECT_FALSE(doc.find_symbol(U"none"));
+
+	std::vector<scef::itemRef<scef::group>> servers;
+	for(scef::itemRef<scef::item> t_item : doc.root().proxyList(scef::ItemType::group))
+	{
+		servers.push_back(scef::itemRef<scef::group>{static_cast<scef::group*>(t_item.get())});
+	}
+	ASSERT_EQ(servers.size(), 2_uip);
+	EXPECT_EQ(servers[0]->name_symbol(), servers[1]->name_symbol());
+
+	//a copied name shares the symbol
+	scef::itemProxy<scef::singlet> t_copy = scef::singlet::make();
+	static_cast<scef::_p::NamedItem&>(*t_copy) = *servers[0];
+	EXPECT_EQ(t_copy->name_symbol(), servers[0]->name_symbol());
+
+	scef::itemRef<scef::keyedValue> t_port = servers[1]->find_key_by_name(port);
+	ASSERT_TRUE(t_port);
+	EXPECT_EQ(t_port->name_symbol(), port);
+	EXPECT_EQ(t_port->view_value(), U"2");
+	EXPECT_EQ(servers[1]->find_key_by_name(U"port"), t_port);
+	EXPECT_EQ(servers[1]->find_key_by_name(scef::symbol{}), nullptr);
+	EXPECT_EQ(servers[1]->find_singlet_by_name(doc.find_symbol(U"enabled"))->view_name(), U"enabled");
+
+	//setting a name gives the item its own copy, the others keep the symbol
+	t_port->set_name(U"ports");
+	EXPECT_FALSE(t_port->name_symbol());
+	EXPECT_EQ(t_port->view_name(), U"ports");
+	EXPECT_EQ(servers[1]->find_key_by_name(port), nullptr);
+	EXPECT_EQ(servers[0]->find_key_by_name(port)->name_symbol(), port);
+
+	//names are saved as if they were not interned
+	scef::document plain;
+	{
+		scef::buffer_istream t_stream{t_source.data(), t_source.size()};
+		ASSERT_EQ(plain.load(t_stream, scef::Flag::Default), scef::Error::None);
+	}
+	servers[1]->find_key_by_name(U"ports")->set_name(port);
+	std::stringstream t_expected;
+	std::stringstream t_result;
+	scef::std_ostream t_expectedOut{t_expected};
+	scef::std_ostream t_resultOut{t_result};
+	ASSERT_EQ(plain.save(t_expectedOut, scef::Flag::Default, 1, scef::Encoding::UTF8), scef::Error::None);
+	ASSERT_EQ(doc.save(t_resultOut, scef::Flag::Default, 1, scef::Encoding::UTF8), scef::Error::None);
+	EXPECT_EQ(t_result.str(), t_expected.str());
+
+	//names no item or symbol has any more are dropped when loading again
+	{
+		const std::string_view t_other = "!SCEF:v=1\nother;\n";
+		scef::buffer_istream t_stream{t_other.data(), t_other.size()};
+		ASSERT_EQ(doc.load(t_stream, scef::Flag::InternNames), scef::Error::None);
+	}
+	EXPECT_FALSE(doc.find_symbol(U"enabled"));
+	EXPECT_EQ(doc.find_symbol(U"port"), port);
+	EXPECT_TRUE(doc.find_symbol(U"other"));
+
+	//and items keep their names past the document
+	scef::itemProxy<scef::item> t_kept;
+	{
+		scef::document t_scoped;
+		scef::buffer_istream t_stream{t_source.data(), t_source.size()};
+		ASSERT_EQ(t_scoped.load(t_stream, scef::Flag::InternNames), scef::Error::None);
+		t_kept = t_scoped.root().front();
+	}
+	EXPECT_EQ(static_cast<const scef::group&>(*t_kept).view_name(), U"server");
+	EXPECT_EQ(static_cast<const scef::group&>(*t_kept).name_symbol().view(), U"server");
+}
+
+TEST(SCEF, frozen_document)
+{
+	const std::string_view t_source = "!SCEF:v=1\n<server: port = 1; enabled;>\n<server: port = 2; <limits: rate = 5;>\n#note\n>\nlast;\n";
+
+	scef::document doc;
+	{
+		scef::buffer_istream t_stream{t_source.data(), t_source.size()};
+		ASSERT_EQ(doc.load(t_stream, scef::Flag::Default), scef::Error::None);
+	}
+
+	scef::frozen_document loaded;
+	{
+		scef::buffer_istream t_stream{t_source.data(), t_source.size()};
+		ASSERT_EQ(loaded.load(t_stream, scef::Flag::Utf8Text), scef::Error::None);
+	}
+
+	const scef::frozen_document copied{doc.root()};
+
+	for(const scef::frozen_document* t_frozen : {&std::as_const(loaded), &copied})
+	{
+		const scef::frozen_document& frozen = *t_frozen;
+		using node = scef::frozen_document::node;
+
+		ASSERT_EQ(frozen.size(), 9_uip);
+		EXPECT_EQ(frozen.type(scef::frozen_document::root_node), scef::ItemType::root);
+		EXPECT_EQ(frozen.children(scef::frozen_document::root_node).size(), 3_uip);
+
+		//the first of the same name is found
+		const node t_server = frozen.find_group(scef::frozen_document::root_node, U"server");
+		ASSERT_NE(t_server, scef::frozen_document::npos);
+		EXPECT_EQ(frozen.value_as_num<uint8_t>(frozen.find_key(t_server, U"port")).value(), 1);
+		EXPECT_NE(frozen.find_singlet(t_server, U"enabled"), scef::frozen_document::npos);
+		EXPECT_EQ(frozen.find_group(t_server, U"enabled"), scef::frozen_document::npos);
+		EXPECT_EQ(frozen.find_singlet(scef::frozen_document::root_node, U"enabled"), scef::frozen_document::npos);
+		EXPECT_NE(frozen.find_singlet(scef::frozen_document::root_node, U"last"), scef::frozen_document::npos);
+
+		const node t_second = frozen.children(scef::frozen_document::root_node)[1];
+		ASSERT_EQ(frozen.type(t_second), scef::ItemType::group);
+		EXPECT_EQ(frozen.name(t_second), U"server");
+		EXPECT_EQ(frozen.children(t_second).size(), 2_uip);
+		const node t_limits = frozen.find_group(t_second, U"limits");
+		ASSERT_NE(t_limits, scef::frozen_document::npos);
+		const node t_rate = frozen.find_key(t_limits, U"rate");
+		ASSERT_NE(t_rate, scef::frozen_document::npos);
+		EXPECT_EQ(frozen.name(t_rate), U"rate");
+		EXPECT_EQ(frozen.value(t_rate), U"5");
+	}
+
+	scef::frozen_document bad;
+	{
+		const std::string_view t_bad = "!SCEF:v=1\n<server: port = 1;\n";
+		scef::buffer_istream t_stream{t_bad.data(), t_bad.size()};
+		EXPECT_NE(bad.load(t_stream, scef::Flag::Default), scef::Error::None);
+	}
+	EXPECT_EQ(bad.size(), 1_uip);
+}
+
+TEST(SCEF, frozen_document_binary)
+{
+	scef::frozen_document frozen;
+	ASSERT_EQ(frozen.load(getAppPath().parent_path() / "sampleFile1.scef", scef::Flag::ForceHeader), scef::Error::None);
+
+	const auto same = [&frozen](const scef::frozen_document& p_other)
+		{
+			ASSERT_EQ(p_other.size(), frozen.size());
+			for(scef::frozen_document::node i = 0; i < frozen.size(); ++i)
+			{
+				EXPECT_EQ(p_other.type(i), frozen.type(i));
+				EXPECT_EQ(p_other.name(i), frozen.name(i));
+				EXPECT_EQ(p_other.value(i), frozen.value(i));
+				EXPECT_EQ(p_other.children(i).size(), frozen.children(i).size());
+			}
+			const scef::frozen_document::node t_sample = p_other.find_group(scef::frozen_document::root_node, U"Sample");
+			ASSERT_NE(t_sample, scef::frozen_document::npos);
+			EXPECT_EQ(p_other.value(p_other.find_key(t_sample, U"key")), U"value");
+		};
+
+	const std::filesystem::path t_file = getAppPath().parent_path() / "sampleFile1.scefb";
+	ASSERT_EQ(frozen.save(t_file), scef::Error::None);
+	{
+		scef::frozen_document mapped;
+		ASSERT_EQ(mapped.load_binary(t_file), scef::Error::None);
+		same(mapped);
+		same(scef::frozen_document{mapped});
+	}
+
+	std::stringstream t_image;
+	scef::std_ostream t_out{t_image};
+	ASSERT_EQ(frozen.save(t_out), scef::Error::None);
+	std::string t_data = t_image.str();
+	{
+		scef::frozen_document read;
+		scef::buffer_istream t_stream{t_data.data(), t_data.size()};
+		ASSERT_EQ(read.load_binary(t_stream), scef::Error::None);
+		same(read);
+	}
+
+	scef::frozen_document bad;
+	{
+		scef::buffer_istream t_stream{t_data.data(), t_data.size() - 1};
+		EXPECT_EQ(bad.load_binary(t_stream), scef::Error::BadFormat);
+		EXPECT_EQ(bad.size(), 1_uip);
+	}
+	t_data[4] = static_cast<char>(scef::__SCEF_BINARY_VERSION + 1);
+	{
+		scef::buffer_istream t_stream{t_data.data(), t_data.size()};
+		EXPECT_EQ(bad.load_binary(t_stream), scef::Error::UnsuportedVersion);
+	}
+	std::filesystem::remove(t_file);
+}